@@ -0,0 +1,370 @@
+/**
+ * Author: Markus Kusano
+ *
+ * Header only enumeration of the k member subsets (combinations) of
+ * {0, ..., n-1}. The combinations tool is built on it, and a C++ driver can
+ * include it to walk the combinations itself instead of running the tool and
+ * parsing its output.
+ *
+ * Combinations are produced in increasing lexicographic order and are ranked
+ * from 0 in that order. Counts and ranks are 64-bit: count() saturates at
+ * ULLONG_MAX when C(n, k) does not fit, and rank() and seek() need it to fit.
+ *
+ *   CombinationIterator it(40, 5);
+ *   CombinationWriter out(stdout);
+ *   do {
+ *       out.write(it.get(), it.size());
+ *   } while (it.next());
+ *
+ * BestFirstCombinations produces them by decreasing total weight instead.
+ */
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <vector>
+
+class CombinationIterator {
+    public:
+        /// Starts at the first combination of k from {0, ..., n-1},
+        /// 0 <= k <= n
+        CombinationIterator(long n, long k) : n(n), k(k) {
+            members = (long *) malloc(sizeof(long) * (k > 0 ? k : 1));
+            for (long i = 0; i < k; i++) {
+                members[i] = i;
+            }
+        }
+
+        ~CombinationIterator() {
+            free(members);
+        }
+
+        /// Members of the current combination, in increasing order
+        const long *get() const {
+            return members;
+        }
+
+        long size() const {
+            return k;
+        }
+
+        /// Moves to the next combination. Returns false, leaving the last
+        /// combination in place, if there is none.
+        bool next() {
+            long i = k - 1;
+            while (i >= 0 && members[i] == n - k + i) {
+                i--;
+            }
+            if (i < 0) {
+                return false;
+            }
+            long m = ++members[i];
+            for (i = i + 1; i < k; i++) {
+                members[i] = ++m;
+            }
+            return true;
+        }
+
+        /// Rank of the current combination
+        unsigned long long rank() const {
+            return rankOf(members, n, k);
+        }
+
+        /// Rank of the combination members (k increasing values from
+        /// {0, ..., n-1})
+        static unsigned long long rankOf(const long *members, long n, long k) {
+            // Mapping each member c to n - 1 - c reverses the order, and the
+            // combinadic of the mapped combination, the sum of
+            // C(n - 1 - members[i], k - i), counts the combinations after it
+            unsigned long long after = 0;
+            for (long i = 0; i < k; i++) {
+                after += count(n - 1 - members[i], k - i);
+            }
+            return count(n, k) - 1 - after;
+        }
+
+        /// Moves to the combination of rank r, r < count(n, k). Takes
+        /// O(k log n) binomials.
+        void seek(unsigned long long r) {
+            if (r == 0) {
+                // Also when C(n, k) does not fit
+                for (long i = 0; i < k; i++) {
+                    members[i] = i;
+                }
+                return;
+            }
+            unsigned long long after = count(n, k) - 1 - r;
+            long hi = n - 1; // largest mapped value left for the next member
+            for (long i = 0; i < k; i++) {
+                // Largest x <= hi with C(x, k - i) <= after. C(x, k - i)
+                // grows with x and is 0 for x < k - i; a saturated value is
+                // always too large.
+                long lo = 0;
+                long top = hi;
+                while (lo < top) {
+                    long mid = lo + (top - lo + 1) / 2;
+                    if (count(mid, k - i) <= after) {
+                        lo = mid;
+                    }
+                    else {
+                        top = mid - 1;
+                    }
+                }
+                after -= count(lo, k - i);
+                members[i] = n - 1 - lo;
+                hi = lo - 1;
+            }
+        }
+
+        /// Number of ways to pick k of n, ULLONG_MAX if it does not fit
+        static unsigned long long count(long n, long k) {
+            if (k < 0 || k > n) {
+                return 0;
+            }
+            if (k > n - k) {
+                k = n - k;
+            }
+            // ret * (n - k + i) / i is C(n - k + i, i), dividing out the gcd
+            // first keeps the product exact without overflowing early
+            unsigned long long ret = 1;
+            for (long i = 1; i <= k; i++) {
+                unsigned long long num = n - k + i;
+                unsigned long long g = gcd(ret, i);
+                ret /= g;
+                num /= i / g;
+                if (ret > ULLONG_MAX / num) {
+                    return ULLONG_MAX;
+                }
+                ret *= num;
+            }
+            return ret;
+        }
+
+    private:
+        long n;
+        long k;
+        long *members;
+
+        static unsigned long long gcd(unsigned long long a, unsigned long long b) {
+            while (b != 0) {
+                unsigned long long t = a % b;
+                a = b;
+                b = t;
+            }
+            return a;
+        }
+
+        // Not copyable, members is owned
+        CombinationIterator(const CombinationIterator &);
+        void operator=(const CombinationIterator &);
+};
+
+/// Produces the combinations of k from {0, ..., n-1}, n the number of
+/// weights, in decreasing order of the sum of the weights of their members.
+/// Combinations are made on demand from a heap, so taking the best m costs
+/// O(m (k + log m)) no matter how many combinations there are.
+///
+/// The members are ranked by decreasing weight and a combination is a set of
+/// ranks p[0] < ... < p[k-1]. Every combination is reached from the best one,
+/// (0, ..., k-1), by moving ranks one step towards the worse end, which never
+/// raises the score. Moving only the first moved rank f (the first p[f] > f)
+/// or the one before it gives each combination exactly one parent, so the
+/// heap never holds duplicates and each combination adds at most two.
+class BestFirstCombinations {
+    public:
+        /// Starts at the best combination of k members, 0 <= k <= number of
+        /// weights. Ties go to the members with lower numbers.
+        BestFirstCombinations(const std::vector<double> &weights, long k)
+                : weights(weights), k(k) {
+            for (long i = 0; i < (long) weights.size(); i++) {
+                order.push_back(i);
+            }
+            std::stable_sort(order.begin(), order.end(), ByWeight(weights));
+            State best;
+            for (long i = 0; i < k; i++) {
+                best.ranks.push_back(i);
+            }
+            best.score = getScore(best.ranks);
+            best.serial = 0;
+            serial = 1;
+            setCurrent(best);
+        }
+
+        /// Members of the current combination, in increasing order
+        const long *get() const {
+            return current.empty() ? NULL : &current[0];
+        }
+
+        long size() const {
+            return k;
+        }
+
+        /// Sum of the weights of the current combination
+        double score() const {
+            return currentScore;
+        }
+
+        /// Moves to the next best combination. Returns false if there is
+        /// none.
+        bool next() {
+            if (heap.empty()) {
+                return false;
+            }
+            State s = heap.top();
+            heap.pop();
+            setCurrent(s);
+            return true;
+        }
+
+    private:
+        struct State {
+            std::vector<long> ranks;
+            double score;
+            unsigned long long serial; // order of creation, breaks ties
+
+            /// Top of the heap is the best score, then the oldest
+            bool operator<(const State &other) const {
+                if (score != other.score) {
+                    return score < other.score;
+                }
+                return serial > other.serial;
+            }
+        };
+
+        struct ByWeight {
+            const std::vector<double> &weights;
+            ByWeight(const std::vector<double> &weights) : weights(weights) {
+            }
+            bool operator()(long a, long b) const {
+                return weights[a] > weights[b];
+            }
+        };
+
+        std::vector<double> weights;
+        long k;
+        std::vector<long> order; // members by decreasing weight
+        std::priority_queue<State> heap;
+        unsigned long long serial;
+        std::vector<long> current;
+        double currentScore;
+
+        double getScore(const std::vector<long> &ranks) const {
+            double score = 0;
+            for (unsigned i = 0; i < ranks.size(); i++) {
+                score += weights[order[ranks[i]]];
+            }
+            return score;
+        }
+
+        /// Pushes s with rank i moved one step back if that is free
+        void pushMoved(const State &s, long i) {
+            long limit = i + 1 < k ? s.ranks[i + 1] : (long) order.size();
+            if (s.ranks[i] + 1 >= limit) {
+                return;
+            }
+            State child = s;
+            child.ranks[i]++;
+            child.score = getScore(child.ranks);
+            child.serial = serial++;
+            heap.push(child);
+        }
+
+        void setCurrent(const State &s) {
+            current.clear();
+            for (long i = 0; i < k; i++) {
+                current.push_back(order[s.ranks[i]]);
+            }
+            std::sort(current.begin(), current.end());
+            currentScore = s.score;
+
+            long f = 0;
+            while (f < k && s.ranks[f] == f) {
+                f++;
+            }
+            if (f > 0) {
+                pushMoved(s, f - 1);
+            }
+            if (f < k) {
+                pushMoved(s, f);
+            }
+        }
+};
+
+/// Writes combinations one per line with their members separated by commas,
+/// formatting the numbers itself into a buffer flushed in large blocks
+class CombinationWriter {
+    public:
+        CombinationWriter(FILE *out) : out(out), used(0), usePrefix(false), prefix(0) {
+        }
+
+        ~CombinationWriter() {
+            flush();
+        }
+
+        /// Write prefix and a comma before every member (see -p of the
+        /// combinations tool)
+        void setPrefix(long p) {
+            usePrefix = true;
+            prefix = p;
+        }
+
+        void write(const long *members, long size) {
+            for (long i = 0; i < size; i++) {
+                if (usePrefix) {
+                    putNumber(prefix);
+                    buf[used++] = ',';
+                }
+                putNumber(members[i]);
+                buf[used++] = i == size - 1 ? '\n' : ',';
+            }
+            if (size == 0) {
+                reserve(1);
+                buf[used++] = '\n';
+            }
+        }
+
+        void flush() {
+            if (used != 0) {
+                fwrite(buf, 1, used, out);
+                used = 0;
+            }
+        }
+
+    private:
+        FILE *out;
+        char buf[1 << 16];
+        unsigned used;
+        bool usePrefix;
+        long prefix;
+
+        void reserve(unsigned bytes) {
+            if (used + bytes > sizeof(buf)) {
+                flush();
+            }
+        }
+
+        /// Writes v, leaving room for the separator after it
+        void putNumber(long v) {
+            reserve(24);
+            unsigned long u = v;
+            if (v < 0) {
+                buf[used++] = '-';
+                u = 0UL - u;
+            }
+            char digits[20];
+            int len = 0;
+            do {
+                digits[len++] = '0' + u % 10;
+                u /= 10;
+            } while (u != 0);
+            while (len > 0) {
+                buf[used++] = digits[--len];
+            }
+        }
+
+        // Not copyable, it would write the buffer twice
+        CombinationWriter(const CombinationWriter &);
+        void operator=(const CombinationWriter &);
+};
@@ -0,0 +1,91 @@
+/**
+ * Author: Markus Kusano
+ *
+ * Header only helpers shared by the tools in this directory: command line
+ * parsing, the -budget option and running a mutant with the -run command.
+ *
+ * -budget is given in CPU seconds, any positive number, and is compared
+ * against cpuTime(), which includes the commands run by the tool.
+ */
+#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// Retrieves the value associated with the given option. ie given if -c 2 is
+// specified on the command line, passing with with the option "c" will return
+// "2"
+inline char *getCmdValue(char **begin, char **end, const std::string &option) {
+    char ** itr = std::find(begin, end, option);
+    if (itr != end && (itr + 1) != end) {
+        return *(itr + 1);
+    }
+    return NULL;
+}
+
+// Returns true if a command line option exists
+inline bool cmdOptionExists(char** begin, char** end, const std::string& option)
+{
+    return std::find(begin, end, option) != end;
+}
+
+// Converts the value of a numeric option, exiting if it is not a number of
+// at least min
+inline long parseLong(const char *option, const char *value, long min) {
+    char *end;
+    long ret = value == NULL ? 0 : strtol(value, &end, 10);
+    if (value == NULL || end == value || *end != '\0' || ret < min) {
+        fprintf(stderr, "Error: %s requires a number of at least %ld\n", option, min);
+        exit(EXIT_FAILURE);
+    }
+    return ret;
+}
+
+// Value of -budget in seconds, 0 if it is not given
+inline double parseBudget(char **begin, char **end) {
+    if (!cmdOptionExists(begin, end, "-budget")) {
+        return 0;
+    }
+    const char *value = getCmdValue(begin, end, "-budget");
+    char *rest;
+    double ret = value == NULL ? 0 : strtod(value, &rest);
+    if (value == NULL || rest == value || *rest != '\0' || !(ret > 0)) {
+        fprintf(stderr, "Error: -budget requires a positive number of seconds\n");
+        exit(EXIT_FAILURE);
+    }
+    return ret;
+}
+
+// CPU seconds used by the tool and the commands it ran
+inline double cpuTime() {
+    double total = 0;
+    int who[2] = { RUSAGE_SELF, RUSAGE_CHILDREN };
+    for (int i = 0; i < 2; i++) {
+        struct rusage usage;
+        getrusage(who[i], &usage);
+        total += usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+        total += usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    }
+    return total;
+}
+
+// Runs command with every {} replaced by args, returns true if the mutant was
+// killed (the command did not exit with status 0)
+inline bool runMutant(const char *command, const std::string &args) {
+    std::string cmd = command;
+    size_t pos = 0;
+    while ((pos = cmd.find("{}", pos)) != std::string::npos) {
+        cmd.replace(pos, 2, args);
+        pos += args.size();
+    }
+    int status = system(cmd.c_str());
+    if (status == -1) {
+        perror("Error: unable to run -run command");
+        exit(EXIT_FAILURE);
+    }
+    return !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+}
@@ -22,6 +22,66 @@
  *  Use -p to specify a prefix number to go infront of each number in the
  *  combination set. For example, if the set is {1,8,2} then -p 0 will produce
  *  {0,1,0,8,0,2}
+ *
+ *  Use -g to pass a conflict graph (e.g. from Mutex -conflicts -analyze).
+ *  Each line is "<kind> <a> <b> [reason]", stating that a and b cannot be
+ *  in the same combination; lines that do not start with three numbers are
+ *  ignored. Only combinations with no two conflicting members are produced,
+ *  in the same order as without -g. With -p only the lines whose kind is the
+ *  prefix are used, otherwise every line is.
+ *
+ *  The combinations are numbered (ranked) from 0 in the order they are
+ *  produced. Use -start <r> to begin at rank r and -count <c> to stop after c
+ *  combinations, and -shard i/N to produce only the i-th of N slices (i from
+ *  0) of about the same size; -start and -count then apply inside the slice.
+ *  Without -g the first combination of a slice is computed from its rank, so
+ *  each worker of a campaign can jump straight to its own slice. With -g the
+ *  ranks are positions in the conflict free order, and the combinations
+ *  before the slice (and with -shard all of them, to size the slices) have to
+ *  be enumerated.
+ *
+ *  -rank <combination> prints the rank of a combination given as it is
+ *  printed (including the prefixes with -p), e.g. to resume an interrupted
+ *  worker with -start at the rank after the last line it wrote. It cannot be
+ *  used with -g.
+ *
+ *  -sample <N> produces N distinct combinations picked uniformly at random
+ *  instead of all of them, in the order they would be produced otherwise.
+ *  Only the N ranks are kept in memory (Floyd's algorithm). The same -seed <S>
+ *  (default 0) gives the same sample on every run and machine. With -g the
+ *  sample is drawn from the conflict free combinations by rejecting the
+ *  others, and is cut short with a warning when they run out.
+ *
+ *  -mixed takes every number of the input as the size of a category (e.g.
+ *  the number of pairs of each kind from Mutex -analyze) and picks from all
+ *  of the categories together. Each member is written as "<category>,<index>",
+ *  the format of -p, so
+ *
+ *   combos -mixed -k 2 "2 0 1"
+ *
+ *  produces 0,0,0,1 then 0,0,2,0 and 0,1,2,0. Unlike without -mixed the
+ *  numbers are sizes, not the largest index. -c and -p cannot be used, with -g
+ *  the kind of each conflict is its category and -rank takes the same pairs.
+ *
+ *  -weights <file> produces the combinations by decreasing sum of the weights
+ *  of their members instead, e.g. to spend a limited -count on the most
+ *  promising higher order mutants first. Each line is "<kind> <member>
+ *  <weight>", like -g the kind selects the lines with -p and the category
+ *  with -mixed and is otherwise ignored. Members without a weight have 0,
+ *  ties go to the order of the members. -start and -count are in this order;
+ *  -shard, -sample and -rank cannot be used.
+ *
+ *  -only <file> only picks the members listed in the file, e.g. the minimal
+ *  mutant set written by subsumption. Each line is a member as it is printed
+ *  for -k 1 with the same -p or -mixed ("<member>", "<prefix>,<member>" or
+ *  "<category>,<index>"); other lines, e.g. of another prefix or of higher
+ *  order mutants, are ignored. Ranks, -total and -sample then count the
+ *  combinations of the listed members only.
+ *
+ *  -total prints the number of combinations the other options would produce
+ *  instead of producing them.
+ *
+ *  The enumeration itself is in Combinations.h.
  */
 #include <cstdio>
 #include <cstdlib>
@@ -33,6 +93,11 @@
 #include <climits>
 #include <cstring>
 #include <cerrno>
+#include <vector>
+#include <set>
+
+#include "Combinations.h"
+#include "ToolUtil.h"
 
 // Enable debugging output
 //#define DEBUG
@@ -41,28 +106,74 @@ long n;  // The size of the input set (spans from 0 to n)
 long k;  // The size of the pick set ie {0,1}, {0,2} k=2
 long prefix;    // Prefix value (see header comment)
 bool usePrefix;
-
-// Find the next combination based on the array comb[]
-int next_comb(int comb[], int k, int n);
+const char *graphFile; // Conflict graph passed with -g, NULL if none
+
+unsigned long long startRank; // First rank produced (-start), 0 if not given
+unsigned long long maxCount;  // Combinations produced (-count), ULLONG_MAX if
+                              // not given
+bool useShard;
+long shardIndex;  // Slice i of -shard i/N
+long numShards;   // N of -shard i/N
+const char *rankCombo; // Combination passed with -rank, NULL if none
+bool useSample;
+unsigned long long sampleSize; // N of -sample
+unsigned long long seed;       // Value of -seed, 0 if not given
+bool printTotal;               // -total was passed
+bool mixed;                    // -mixed was passed
+const char *weightsFile;       // Weights passed with -weights, NULL if none
+const char *onlyFile;          // Members passed with -only, NULL if none
+
+// With -only the members are renumbered to the listed ones: member i of the
+// enumeration is onlyMembers[i], and onlyIndex maps back (-1 if not listed)
+std::vector<long> onlyMembers;
+std::vector<long> onlyIndex;
+
+// Weight of each member with -weights
+std::vector<double> weights;
+
+// With -mixed, category c has the members categoryStart[c] to
+// categoryStart[c + 1] - 1. The last entry is the number of members.
+std::vector<long> categoryStart;
+
+// Where the combinations are written
+CombinationWriter output(stdout);
+
+// conflicts[i] lists the members that cannot be picked with i (see -g)
+std::vector<std::vector<int> > conflicts;
 
 // Sets up n and k from command line options and does error checking
 void parseCommandLine(int argc, char *argv[]);
 
-// Retrieves the value associated with the given option. ie given if -c 2 is
-// specified on the command line, passing with with the option "c" will return
-// "2"
-char *getCmdValue(char **begin, char **end, const std::string &option) {
-    char ** itr = std::find(begin, end, option);
-    if (itr != end && (itr + 1) != end) {
-        return *(itr + 1);
-    }
-    return NULL;
-}
+// Reads the conflict graph in graphFile into conflicts
+void readConflictGraph();
+
+// Prints the combinations with no two conflicting members ranked in
+// [first, end). Returns the number of conflict free combinations seen, which
+// is all of them if end is ULLONG_MAX.
+unsigned long long printConflictFree(long combo[], unsigned long long first,
+                                     unsigned long long end);
 
-// Returns true if a command line option exists
-bool cmdOptionExists(char** begin, char** end, const std::string& option)
-{
-    return std::find(begin, end, option) != end;
+// Reads the member weights in weightsFile into weights
+void readWeights();
+
+// Reads onlyFile and renumbers the members, conflicts and weights to the
+// listed members
+void applyOnly();
+
+// Converts the value of a -start or -count option
+unsigned long long parseCount(const char *option, const char *value) {
+    if (value == NULL) {
+        fprintf(stderr, "Error: %s requires a value\n", option);
+        exit(EXIT_FAILURE);
+    }
+    char *end;
+    errno = 0;
+    unsigned long long ret = strtoull(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0' || value[0] == '-') {
+        fprintf(stderr, "Error: invalid value for %s: %s\n", option, value);
+        exit(EXIT_FAILURE);
+    }
+    return ret;
 }
 
 void parseCommandLine(int argc, char *argv[]) {
@@ -123,9 +234,37 @@ void parseCommandLine(int argc, char *argv[]) {
         }
     }
 
+    //// With -mixed every value is a category size
+    mixed = cmdOptionExists(argv, argv + argc, "-mixed");
+    if (mixed) {
+        if (nValOptionExists || cmdOptionExists(argv, argv + argc, "-p")) {
+            fprintf(stderr, "Error: -mixed cannot be used with -c or -p\n");
+            exit(EXIT_FAILURE);
+        }
+        std::stringstream ss(nVals);
+        long size;
+        categoryStart.assign(1, 0);
+        while (ss >> size) {
+            if (size < 0) {
+                fprintf(stderr, "Error: category sizes cannot be negative: %s\n", argv[argc-1]);
+                exit(EXIT_FAILURE);
+            }
+            categoryStart.push_back(categoryStart.back() + size);
+        }
+        if (!ss.eof() || categoryStart.size() == 1) {
+            fprintf(stderr, "Error: Malformed input string: %s\n", argv[argc-1]);
+            exit(EXIT_FAILURE);
+        }
+        if (categoryStart.back() == 0) {
+            fprintf(stderr, "Error: -mixed categories have no members: %s\n", argv[argc-1]);
+            exit(EXIT_FAILURE);
+        }
+        n = categoryStart.back() - 1;
+    }
+
     //// Extract n value
     std::stringstream ss(nVals);
-    for (long i = 0; i < nValIndex + 1L; i++) {
+    for (long i = 0; i < nValIndex + 1L && !mixed; i++) {
         ss >> n;
 #ifdef DEBUG
         fprintf(stderr, "[DEBUG] extracted value %ld from input string\n", n);
@@ -171,6 +310,95 @@ void parseCommandLine(int argc, char *argv[]) {
         }
     }
 
+    // Extract g value
+    graphFile = NULL;
+    if (cmdOptionExists(argv, argv + argc, "-g")) {
+        graphFile = getCmdValue(argv, argc + argv, "-g");
+        if (graphFile == NULL) {
+            fprintf(stderr, "Error: -g requires a value\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Extract -start, -count, -shard and -rank values
+    startRank = 0;
+    if (cmdOptionExists(argv, argv + argc, "-start")) {
+        startRank = parseCount("-start", getCmdValue(argv, argc + argv, "-start"));
+    }
+    maxCount = ULLONG_MAX;
+    if (cmdOptionExists(argv, argv + argc, "-count")) {
+        maxCount = parseCount("-count", getCmdValue(argv, argc + argv, "-count"));
+    }
+
+    useShard = cmdOptionExists(argv, argv + argc, "-shard");
+    if (useShard) {
+        char *shardValue = getCmdValue(argv, argc + argv, "-shard");
+        char tail;
+        if (shardValue == NULL
+                || sscanf(shardValue, "%ld/%ld%c", &shardIndex, &numShards, &tail) != 2) {
+            fprintf(stderr, "Error: -shard requires a value of the form i/N\n");
+            exit(EXIT_FAILURE);
+        }
+        if (numShards <= 0 || shardIndex < 0 || shardIndex >= numShards) {
+            fprintf(stderr, "Error: -shard %s: need 0 <= i < N\n", shardValue);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    rankCombo = NULL;
+    if (cmdOptionExists(argv, argv + argc, "-rank")) {
+        rankCombo = getCmdValue(argv, argc + argv, "-rank");
+        if (rankCombo == NULL) {
+            fprintf(stderr, "Error: -rank requires a value\n");
+            exit(EXIT_FAILURE);
+        }
+        if (graphFile != NULL) {
+            fprintf(stderr, "Error: -rank cannot be used with -g\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    useSample = cmdOptionExists(argv, argv + argc, "-sample");
+    if (useSample) {
+        sampleSize = parseCount("-sample", getCmdValue(argv, argc + argv, "-sample"));
+        if (useShard || rankCombo != NULL || cmdOptionExists(argv, argv + argc, "-start")
+                || cmdOptionExists(argv, argv + argc, "-count")) {
+            fprintf(stderr, "Error: -sample cannot be used with -start, -count, -shard or -rank\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    printTotal = cmdOptionExists(argv, argv + argc, "-total");
+    if (printTotal && rankCombo != NULL) {
+        fprintf(stderr, "Error: -total cannot be used with -rank\n");
+        exit(EXIT_FAILURE);
+    }
+    seed = 0;
+    if (cmdOptionExists(argv, argv + argc, "-seed")) {
+        seed = parseCount("-seed", getCmdValue(argv, argc + argv, "-seed"));
+    }
+
+    weightsFile = NULL;
+    if (cmdOptionExists(argv, argv + argc, "-weights")) {
+        weightsFile = getCmdValue(argv, argc + argv, "-weights");
+        if (weightsFile == NULL) {
+            fprintf(stderr, "Error: -weights requires a value\n");
+            exit(EXIT_FAILURE);
+        }
+        if (useShard || useSample || rankCombo != NULL) {
+            fprintf(stderr, "Error: -weights cannot be used with -shard, -sample or -rank\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    onlyFile = NULL;
+    if (cmdOptionExists(argv, argv + argc, "-only")) {
+        onlyFile = getCmdValue(argv, argc + argv, "-only");
+        if (onlyFile == NULL) {
+            fprintf(stderr, "Error: -only requires a value\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
     // Extract p value
     bool pOptionExists;
     char *pOptionValue;
@@ -203,81 +431,466 @@ void parseCommandLine(int argc, char *argv[]) {
     fprintf(stderr, "[DEBUG] k == %ld\n", k);
     fprintf(stderr, "[DEBUG] usePrefix == %s\n", (usePrefix) ? "true" : "false");
     fprintf(stderr, "[DEBUG] prefix == %ld\n", prefix);
+    fprintf(stderr, "[DEBUG] start == %llu\n", startRank);
+    fprintf(stderr, "[DEBUG] count == %llu\n", maxCount);
+    if (useShard)
+        fprintf(stderr, "[DEBUG] shard == %ld/%ld\n", shardIndex, numShards);
+    if (useSample)
+        fprintf(stderr, "[DEBUG] sample == %llu, seed == %llu\n", sampleSize, seed);
 #endif
 }
 
-int main(int argc, char *argv[]) {
-    parseCommandLine(argc, argv);
+// Prints the k members of combo separated by commas, with -mixed as
+// category and index pairs
+void printCombo(const long combo[]) {
+    if (onlyFile != NULL) {
+        static std::vector<long> listed;
+        listed.resize(k);
+        for (long i = 0; i < k; i++) {
+            listed[i] = onlyMembers[combo[i]];
+        }
+        combo = &listed[0];
+    }
+    if (!mixed) {
+        output.write(combo, k);
+        return;
+    }
+    static std::vector<long> pairs;
+    pairs.resize(2 * k);
+    // The members increase, so the category only moves forward
+    long c = 0;
+    for (long i = 0; i < k; i++) {
+        while (combo[i] >= categoryStart[c + 1]) {
+            c++;
+        }
+        pairs[2 * i] = c;
+        pairs[2 * i + 1] = combo[i] - categoryStart[c];
+    }
+    output.write(&pairs[0], 2 * k);
+}
 
-    if (n < 0 || k < 0) {
-        fprintf(stderr, "Error: neither n nor k can be negative\n");
+// Member of the index-th entry of category c with -mixed, -1 if there is no
+// such entry
+static long getMixedMember(long c, long index) {
+    if (c < 0 || c + 1 >= (long) categoryStart.size() || index < 0
+            || index >= categoryStart[c + 1] - categoryStart[c]) {
+        return -1;
+    }
+    return categoryStart[c] + index;
+}
+
+void readConflictGraph() {
+    FILE *in = fopen(graphFile, "r");
+    if (in == NULL) {
+        perror("Error: unable to open -g file");
         exit(EXIT_FAILURE);
     }
 
-    if (k > n + 1) {
-        fprintf(stderr, "Error: k > (n+1), cannot pick %ld items from %ld\n", k, n + 1);
+    conflicts.assign(n + 1, std::vector<int>());
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        long kind, a, b;
+        if (sscanf(line, "%ld %ld %ld", &kind, &a, &b) != 3) {
+            continue; // debug output or a comment
+        }
+        if (usePrefix && kind != prefix) {
+            continue;
+        }
+        if (mixed) {
+            long ma = getMixedMember(kind, a);
+            long mb = getMixedMember(kind, b);
+            if (ma < 0 || mb < 0) {
+                fprintf(stderr, "Warning: conflict %ld %ld %ld is out of range, ignoring\n",
+                        kind, a, b);
+                continue;
+            }
+            a = ma;
+            b = mb;
+        }
+        if (a < 0 || b < 0 || a > n || b > n) {
+            fprintf(stderr, "Warning: conflict %ld %ld is out of range, ignoring\n", a, b);
+            continue;
+        }
+        conflicts[a].push_back(b);
+        conflicts[b].push_back(a);
+    }
+    fclose(in);
+}
+
+void readWeights() {
+    FILE *in = fopen(weightsFile, "r");
+    if (in == NULL) {
+        perror("Error: unable to open -weights file");
         exit(EXIT_FAILURE);
     }
 
-    // array of integers that is the set for the current combinations
-    int *combo = (int *) malloc(sizeof(int) * k);
+    weights.assign(n + 1, 0.0);
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        long kind, member;
+        double weight;
+        if (sscanf(line, "%ld %ld %lf", &kind, &member, &weight) != 3) {
+            continue; // a comment or header
+        }
+        if (usePrefix && kind != prefix) {
+            continue;
+        }
+        if (mixed) {
+            long m = getMixedMember(kind, member);
+            if (m < 0) {
+                fprintf(stderr, "Warning: weight of %ld %ld is out of range, ignoring\n", kind, member);
+                continue;
+            }
+            member = m;
+        }
+        if (member < 0 || member > n) {
+            fprintf(stderr, "Warning: weight of %ld is out of range, ignoring\n", member);
+            continue;
+        }
+        weights[member] = weight;
+    }
+    fclose(in);
+}
 
-    // The first combination is from 0 to k
-    for (int i = 0; i < k; i++) {
-        combo[i] = i;   // load the array with the combination so the next one
-                        //can be calculated
-        if (i == k - 1) { // Don't print out a comma on last iteration
-            if (usePrefix)
-                printf("%ld,%d", prefix, i);
-            else
-                printf("%d", i);
+void applyOnly() {
+    FILE *in = fopen(onlyFile, "r");
+    if (in == NULL) {
+        perror("Error: unable to open -only file");
+        exit(EXIT_FAILURE);
+    }
+
+    onlyIndex.assign(n + 1, -1);
+    long stride = usePrefix || mixed ? 2 : 1;
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        long values[2];
+        char tail;
+        int found = sscanf(line, "%ld,%ld %c", &values[0], &values[1], &tail);
+        if (found != stride) {
+            continue; // not a first order member of this kind
         }
-        else {
-            if (usePrefix)
-                printf("%ld,%d,", prefix, i);
-            else
-                printf("%d,", i);
+        long member = values[stride - 1];
+        if (mixed) {
+            member = getMixedMember(values[0], values[1]);
+        }
+        else if (usePrefix && values[0] != prefix) {
+            continue;
+        }
+        if (member < 0 || member > n) {
+            fprintf(stderr, "Warning: -only member %s is out of range, ignoring", line);
+            continue;
+        }
+        onlyIndex[member] = 0;
+    }
+    fclose(in);
+
+    for (long i = 0; i <= n; i++) {
+        if (onlyIndex[i] == 0) {
+            onlyIndex[i] = onlyMembers.size();
+            onlyMembers.push_back(i);
+        }
+    }
+
+    if (graphFile != NULL) {
+        std::vector<std::vector<int> > listed(onlyMembers.size());
+        for (unsigned i = 0; i < onlyMembers.size(); i++) {
+            const std::vector<int> &c = conflicts[onlyMembers[i]];
+            for (unsigned j = 0; j < c.size(); j++) {
+                if (onlyIndex[c[j]] >= 0) {
+                    listed[i].push_back(onlyIndex[c[j]]);
+                }
+            }
+        }
+        conflicts.swap(listed);
+    }
+    if (weightsFile != NULL) {
+        std::vector<double> listed(onlyMembers.size());
+        for (unsigned i = 0; i < onlyMembers.size(); i++) {
+            listed[i] = weights[onlyMembers[i]];
+        }
+        weights.swap(listed);
+    }
+    n = (long) onlyMembers.size() - 1;
+}
+
+// Extends combo[0..depth) with members from first on, in increasing order.
+// blocked[i] counts the picked members conflicting with i. index is the rank
+// of the next complete combination, only ranks in [begin, end) are printed.
+static void extendConflictFree(long combo[], long depth, long first, std::vector<int> &blocked,
+                               unsigned long long &index, unsigned long long begin,
+                               unsigned long long end) {
+    if (depth == k) {
+        if (index >= begin) {
+            printCombo(combo);
+        }
+        index++;
+        return;
+    }
+    // Leave room for the remaining k - depth - 1 members
+    for (long i = first; i <= n - (k - depth - 1) && index < end; i++) {
+        if (blocked[i] != 0) {
+            continue;
+        }
+        combo[depth] = i;
+        for (unsigned j = 0; j < conflicts[i].size(); j++) {
+            blocked[conflicts[i][j]]++;
+        }
+        extendConflictFree(combo, depth + 1, i + 1, blocked, index, begin, end);
+        for (unsigned j = 0; j < conflicts[i].size(); j++) {
+            blocked[conflicts[i][j]]--;
+        }
+    }
+}
+
+unsigned long long printConflictFree(long combo[], unsigned long long first,
+                                     unsigned long long end) {
+    std::vector<int> blocked(n + 1, 0);
+    unsigned long long index = 0;
+    extendConflictFree(combo, 0, 0, blocked, index, first, end);
+    return index;
+}
+
+// Parses the -rank value into combo, skipping the prefixes with -p
+static void parseRankCombo(long combo[]) {
+    std::vector<long> values;
+    std::stringstream ss(rankCombo);
+    long v;
+    while (ss >> v) {
+        values.push_back(v);
+        if (ss.peek() == ',') {
+            ss.ignore();
         }
     }
-    printf("\n");
+    long stride = usePrefix || mixed ? 2 : 1;
+    if (!ss.eof() || (long) values.size() != k * stride) {
+        fprintf(stderr, "Error: -rank expects a combination of %ld members, got %s\n", k, rankCombo);
+        exit(EXIT_FAILURE);
+    }
+    for (long i = 0; i < k; i++) {
+        combo[i] = values[i * stride + stride - 1];
+        if (mixed) {
+            combo[i] = getMixedMember(values[i * stride], combo[i]);
+        }
+        if (onlyFile != NULL) {
+            bool listed = combo[i] >= 0 && combo[i] < (long) onlyIndex.size();
+            combo[i] = listed ? onlyIndex[combo[i]] : -1;
+        }
+        if (combo[i] < 0 || combo[i] > n || (i > 0 && combo[i] <= combo[i - 1])) {
+            fprintf(stderr, "Error: -rank members must be increasing, in range and listed by -only: %s\n", rankCombo);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// State of the random number generator, seeded with -seed
+static unsigned long long rngState;
 
-    while (next_comb(combo, k, n + 1)) {
-        for (int i = 0; i < k; i++) {
-            if (i == k - 1) { // Don't print out a comma on last iteration
-                if (usePrefix)
-                    printf("%ld,%d", prefix, combo[i]);
-                else
-                    printf("%d", combo[i]);
+// splitmix64, so a seed gives the same sample with every C library
+static unsigned long long nextRandom() {
+    unsigned long long z = (rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform random number in [0, bound), bound > 0
+static unsigned long long randomBelow(unsigned long long bound) {
+    // Reject the top values that would make the low residues more likely
+    unsigned long long limit = ULLONG_MAX - ULLONG_MAX % bound;
+    unsigned long long r;
+    do {
+        r = nextRandom();
+    } while (r >= limit);
+    return r % bound;
+}
+
+// Returns true if no two members of combo conflict (see -g)
+static bool isConflictFree(const long combo[]) {
+    for (long i = 0; i < k; i++) {
+        const std::vector<int> &c = conflicts[combo[i]];
+        for (unsigned j = 0; j < c.size(); j++) {
+            if (std::binary_search(combo, combo + k, c[j])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Prints sampleSize distinct random combinations out of the total of
+// C(n + 1, k), with -g only conflict free ones. sampleSize is at most the
+// total.
+static void printSample(CombinationIterator &it, unsigned long long total) {
+    rngState = seed;
+    std::set<unsigned long long> ranks;
+    if (graphFile == NULL) {
+        // Floyd's algorithm: each step adds one rank, every subset of the
+        // ranks is equally likely
+        for (unsigned long long j = total - sampleSize; j < total; j++) {
+            unsigned long long r = randomBelow(j + 1);
+            if (!ranks.insert(r).second) {
+                ranks.insert(j);
+            }
+        }
+    }
+    else {
+        // Draw from all combinations, keeping the new conflict free ones.
+        // Give up once many draws in a row found nothing.
+        unsigned long long misses = 0;
+        unsigned long long maxMisses = ULLONG_MAX;
+        if (sampleSize < ULLONG_MAX / 128) {
+            maxMisses = 64 * sampleSize + 1024;
+        }
+        while (ranks.size() < sampleSize && misses < maxMisses) {
+            unsigned long long r = randomBelow(total);
+            it.seek(r);
+            if (ranks.count(r) == 0 && isConflictFree(it.get())) {
+                ranks.insert(r);
+                misses = 0;
             }
             else {
-                if (usePrefix)
-                    printf("%ld,%d,", prefix, combo[i]);
-                else
-                    printf("%d,", combo[i]);
+                misses++;
             }
         }
-        printf("\n");
+        if (ranks.size() < sampleSize) {
+            fprintf(stderr, "Warning: only found %lu conflict free combinations for -sample\n",
+                    (unsigned long) ranks.size());
+        }
     }
 
-    return 0;
+    for (std::set<unsigned long long>::const_iterator i = ranks.begin(); i != ranks.end(); ++i) {
+        it.seek(*i);
+        printCombo(it.get());
+    }
 }
 
-// Source: https://compprog.wordpress.com/2007/10/17/generating-combinations-1/
-int next_comb(int comb[], int k, int n) {
-        int i = k - 1;
-        ++comb[i]; // increment the last value in the combination
-        while ((i >= 0) && (comb[i] >= n - k + 1 + i)) {
-                --i;
-                ++comb[i];
+// Narrows [first, end) to the -shard slice and then the -start and -count
+// range inside of it. total is the number of combinations.
+static void getSlice(unsigned long long total, unsigned long long &first,
+                     unsigned long long &end) {
+    first = 0;
+    end = total;
+    if (useShard) {
+        // The first total % numShards slices get one extra combination
+        unsigned long long size = total / numShards;
+        unsigned long long extra = total % numShards;
+        unsigned long long i = shardIndex;
+        first = i * size + (i < extra ? i : extra);
+        end = first + size + (i < extra ? 1 : 0);
+    }
+    if (startRank >= end - first) {
+        first = end;
+        return;
+    }
+    first += startRank;
+    if (maxCount < end - first) {
+        end = first + maxCount;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    parseCommandLine(argc, argv);
+
+    if (n < 0 || k < 0) {
+        fprintf(stderr, "Error: neither n nor k can be negative\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (graphFile != NULL) {
+        readConflictGraph();
+    }
+    if (weightsFile != NULL) {
+        readWeights();
+    }
+    if (onlyFile != NULL) {
+        applyOnly();
+    }
+
+    if (k > n + 1) {
+        fprintf(stderr, "Error: k > (n+1), cannot pick %ld items from %ld\n", k, n + 1);
+        exit(EXIT_FAILURE);
+    }
+
+    if (usePrefix) {
+        output.setPrefix(prefix);
+    }
+
+    // Without any of the options the enumeration does not need the count
+    bool sliced = useShard || startRank != 0 || maxCount != ULLONG_MAX || rankCombo != NULL
+        || useSample || (printTotal && graphFile == NULL);
+    unsigned long long all = CombinationIterator::count(n + 1, k);
+    unsigned long long total = all;
+    if (all == ULLONG_MAX && sliced && (graphFile == NULL || useSample)) {
+        fprintf(stderr, "Error: more than 2^64 combinations of %ld from %ld\n", k, n + 1);
+        exit(EXIT_FAILURE);
+    }
+
+    if (rankCombo != NULL) {
+        std::vector<long> combo(k);
+        parseRankCombo(&combo[0]);
+        printf("%llu\n", CombinationIterator::rankOf(&combo[0], n + 1, k));
+        return 0;
+    }
+
+    if (graphFile != NULL) {
+        std::vector<long> combo(k);
+        if (useShard || printTotal) {
+            // Size the slices by counting first
+            total = printConflictFree(&combo[0], ULLONG_MAX, ULLONG_MAX);
         }
+        else {
+            total = ULLONG_MAX;
+        }
+    }
 
-        if (comb[0] > n - k) /* Combination (n-k, n-k+1, ..., n) reached */
-                return 0; /* No more combinations can be generated */
+    unsigned long long first, end;
+    if (useSample) {
+        first = 0;
+        end = std::min(sampleSize, total);
+    }
+    else {
+        getSlice(total, first, end);
+    }
 
-        /* comb now looks like (..., x, n, n, n, ..., n).
-        Turn it into (..., x, x + 1, x + 2, ...) */
-        for (i = i + 1; i < k; ++i)
-                comb[i] = comb[i - 1] + 1;
+    if (printTotal) {
+        printf("%llu\n", end - first);
+        return 0;
+    }
+
+    if (weightsFile != NULL) {
+        // The combinations before first are made and dropped, with -g the
+        // conflicting ones take no rank
+        if (first < end) {
+            BestFirstCombinations it(weights, k);
+            unsigned long long r = 0;
+            do {
+                if (graphFile != NULL && !isConflictFree(it.get())) {
+                    continue;
+                }
+                if (r >= first) {
+                    printCombo(it.get());
+                }
+                r++;
+            } while (r < end && it.next());
+        }
+    }
+    else if (useSample) {
+        CombinationIterator it(n + 1, k);
+        sampleSize = std::min(end, all);
+        printSample(it, all);
+    }
+    else if (graphFile != NULL) {
+        std::vector<long> combo(k);
+        printConflictFree(&combo[0], first, end);
+    }
+    else if (first < end) {
+        CombinationIterator it(n + 1, k);
+        it.seek(first);
+        printCombo(it.get());
+        for (unsigned long long r = first + 1; r < end && it.next(); r++) {
+            printCombo(it.get());
+        }
+    }
 
-        return 1;
+    return 0;
 }
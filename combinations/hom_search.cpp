@@ -0,0 +1,246 @@
+/**
+ * Author: Markus Kusano
+ *
+ * Search for higher order mutants built from the first order mutants that
+ * survived, instead of every combination of every mutant.
+ *
+ *  hom_search -results first_order.txt -k 3 -run "./try_mutant.sh {}"
+ *
+ * -results gives the first order outcome, one line "<kind> <pair> <kills>"
+ * per mutant with the number of tests killing it (0 if it survived). Lines
+ * that do not start with three numbers are ignored. Only the mutants with at
+ * most -near <t> kills (default 0, the survivors) are combined.
+ *
+ * -only <file> drops the mutants not listed in the file, one "<kind>,<pair>"
+ * per line, e.g. the minimal mutant set written by subsumption.
+ *
+ * The orders 2 to -k are searched in turn. Inside an order, the combinations
+ * with the fewest first order kills in total come first (see -weights of the
+ * combinations tool), so a budget is spent on the subtlest ones. Each
+ * combination is written as "<kind>,<pair>,<kind>,<pair>..." like
+ * `combinations -mixed`, ready for -pos.
+ *
+ * -run <command> runs each higher order mutant with {} replaced by its
+ * combination. An exit status of 0 means the mutant survived, anything else
+ * that it was killed. One line "<combination>\t<killed|survived>" is printed
+ * per mutant run; without -run the combinations are only printed.
+ *
+ * -prune-killed skips the combinations containing a combination killed
+ * earlier in the search: adding mutations to a killed mutant gives a
+ * mutant that is usually killed by the same test.
+ *
+ * -budget <seconds> stops the search once the CPU time used, including the
+ * commands run, reaches the budget.
+ */
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Combinations.h"
+#include "ToolUtil.h"
+
+// A first order mutant that can be combined
+struct Candidate {
+    long kind;
+    long pair;
+    long kills;
+
+    bool operator<(const Candidate &other) const {
+        if (kind != other.kind) {
+            return kind < other.kind;
+        }
+        return pair < other.pair;
+    }
+};
+
+const char *resultsFile; // -results
+long maxOrder;           // -k
+long maxKills;           // -near, 0 if not given
+const char *runCommand;  // -run, NULL if not given
+bool pruneKilled;        // -prune-killed was passed
+double budget;           // -budget in seconds, 0 if not given
+const char *onlyFile;    // -only, NULL if not given
+
+std::vector<Candidate> candidates;
+
+// Higher order mutants killed so far, as increasing indices of candidates
+std::set<std::vector<long> > killed;
+
+void parseCommandLine(int argc, char *argv[]) {
+    char **end = argv + argc;
+
+    resultsFile = getCmdValue(argv, end, "-results");
+    if (resultsFile == NULL) {
+        fprintf(stderr, "Error: -results must be specified\n");
+        exit(EXIT_FAILURE);
+    }
+
+    maxOrder = parseLong("-k", getCmdValue(argv, end, "-k"), 2);
+
+    maxKills = 0;
+    if (cmdOptionExists(argv, end, "-near")) {
+        maxKills = parseLong("-near", getCmdValue(argv, end, "-near"), 0);
+    }
+
+    runCommand = NULL;
+    if (cmdOptionExists(argv, end, "-run")) {
+        runCommand = getCmdValue(argv, end, "-run");
+        if (runCommand == NULL || strstr(runCommand, "{}") == NULL) {
+            fprintf(stderr, "Error: -run requires a command containing {}\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    pruneKilled = cmdOptionExists(argv, end, "-prune-killed");
+    if (pruneKilled && runCommand == NULL) {
+        fprintf(stderr, "Warning: -prune-killed does nothing without -run\n");
+    }
+
+    onlyFile = NULL;
+    if (cmdOptionExists(argv, end, "-only")) {
+        onlyFile = getCmdValue(argv, end, "-only");
+        if (onlyFile == NULL) {
+            fprintf(stderr, "Error: -only requires a value\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    budget = parseBudget(argv, end);
+}
+
+// The mutants listed in onlyFile
+std::set<Candidate> readOnly() {
+    FILE *in = fopen(onlyFile, "r");
+    if (in == NULL) {
+        perror("Error: unable to open -only file");
+        exit(EXIT_FAILURE);
+    }
+
+    std::set<Candidate> listed;
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        Candidate c;
+        char tail;
+        if (sscanf(line, "%ld,%ld %c", &c.kind, &c.pair, &tail) == 2) {
+            listed.insert(c);
+        }
+    }
+    fclose(in);
+    return listed;
+}
+
+void readResults() {
+    std::set<Candidate> listed;
+    if (onlyFile != NULL) {
+        listed = readOnly();
+    }
+
+    FILE *in = fopen(resultsFile, "r");
+    if (in == NULL) {
+        perror("Error: unable to open -results file");
+        exit(EXIT_FAILURE);
+    }
+
+    std::set<Candidate> found;
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        Candidate c;
+        if (sscanf(line, "%ld %ld %ld", &c.kind, &c.pair, &c.kills) != 3) {
+            continue; // a comment or header
+        }
+        if (found.count(c) != 0) {
+            fprintf(stderr, "Warning: mutant %ld %ld is listed twice, using the first\n",
+                    c.kind, c.pair);
+            continue;
+        }
+        found.insert(c);
+        if (c.kills <= maxKills && (onlyFile == NULL || listed.count(c) != 0)) {
+            candidates.push_back(c);
+        }
+    }
+    fclose(in);
+    std::sort(candidates.begin(), candidates.end());
+}
+
+// Returns true if a killed combination is a proper subset of combo
+bool containsKilled(const long combo[], long k) {
+    std::vector<long> subset;
+    for (long j = 2; j < k; j++) {
+        CombinationIterator sub(k, j);
+        do {
+            subset.clear();
+            for (long i = 0; i < j; i++) {
+                subset.push_back(combo[sub.get()[i]]);
+            }
+            if (killed.count(subset) != 0) {
+                return true;
+            }
+        } while (sub.next());
+    }
+    return false;
+}
+
+// "<kind>,<pair>,..." of the candidates in combo
+std::string formatCombo(const long combo[], long k) {
+    std::string ret;
+    char buf[64];
+    for (long i = 0; i < k; i++) {
+        const Candidate &c = candidates[combo[i]];
+        snprintf(buf, sizeof(buf), "%s%ld,%ld", i == 0 ? "" : ",", c.kind, c.pair);
+        ret += buf;
+    }
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    parseCommandLine(argc, argv);
+    readResults();
+
+    // Fewer first order kills is better
+    std::vector<double> weights;
+    for (unsigned i = 0; i < candidates.size(); i++) {
+        weights.push_back(-candidates[i].kills);
+    }
+
+    unsigned long long run = 0, numKilled = 0, pruned = 0;
+    bool outOfBudget = false;
+    for (long order = 2; order <= maxOrder && order <= (long) candidates.size() && !outOfBudget;
+            order++) {
+        BestFirstCombinations it(weights, order);
+        do {
+            const long *combo = it.get();
+            if (pruneKilled && containsKilled(combo, order)) {
+                pruned++;
+                continue;
+            }
+            if (budget != 0 && cpuTime() >= budget) {
+                outOfBudget = true;
+                break;
+            }
+            std::string str = formatCombo(combo, order);
+            if (runCommand == NULL) {
+                printf("%s\n", str.c_str());
+                continue;
+            }
+            bool wasKilled = runMutant(runCommand, str);
+            printf("%s\t%s\n", str.c_str(), wasKilled ? "killed" : "survived");
+            fflush(stdout);
+            run++;
+            if (wasKilled) {
+                numKilled++;
+                killed.insert(std::vector<long>(combo, combo + order));
+            }
+        } while (it.next());
+    }
+
+    fprintf(stderr, "%lu candidates, %llu run, %llu killed, %llu pruned%s\n",
+            (unsigned long) candidates.size(), run, numKilled, pruned,
+            outOfBudget ? ", stopped at the -budget" : "");
+    return 0;
+}
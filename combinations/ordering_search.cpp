@@ -0,0 +1,288 @@
+/**
+ * Author: Markus Kusano
+ *
+ * Adaptive search of the memory ordering mutants of the Load, Store,
+ * AtomicRMW, CmpXchg and Fence operators: instead of running `-mod` with
+ * every ordering weaker than the original one, only the orderings needed to
+ * tell which of them are killed are run.
+ *
+ *  ordering_search -sites sites.txt -run "./try_mutant.sh {}"
+ *
+ * -sites is the -verbose output of one of the operators (opt -analyze ...
+ * -verbose 2>sites.txt), which lists each site with its instruction. The
+ * ordering of a site is read from the instruction.
+ *
+ * -run <command> runs a mutant with {} replaced by "-pos=<site>
+ * -order=<value>", the arguments of `-mod` selecting it, with the -order
+ * numbering of the operator of the site. An exit status of 0 means the mutant
+ * survived, anything else that it was killed.
+ *
+ * The orderings of an instruction form a lattice: monotonic is below acquire
+ * and release, which are below acq_rel, which is below seq_cst (unordered is
+ * below monotonic for loads and stores). The search assumes a mutant with an
+ * ordering stronger than a surviving one survives too, and one with an
+ * ordering weaker than a killed one is killed too. The weakest orderings are
+ * run first: when they survive, the orderings between them and the original
+ * are not run. When they are killed, the remaining orderings are bisected,
+ * running the one that settles the most orderings whatever its outcome.
+ *
+ * One line "<site>\t<ordering>\t<killed|survived>\t<run|inferred>" is
+ * printed per ordering mutant, for every ordering weaker than the original.
+ *
+ * -budget <seconds> stops the search once the CPU time used, including the
+ * commands run, reaches the budget.
+ */
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ToolUtil.h"
+
+// Orderings of an instruction, in the -order numbering of its operator
+struct Lattice {
+    const char *opcode;
+    unsigned size;
+    const char *names[5];
+    // below[b] has bit a set if ordering a is at most as strong as b
+    unsigned below[5];
+};
+
+const Lattice lattices[] = {
+    { "load", 4, { "unordered", "monotonic", "acquire", "seq_cst" },
+        { 0x1, 0x3, 0x7, 0xf } },
+    { "store", 4, { "unordered", "monotonic", "release", "seq_cst" },
+        { 0x1, 0x3, 0x7, 0xf } },
+    { "atomicrmw", 5, { "monotonic", "acquire", "release", "acq_rel", "seq_cst" },
+        { 0x1, 0x3, 0x5, 0xf, 0x1f } },
+    { "cmpxchg", 5, { "monotonic", "acquire", "release", "acq_rel", "seq_cst" },
+        { 0x1, 0x3, 0x5, 0xf, 0x1f } },
+    { "fence", 4, { "acquire", "release", "acq_rel", "seq_cst" },
+        { 0x1, 0x2, 0x7, 0xf } },
+};
+const unsigned numLattices = sizeof(lattices) / sizeof(lattices[0]);
+
+// An atomic instruction listed by an operator
+struct Site {
+    long index;
+    const Lattice *lattice;
+    unsigned order; // original ordering
+};
+
+enum Outcome { Unknown, Killed, Survived };
+
+const char *sitesFile;  // -sites
+const char *runCommand; // -run
+double budget;          // -budget in seconds, 0 if not given
+
+std::vector<Site> sites;
+
+void parseCommandLine(int argc, char *argv[]) {
+    char **end = argv + argc;
+
+    sitesFile = getCmdValue(argv, end, "-sites");
+    if (sitesFile == NULL) {
+        fprintf(stderr, "Error: -sites must be specified\n");
+        exit(EXIT_FAILURE);
+    }
+
+    runCommand = getCmdValue(argv, end, "-run");
+    if (runCommand == NULL || strstr(runCommand, "{}") == NULL) {
+        fprintf(stderr, "Error: -run requires a command containing {}\n");
+        exit(EXIT_FAILURE);
+    }
+
+    budget = parseBudget(argv, end);
+}
+
+// Finds the lattice and ordering of the instruction text of a site, returns
+// false if it is not an atomic instruction
+bool parseInstruction(const std::string &text, Site &site) {
+    std::stringstream ss(text);
+    std::string word;
+    site.lattice = NULL;
+    bool hasOrder = false;
+    while (ss >> word) {
+        if (!word.empty() && word[word.size() - 1] == ',') {
+            word.erase(word.size() - 1);
+        }
+        for (unsigned i = 0; i < numLattices && site.lattice == NULL; i++) {
+            if (word == lattices[i].opcode) {
+                site.lattice = &lattices[i];
+            }
+        }
+        if (site.lattice == NULL || hasOrder) {
+            continue;
+        }
+        for (unsigned i = 0; i < site.lattice->size; i++) {
+            if (word == site.lattice->names[i]) {
+                site.order = i;
+                hasOrder = true;
+            }
+        }
+    }
+    return site.lattice != NULL && hasOrder;
+}
+
+void readSites() {
+    FILE *in = fopen(sitesFile, "r");
+    if (in == NULL) {
+        perror("Error: unable to open -sites file");
+        exit(EXIT_FAILURE);
+    }
+
+    // -verbose writes "<index>\t<file>:<line>" then the instruction after a tab
+    long index = -1;
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        long i;
+        char tab;
+        if (line[0] != '\t' && sscanf(line, "%ld%c", &i, &tab) == 2 && tab == '\t') {
+            index = i;
+            continue;
+        }
+        if (line[0] != '\t' || index < 0) {
+            continue; // the count of another operator or a message
+        }
+        Site site;
+        site.index = index;
+        index = -1;
+        if (!parseInstruction(line, site)) {
+            fprintf(stderr, "Warning: no memory ordering found for site %ld, skipping\n",
+                    site.index);
+            continue;
+        }
+        if (!sites.empty() && sites[0].lattice != site.lattice) {
+            fprintf(stderr, "Error: -sites lists both %s and %s instructions, "
+                    "use the output of a single operator\n",
+                    sites[0].lattice->opcode, site.lattice->opcode);
+            exit(EXIT_FAILURE);
+        }
+        sites.push_back(site);
+    }
+    fclose(in);
+}
+
+// Runs the mutant, returns true if it was killed
+bool runOrdering(long index, unsigned order) {
+    char args[64];
+    snprintf(args, sizeof(args), "-pos=%ld -order=%u", index, order);
+    return runMutant(runCommand, args);
+}
+
+// Number of unknown orderings settled if ordering x has the given outcome:
+// the weaker ones if it is killed, the stronger ones if it survives
+unsigned settled(const Site &site, const std::vector<Outcome> &outcome, unsigned x,
+        Outcome result) {
+    const unsigned *below = site.lattice->below;
+    unsigned ret = 0;
+    for (unsigned y = 0; y < outcome.size(); y++) {
+        bool implied = result == Killed ? (below[x] >> y & 1) : (below[y] >> x & 1);
+        if (outcome[y] == Unknown && implied) {
+            ret++;
+        }
+    }
+    return ret;
+}
+
+// Sets the outcome of x and of the orderings it implies
+void settle(const Site &site, std::vector<Outcome> &outcome, unsigned x, Outcome result) {
+    const unsigned *below = site.lattice->below;
+    for (unsigned y = 0; y < outcome.size(); y++) {
+        bool implied = result == Killed ? (below[x] >> y & 1) : (below[y] >> x & 1);
+        if (outcome[y] == Unknown && implied) {
+            outcome[y] = result;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    parseCommandLine(argc, argv);
+    readSites();
+
+    unsigned long long total = 0, run = 0, numKilled = 0;
+    bool outOfBudget = false;
+    for (unsigned s = 0; s < sites.size() && !outOfBudget; s++) {
+        const Site &site = sites[s];
+        const unsigned *below = site.lattice->below;
+
+        // The candidates are the orderings strictly weaker than the original,
+        // the others are not candidates and start out settled
+        std::vector<Outcome> outcome(site.lattice->size, Survived);
+        std::vector<bool> wasRun(site.lattice->size, false);
+        unsigned candidates = 0;
+        for (unsigned x = 0; x < outcome.size(); x++) {
+            if (x != site.order && (below[site.order] >> x & 1)) {
+                outcome[x] = Unknown;
+                candidates++;
+            }
+        }
+        total += candidates;
+
+        for (;;) {
+            // The weakest unknown ordering, else the one settling the most
+            // orderings in the worst case, then in total. Ties go to the
+            // weaker ordering.
+            unsigned best = outcome.size();
+            unsigned bestWorst = 0, bestSum = 0;
+            bool bestMinimal = false;
+            for (unsigned x = 0; x < outcome.size(); x++) {
+                if (outcome[x] != Unknown) {
+                    continue;
+                }
+                bool minimal = true;
+                for (unsigned y = 0; y < outcome.size(); y++) {
+                    if (y != x && (below[x] >> y & 1) && outcome[y] != Survived) {
+                        minimal = false;
+                    }
+                }
+                unsigned ifKilled = settled(site, outcome, x, Killed);
+                unsigned ifSurvived = settled(site, outcome, x, Survived);
+                unsigned worst = std::min(ifKilled, ifSurvived);
+                unsigned sum = ifKilled + ifSurvived;
+                bool better = minimal != bestMinimal ? minimal
+                        : worst != bestWorst ? worst > bestWorst : sum > bestSum;
+                if (best == outcome.size() || better) {
+                    best = x;
+                    bestWorst = worst;
+                    bestSum = sum;
+                    bestMinimal = minimal;
+                }
+            }
+            if (best == outcome.size()) {
+                break;
+            }
+            if (budget != 0 && cpuTime() >= budget) {
+                outOfBudget = true;
+                break;
+            }
+            bool wasKilled = runOrdering(site.index, best);
+            run++;
+            wasRun[best] = true;
+            settle(site, outcome, best, wasKilled ? Killed : Survived);
+        }
+        if (outOfBudget) {
+            break;
+        }
+
+        for (unsigned x = 0; x < outcome.size(); x++) {
+            if (x == site.order || !(below[site.order] >> x & 1)) {
+                continue;
+            }
+            numKilled += outcome[x] == Killed;
+            printf("%ld\t%s\t%s\t%s\n", site.index, site.lattice->names[x],
+                    outcome[x] == Killed ? "killed" : "survived",
+                    wasRun[x] ? "run" : "inferred");
+        }
+        fflush(stdout);
+    }
+
+    fprintf(stderr, "%lu sites, %llu ordering mutants, %llu run, %llu killed%s\n",
+            (unsigned long) sites.size(), total, run, numKilled,
+            outOfBudget ? ", stopped at the -budget" : "");
+    return 0;
+}
@@ -0,0 +1,424 @@
+/**
+ * Author: Markus Kusano
+ *
+ * Dry run of a mutation campaign: projects how many mutants it makes, how
+ * much bitcode they take and how long they take to test, without making any.
+ *
+ *  plan -sites sites.txt -operators Load=3,PthreadMutexLock -k 1,2
+ *       [-timing timing.txt] [-cores 1,8,64] [-keep 0.5] [-sample N]
+ *       [-mixed] [-disk 500G]
+ *
+ * -sites lists the sites, one line "<name> <count>..." per operator or kind
+ * of primitive. The counts of a line are added up, so the output of
+ * `opt -analyze -site-catalog` (kind, calls, invokes) can be used as is, as
+ * can lines made from the count each operator prints with -analyze. Empty
+ * lines and lines starting with # are ignored.
+ *
+ * -operators picks the names of -sites to plan for. "<name>=<m>" makes m
+ * mutants per site, e.g. 3 for the -order values of Load -mod; the default
+ * is 1.
+ *
+ * -k lists the orders of the mutants, the number of sites mutated together
+ * (default 1). A mutant of order k picks k distinct sites of an operator, or
+ * of all the operators with -mixed (see -mixed of the combinations tool),
+ * and one of the m mutants of each.
+ *
+ * -keep <fraction> is the fraction of the mutants left by the filters of the
+ * campaign (e.g. -g of the combinations tool, or the share of a minimal set
+ * from subsumption in an earlier campaign). -sample <N> caps the number of
+ * mutants of each operator and order like -sample of the combinations tool.
+ *
+ * -timing gives measured mutants, one line "<name> <bytes> <seconds>" per
+ * mutant generated, compiled and tested for real: the size of its bitcode
+ * and the CPU seconds of the three steps. The averages of an operator are
+ * used for its mutants, the averages of all the lines for operators without
+ * any (with a warning). Without -timing only the counts are projected.
+ *
+ * One line "<name>\t<k>\t<mutants>\t<bytes>\t<cpu hours>" is printed per
+ * operator and order, followed by the totals and the wall clock hours for
+ * each number of cores of -cores (default 1). A core tests one mutant at a
+ * time, so the wall clock is the CPU time of the mutants of the busiest core.
+ *
+ * -disk <size> (suffix K, M, G or T) exits with status 2 if the projected
+ * bitcode does not fit, so a script can stop before launching the campaign.
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ToolUtil.h"
+
+// An operator to plan for
+struct Operator {
+    std::string name;
+    double perSite;  // mutants per site
+    double sites;
+    double bytes;    // average bitcode size of a mutant, from -timing
+    double seconds;  // average CPU seconds of a mutant, from -timing
+};
+
+// Projection for an operator (or all of them with -mixed) and an order
+struct Projection {
+    std::string name;
+    long k;
+    double mutants;
+    double bytes;
+    double seconds;
+};
+
+const char *sitesFile;       // -sites
+const char *timingFile;      // -timing, NULL if not given
+std::vector<long> orders;    // -k
+std::vector<long> cores;     // -cores
+double keep;                 // -keep, 1 if not given
+double sampleSize;           // -sample, 0 if not given
+bool mixed;                  // -mixed was passed
+double disk;                 // -disk in bytes, 0 if not given
+
+std::vector<Operator> operators;
+
+// Converts a comma separated list of numbers of at least 1, exiting if it is
+// not one
+std::vector<long> parseList(const char *option, const char *value) {
+    std::vector<long> ret;
+    const char *p = value;
+    while (p != NULL) {
+        char *end;
+        long v = strtol(p, &end, 10);
+        if (end == p || (*end != ',' && *end != '\0') || v < 1) {
+            fprintf(stderr, "Error: %s requires a comma separated list of numbers "
+                    "of at least 1\n", option);
+            exit(EXIT_FAILURE);
+        }
+        ret.push_back(v);
+        p = *end == ',' ? end + 1 : NULL;
+    }
+    return ret;
+}
+
+// Converts the value of a numeric option, exiting if it is not a positive
+// number. A suffix K, M, G or T is allowed if withSuffix is true.
+double parseNumber(const char *option, const char *value, bool withSuffix) {
+    char *end;
+    double ret = value == NULL ? 0 : strtod(value, &end);
+    if (value != NULL && withSuffix && end != value && *end != '\0' && end[1] == '\0') {
+        const char *suffixes = "KMGT";
+        const char *s = strchr(suffixes, *end);
+        if (s != NULL) {
+            ret *= pow(1024.0, (double) (s - suffixes + 1));
+            end++;
+        }
+    }
+    if (value == NULL || end == value || *end != '\0' || !(ret > 0)) {
+        fprintf(stderr, "Error: %s requires a positive number\n", option);
+        exit(EXIT_FAILURE);
+    }
+    return ret;
+}
+
+void parseCommandLine(int argc, char *argv[]) {
+    char **end = argv + argc;
+
+    sitesFile = getCmdValue(argv, end, "-sites");
+    if (sitesFile == NULL) {
+        fprintf(stderr, "Error: -sites must be specified\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const char *ops = getCmdValue(argv, end, "-operators");
+    if (ops == NULL) {
+        fprintf(stderr, "Error: -operators must be specified\n");
+        exit(EXIT_FAILURE);
+    }
+    std::stringstream ss(ops);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        Operator op;
+        size_t eq = item.find('=');
+        op.name = item.substr(0, eq);
+        op.perSite = 1;
+        if (eq != std::string::npos) {
+            op.perSite = parseNumber("-operators", item.c_str() + eq + 1, false);
+        }
+        if (op.name.empty()) {
+            fprintf(stderr, "Error: -operators has an empty name\n");
+            exit(EXIT_FAILURE);
+        }
+        op.sites = -1;
+        op.bytes = 0;
+        op.seconds = 0;
+        operators.push_back(op);
+    }
+
+    orders.assign(1, 1);
+    if (cmdOptionExists(argv, end, "-k")) {
+        orders = parseList("-k", getCmdValue(argv, end, "-k"));
+    }
+    cores.assign(1, 1);
+    if (cmdOptionExists(argv, end, "-cores")) {
+        cores = parseList("-cores", getCmdValue(argv, end, "-cores"));
+    }
+
+    timingFile = NULL;
+    if (cmdOptionExists(argv, end, "-timing")) {
+        timingFile = getCmdValue(argv, end, "-timing");
+        if (timingFile == NULL) {
+            fprintf(stderr, "Error: -timing requires a value\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    keep = 1;
+    if (cmdOptionExists(argv, end, "-keep")) {
+        keep = parseNumber("-keep", getCmdValue(argv, end, "-keep"), false);
+        if (keep > 1) {
+            fprintf(stderr, "Error: -keep requires a fraction of at most 1\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    sampleSize = 0;
+    if (cmdOptionExists(argv, end, "-sample")) {
+        sampleSize = parseNumber("-sample", getCmdValue(argv, end, "-sample"), false);
+    }
+
+    mixed = cmdOptionExists(argv, end, "-mixed");
+
+    disk = 0;
+    if (cmdOptionExists(argv, end, "-disk")) {
+        disk = parseNumber("-disk", getCmdValue(argv, end, "-disk"), true);
+        if (timingFile == NULL) {
+            fprintf(stderr, "Error: -disk requires -timing to project the bytes\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+Operator *findOperator(const std::string &name) {
+    for (unsigned i = 0; i < operators.size(); i++) {
+        if (operators[i].name == name) {
+            return &operators[i];
+        }
+    }
+    return NULL;
+}
+
+void readSites() {
+    FILE *in = fopen(sitesFile, "r");
+    if (in == NULL) {
+        perror("Error: unable to open -sites file");
+        exit(EXIT_FAILURE);
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        std::stringstream ss(line);
+        std::string name;
+        if (!(ss >> name) || name[0] == '#') {
+            continue;
+        }
+        Operator *op = findOperator(name);
+        if (op == NULL) {
+            continue;
+        }
+        double count, sites = 0;
+        while (ss >> count) {
+            sites += count;
+        }
+        op->sites = std::max(op->sites, 0.0) + sites;
+    }
+    fclose(in);
+
+    for (unsigned i = 0; i < operators.size(); i++) {
+        if (operators[i].sites < 0) {
+            fprintf(stderr, "Warning: %s is not listed in -sites, it has no sites\n",
+                    operators[i].name.c_str());
+            operators[i].sites = 0;
+        }
+    }
+}
+
+void readTiming() {
+    FILE *in = fopen(timingFile, "r");
+    if (in == NULL) {
+        perror("Error: unable to open -timing file");
+        exit(EXIT_FAILURE);
+    }
+
+    std::map<std::string, unsigned> samples;
+    double allBytes = 0, allSeconds = 0;
+    unsigned all = 0;
+    char line[4096];
+    char name[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        double bytes, seconds;
+        if (sscanf(line, "%4095s %lf %lf", name, &bytes, &seconds) != 3 || name[0] == '#') {
+            continue;
+        }
+        allBytes += bytes;
+        allSeconds += seconds;
+        all++;
+        Operator *op = findOperator(name);
+        if (op != NULL) {
+            op->bytes += bytes;
+            op->seconds += seconds;
+            samples[name]++;
+        }
+    }
+    fclose(in);
+
+    if (all == 0) {
+        fprintf(stderr, "Error: -timing has no measured mutants\n");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned i = 0; i < operators.size(); i++) {
+        Operator &op = operators[i];
+        unsigned n = samples[op.name];
+        if (n == 0) {
+            fprintf(stderr, "Warning: no -timing for %s, using the average of all "
+                    "%u mutants\n", op.name.c_str(), all);
+            op.bytes = allBytes / all;
+            op.seconds = allSeconds / all;
+        }
+        else {
+            op.bytes /= n;
+            op.seconds /= n;
+        }
+    }
+}
+
+// Number of mutants of order k from the operators: the coefficient of x^k of
+// the product of (1 + m x)^sites, picking k sites and one of the m mutants of
+// each. Kept in doubles, the counts of large campaigns do not fit 64 bits.
+double countMutants(const std::vector<const Operator *> &ops, long k) {
+    std::vector<double> coef(k + 1, 0);
+    coef[0] = 1;
+    for (unsigned i = 0; i < ops.size(); i++) {
+        // (1 + m x)^sites = sum over j of C(sites, j) m^j x^j
+        double sites = ops[i]->sites;
+        std::vector<double> term(k + 1, 0);
+        term[0] = 1;
+        for (long j = 1; j <= k && j <= sites; j++) {
+            term[j] = term[j - 1] * (sites - j + 1) / j * ops[i]->perSite;
+        }
+        std::vector<double> product(k + 1, 0);
+        for (long a = 0; a <= k; a++) {
+            for (long b = 0; a + b <= k; b++) {
+                product[a + b] += coef[a] * term[b];
+            }
+        }
+        coef = product;
+    }
+    return coef[k];
+}
+
+Projection project(const std::string &name, const std::vector<const Operator *> &ops,
+        long k) {
+    Projection p;
+    p.name = name;
+    p.k = k;
+    p.mutants = floor(countMutants(ops, k) * keep);
+    if (sampleSize != 0) {
+        p.mutants = std::min(p.mutants, sampleSize);
+    }
+
+    // A mutant of several operators costs about their average, weighted by
+    // the number of first order mutants of each
+    double weight = 0, bytes = 0, seconds = 0;
+    for (unsigned i = 0; i < ops.size(); i++) {
+        double w = ops[i]->sites * ops[i]->perSite;
+        weight += w;
+        bytes += w * ops[i]->bytes;
+        seconds += w * ops[i]->seconds;
+    }
+    p.bytes = weight == 0 ? 0 : p.mutants * bytes / weight;
+    p.seconds = weight == 0 ? 0 : p.mutants * seconds / weight;
+    return p;
+}
+
+// Formats bytes with a binary suffix
+std::string formatBytes(double bytes) {
+    const char *suffixes[] = { "B", "K", "M", "G", "T", "P" };
+    unsigned s = 0;
+    while (bytes >= 1024 && s < 5) {
+        bytes /= 1024;
+        s++;
+    }
+    char buf[64];
+    snprintf(buf, sizeof(buf), s == 0 ? "%.0f%s" : "%.1f%s", bytes, suffixes[s]);
+    return buf;
+}
+
+void printProjection(const Projection &p) {
+    if (timingFile == NULL) {
+        printf("%s\t%ld\t%.0f\n", p.name.c_str(), p.k, p.mutants);
+    }
+    else {
+        printf("%s\t%ld\t%.0f\t%s\t%.2f\n", p.name.c_str(), p.k, p.mutants,
+                formatBytes(p.bytes).c_str(), p.seconds / 3600);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    parseCommandLine(argc, argv);
+    readSites();
+    if (timingFile != NULL) {
+        readTiming();
+    }
+
+    std::vector<Projection> projections;
+    for (unsigned i = 0; i < orders.size(); i++) {
+        if (mixed) {
+            std::vector<const Operator *> all;
+            for (unsigned j = 0; j < operators.size(); j++) {
+                all.push_back(&operators[j]);
+            }
+            projections.push_back(project("mixed", all, orders[i]));
+            continue;
+        }
+        for (unsigned j = 0; j < operators.size(); j++) {
+            std::vector<const Operator *> one(1, &operators[j]);
+            projections.push_back(project(operators[j].name, one, orders[i]));
+        }
+    }
+
+    printf(timingFile == NULL ? "# operator\tk\tmutants\n"
+            : "# operator\tk\tmutants\tbytes\tcpu_hours\n");
+    Projection total;
+    total.name = "total";
+    total.k = 0;
+    total.mutants = total.bytes = total.seconds = 0;
+    for (unsigned i = 0; i < projections.size(); i++) {
+        printProjection(projections[i]);
+        total.mutants += projections[i].mutants;
+        total.bytes += projections[i].bytes;
+        total.seconds += projections[i].seconds;
+    }
+    if (timingFile == NULL) {
+        printf("total\t\t%.0f\n", total.mutants);
+        return 0;
+    }
+    printf("total\t\t%.0f\t%s\t%.2f\n", total.mutants, formatBytes(total.bytes).c_str(),
+            total.seconds / 3600);
+
+    printf("# cores\twall_hours\n");
+    double perMutant = total.mutants == 0 ? 0 : total.seconds / total.mutants;
+    for (unsigned i = 0; i < cores.size(); i++) {
+        double busiest = ceil(total.mutants / cores[i]);
+        printf("%ld\t%.2f\n", cores[i], busiest * perMutant / 3600);
+    }
+
+    if (disk != 0 && total.bytes > disk) {
+        fprintf(stderr, "Error: the campaign needs %s of bitcode, more than the -disk "
+                "of %s\n", formatBytes(total.bytes).c_str(), formatBytes(disk).c_str());
+        return 2;
+    }
+    return 0;
+}
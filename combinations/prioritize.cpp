@@ -0,0 +1,454 @@
+/**
+ * Author: Markus Kusano
+ *
+ * Orders the first order mutants of a campaign so the ones telling the most
+ * per CPU second run first, using models trained on earlier campaigns.
+ *
+ * The features of each site come from an operator's -features analysis (e.g.
+ * `Mutex -analyze -features`): a header "# kind index <name>..." naming the
+ * columns, then one line per site with its kind, index and numeric features.
+ *
+ * Recording a finished campaign:
+ *
+ *  prioritize -record -features features.txt -results results.txt >> history.txt
+ *
+ * -results has one line "<operator> <kind>,<index> <killed> <seconds>" per
+ * mutant run, killed 1 or 0 and seconds the CPU time to build and test it.
+ * Each is joined with the features of its site into a training row of the
+ * history: "<operator> <killed> <seconds> <features>...", after a header
+ * naming the features. The history of every campaign can be appended to the
+ * same file as long as the features are the same.
+ *
+ * Scheduling the next one:
+ *
+ *  prioritize -history history.txt -features features.txt -operators rm,swap [-budget <seconds>]
+ *
+ * Two models are fit to the history: a logistic regression predicting if a
+ * mutant is killed and a linear regression predicting the logarithm of its
+ * seconds. The inputs are the standardized features and one indicator per
+ * operator of the history. Every operator of -operators is paired with every
+ * site of -features and printed as "<operator>\t<kind>,<index>\t<kill
+ * probability>\t<seconds>\t<bits per second>", best first. The value of a
+ * mutant is the entropy of its predicted outcome: a mutant that is surely
+ * killed or surely survives tells little. With -budget the list stops once
+ * the predicted seconds would exceed the budget.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ToolUtil.h"
+
+typedef std::vector<double> Vector;
+typedef std::vector<Vector> Matrix;
+
+// Ridge penalty of both models, keeps them defined with little history
+const double lambda = 1e-3;
+
+const char *featuresFile; // -features
+const char *resultsFile;  // -results with -record
+const char *historyFile;  // -history
+bool recordMode;          // -record was passed
+double budget;            // -budget in seconds, 0 if not given
+std::vector<std::string> operators; // -operators
+
+// Columns and rows of featuresFile, the rows by "<kind>,<index>"
+std::vector<std::string> featureNames;
+std::vector<std::string> sites;
+std::map<std::string, Vector> siteFeatures;
+
+// A row of the history
+struct Sample {
+    std::string op;
+    bool killed;
+    double seconds;
+    Vector features;
+};
+
+// Value of a required option
+const char *getRequired(char **begin, char **end, const char *option) {
+    const char *value = getCmdValue(begin, end, option);
+    if (value == NULL) {
+        fprintf(stderr, "Error: %s must be specified\n", option);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+void parseCommandLine(int argc, char *argv[]) {
+    char **end = argv + argc;
+
+    featuresFile = getRequired(argv, end, "-features");
+    recordMode = cmdOptionExists(argv, end, "-record");
+    if (recordMode) {
+        resultsFile = getRequired(argv, end, "-results");
+        return;
+    }
+
+    historyFile = getRequired(argv, end, "-history");
+    std::stringstream ss(getRequired(argv, end, "-operators"));
+    std::string op;
+    while (std::getline(ss, op, ',')) {
+        if (!op.empty()) {
+            operators.push_back(op);
+        }
+    }
+
+    budget = parseBudget(argv, end);
+}
+
+FILE *openOrExit(const char *file, const char *option) {
+    FILE *in = fopen(file, "r");
+    if (in == NULL) {
+        fprintf(stderr, "Error: unable to open %s file %s\n", option, file);
+        exit(EXIT_FAILURE);
+    }
+    return in;
+}
+
+// Names after the first skip columns of a "# ..." header line
+std::vector<std::string> parseHeader(const char *line, unsigned skip) {
+    std::stringstream ss(line + 1);
+    std::vector<std::string> names;
+    std::string name;
+    while (ss >> name) {
+        names.push_back(name);
+    }
+    names.erase(names.begin(), names.begin() + std::min<size_t>(skip, names.size()));
+    return names;
+}
+
+void readFeatures() {
+    FILE *in = openOrExit(featuresFile, "-features");
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        if (line[0] == '#') {
+            featureNames = parseHeader(line, 2);
+            continue;
+        }
+        std::stringstream ss(line);
+        long kind, index;
+        if (!(ss >> kind >> index)) {
+            continue; // not a site
+        }
+        Vector values;
+        double v;
+        while (ss >> v) {
+            values.push_back(v);
+        }
+        if (values.size() != featureNames.size()) {
+            fprintf(stderr, "Error: -features line does not match its header: %s", line);
+            exit(EXIT_FAILURE);
+        }
+        std::stringstream site;
+        site << kind << ',' << index;
+        sites.push_back(site.str());
+        siteFeatures[site.str()] = values;
+    }
+    fclose(in);
+}
+
+// Joins the results with the features of their sites
+void record() {
+    FILE *in = openOrExit(resultsFile, "-results");
+    printf("# operator killed seconds");
+    for (unsigned i = 0; i < featureNames.size(); i++) {
+        printf(" %s", featureNames[i].c_str());
+    }
+    printf("\n");
+
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        char op[256], site[256];
+        int killed;
+        double seconds;
+        if (sscanf(line, "%255s %255s %d %lf", op, site, &killed, &seconds) != 4 || op[0] == '#') {
+            continue;
+        }
+        std::map<std::string, Vector>::iterator f = siteFeatures.find(site);
+        if (f == siteFeatures.end()) {
+            fprintf(stderr, "Warning: no features for site %s, skipping\n", site);
+            continue;
+        }
+        printf("%s\t%d\t%g", op, killed != 0, seconds);
+        for (unsigned i = 0; i < f->second.size(); i++) {
+            printf("\t%g", f->second[i]);
+        }
+        printf("\n");
+    }
+    fclose(in);
+}
+
+std::vector<Sample> readHistory() {
+    FILE *in = openOrExit(historyFile, "-history");
+    std::vector<Sample> history;
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        if (line[0] == '#') {
+            if (parseHeader(line, 3) != featureNames) {
+                fprintf(stderr, "Error: the features of -history and -features differ\n");
+                exit(EXIT_FAILURE);
+            }
+            continue;
+        }
+        std::stringstream ss(line);
+        Sample s;
+        int killed;
+        if (!(ss >> s.op >> killed >> s.seconds)) {
+            continue;
+        }
+        s.killed = killed != 0;
+        double v;
+        while (ss >> v) {
+            s.features.push_back(v);
+        }
+        if (s.features.size() != featureNames.size()) {
+            fprintf(stderr, "Error: -history line does not match its header: %s", line);
+            exit(EXIT_FAILURE);
+        }
+        history.push_back(s);
+    }
+    fclose(in);
+    return history;
+}
+
+// Solves A x = b by Gaussian elimination with partial pivoting. A is
+// positive definite here thanks to the ridge penalty.
+Vector solve(Matrix A, Vector b) {
+    unsigned n = b.size();
+    for (unsigned c = 0; c < n; c++) {
+        unsigned pivot = c;
+        for (unsigned r = c + 1; r < n; r++) {
+            if (fabs(A[r][c]) > fabs(A[pivot][c])) {
+                pivot = r;
+            }
+        }
+        std::swap(A[c], A[pivot]);
+        std::swap(b[c], b[pivot]);
+        for (unsigned r = c + 1; r < n; r++) {
+            double f = A[r][c] / A[c][c];
+            for (unsigned j = c; j < n; j++) {
+                A[r][j] -= f * A[c][j];
+            }
+            b[r] -= f * b[c];
+        }
+    }
+    Vector x(n);
+    for (unsigned c = n; c-- > 0; ) {
+        double sum = b[c];
+        for (unsigned j = c + 1; j < n; j++) {
+            sum -= A[c][j] * x[j];
+        }
+        x[c] = sum / A[c][c];
+    }
+    return x;
+}
+
+double dot(const Vector &a, const Vector &b) {
+    double sum = 0;
+    for (unsigned i = 0; i < a.size(); i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+double sigmoid(double z) {
+    return 1 / (1 + exp(-z));
+}
+
+// Builds the model inputs: an intercept, the standardized features and the
+// operator indicators
+class Inputs {
+    public:
+        Inputs(const std::vector<Sample> &history) {
+            unsigned n = featureNames.size();
+            mean.assign(n, 0);
+            scale.assign(n, 0);
+            for (unsigned i = 0; i < history.size(); i++) {
+                for (unsigned j = 0; j < n; j++) {
+                    mean[j] += history[i].features[j] / history.size();
+                }
+                if (opIndex.count(history[i].op) == 0) {
+                    unsigned next = opIndex.size();
+                    opIndex[history[i].op] = next;
+                }
+            }
+            for (unsigned i = 0; i < history.size(); i++) {
+                for (unsigned j = 0; j < n; j++) {
+                    double d = history[i].features[j] - mean[j];
+                    scale[j] += d * d / history.size();
+                }
+            }
+            for (unsigned j = 0; j < n; j++) {
+                scale[j] = scale[j] > 0 ? sqrt(scale[j]) : 1;
+            }
+        }
+
+        unsigned size() const {
+            return 1 + mean.size() + opIndex.size();
+        }
+
+        bool knowsOperator(const std::string &op) const {
+            return opIndex.count(op) != 0;
+        }
+
+        Vector get(const std::string &op, const Vector &features) const {
+            Vector x(size(), 0);
+            x[0] = 1;
+            for (unsigned j = 0; j < mean.size(); j++) {
+                x[1 + j] = (features[j] - mean[j]) / scale[j];
+            }
+            std::map<std::string, unsigned>::const_iterator o = opIndex.find(op);
+            if (o != opIndex.end()) {
+                x[1 + mean.size() + o->second] = 1;
+            }
+            return x;
+        }
+
+    private:
+        Vector mean;
+        Vector scale;
+        std::map<std::string, unsigned> opIndex;
+};
+
+// Ridge regression of y on the rows of X
+Vector fitLinear(const Matrix &X, const Vector &y) {
+    unsigned d = X[0].size();
+    Matrix A(d, Vector(d, 0));
+    Vector b(d, 0);
+    for (unsigned i = 0; i < X.size(); i++) {
+        for (unsigned r = 0; r < d; r++) {
+            b[r] += X[i][r] * y[i];
+            for (unsigned c = 0; c < d; c++) {
+                A[r][c] += X[i][r] * X[i][c];
+            }
+        }
+    }
+    for (unsigned r = 0; r < d; r++) {
+        A[r][r] += lambda;
+    }
+    return solve(A, b);
+}
+
+// Ridge logistic regression of y (0 or 1) on the rows of X by Newton's
+// method (iteratively reweighted least squares)
+Vector fitLogistic(const Matrix &X, const Vector &y) {
+    unsigned d = X[0].size();
+    Vector w(d, 0);
+    for (int iter = 0; iter < 25; iter++) {
+        Matrix H(d, Vector(d, 0));
+        Vector g(d, 0);
+        for (unsigned i = 0; i < X.size(); i++) {
+            double p = sigmoid(dot(w, X[i]));
+            double weight = std::max(p * (1 - p), 1e-9);
+            for (unsigned r = 0; r < d; r++) {
+                g[r] += X[i][r] * (y[i] - p);
+                for (unsigned c = 0; c < d; c++) {
+                    H[r][c] += weight * X[i][r] * X[i][c];
+                }
+            }
+        }
+        double change = 0;
+        for (unsigned r = 0; r < d; r++) {
+            H[r][r] += lambda;
+            g[r] -= lambda * w[r];
+        }
+        Vector step = solve(H, g);
+        for (unsigned r = 0; r < d; r++) {
+            w[r] += step[r];
+            change = std::max(change, fabs(step[r]));
+        }
+        if (change < 1e-8) {
+            break;
+        }
+    }
+    return w;
+}
+
+// Entropy in bits of an outcome with probability p
+double entropy(double p) {
+    if (p <= 0 || p >= 1) {
+        return 0;
+    }
+    return -(p * log(p) + (1 - p) * log(1 - p)) / log(2.0);
+}
+
+struct Planned {
+    std::string op;
+    std::string site;
+    double pKill;
+    double seconds;
+    double value; // bits per second
+
+    bool operator<(const Planned &other) const {
+        return value > other.value;
+    }
+};
+
+void schedule() {
+    std::vector<Sample> history = readHistory();
+    if (history.empty()) {
+        fprintf(stderr, "Error: -history has no results to learn from\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Inputs inputs(history);
+    Matrix X;
+    Vector killed, logSeconds;
+    for (unsigned i = 0; i < history.size(); i++) {
+        X.push_back(inputs.get(history[i].op, history[i].features));
+        killed.push_back(history[i].killed ? 1 : 0);
+        logSeconds.push_back(log(std::max(history[i].seconds, 1e-3)));
+    }
+    Vector killModel = fitLogistic(X, killed);
+    Vector timeModel = fitLinear(X, logSeconds);
+
+    std::vector<Planned> plan;
+    for (unsigned o = 0; o < operators.size(); o++) {
+        if (!inputs.knowsOperator(operators[o])) {
+            fprintf(stderr, "Warning: operator %s is not in -history, predicting "
+                    "from the features only\n", operators[o].c_str());
+        }
+        for (unsigned s = 0; s < sites.size(); s++) {
+            Vector x = inputs.get(operators[o], siteFeatures[sites[s]]);
+            Planned p;
+            p.op = operators[o];
+            p.site = sites[s];
+            p.pKill = sigmoid(dot(killModel, x));
+            p.seconds = exp(dot(timeModel, x));
+            p.value = entropy(p.pKill) / p.seconds;
+            plan.push_back(p);
+        }
+    }
+    std::stable_sort(plan.begin(), plan.end());
+
+    double spent = 0;
+    for (unsigned i = 0; i < plan.size(); i++) {
+        if (budget != 0 && spent + plan[i].seconds > budget) {
+            fprintf(stderr, "%u of %lu mutants fit in the -budget\n", i, (unsigned long) plan.size());
+            break;
+        }
+        spent += plan[i].seconds;
+        printf("%s\t%s\t%.3f\t%.3g\t%.3g\n", plan[i].op.c_str(), plan[i].site.c_str(),
+               plan[i].pKill, plan[i].seconds, plan[i].value);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    parseCommandLine(argc, argv);
+    readFeatures();
+    if (recordMode) {
+        record();
+    }
+    else {
+        schedule();
+    }
+    return 0;
+}
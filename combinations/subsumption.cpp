@@ -0,0 +1,221 @@
+/**
+ * Author: Markus Kusano
+ *
+ * Dynamic mutant subsumption: finds the mutants of a finished campaign that
+ * can be dropped from the next one without missing a test that would fail.
+ *
+ *  subsumption -kills kills.txt [-graph graph.txt] [-killed-only] > minimal.txt
+ *
+ * -kills is the kill matrix, one line per mutant: the mutant (e.g. its -pos
+ * value, any text without white space) followed by the tests that kill it.
+ * A mutant without tests survived. Empty lines and lines starting with # are
+ * ignored.
+ *
+ * Mutant a subsumes mutant b if a is killed and every test killing a also
+ * kills b: running a is enough to know b would be killed. Mutants killed by
+ * the same tests are redundant with each other. The minimal set has one
+ * mutant (the first listed) of each group of killed mutants that no other
+ * mutant strictly subsumes, followed by the mutants that survived, which are
+ * still worth running. With -killed-only they are left out.
+ *
+ * The minimal set is written one mutant per line, in the order of the kill
+ * matrix. It can be passed to -only of combinations and hom_search to limit
+ * the next campaign to it.
+ *
+ * -graph writes the subsumption graph: "subsumes <a> <b>" for each edge of
+ * its transitive reduction and "same <a> <b>" for each mutant b redundant
+ * with the first mutant a of its group.
+ */
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ToolUtil.h"
+
+// Tests killing a mutant, one bit per test
+typedef std::vector<unsigned long long> TestSet;
+
+const char *killsFile; // -kills
+const char *graphFile; // -graph, NULL if not given
+bool killedOnly;       // -killed-only was passed
+
+std::vector<std::string> mutants;
+std::vector<TestSet> kills; // kills[i] of mutants[i]
+std::map<std::string, unsigned> tests;
+
+void parseCommandLine(int argc, char *argv[]) {
+    char **end = argv + argc;
+
+    killsFile = getCmdValue(argv, end, "-kills");
+    if (killsFile == NULL) {
+        fprintf(stderr, "Error: -kills must be specified\n");
+        exit(EXIT_FAILURE);
+    }
+
+    graphFile = NULL;
+    if (cmdOptionExists(argv, end, "-graph")) {
+        graphFile = getCmdValue(argv, end, "-graph");
+        if (graphFile == NULL) {
+            fprintf(stderr, "Error: -graph requires a value\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    killedOnly = cmdOptionExists(argv, end, "-killed-only");
+}
+
+void readKills() {
+    FILE *in = fopen(killsFile, "r");
+    if (in == NULL) {
+        perror("Error: unable to open -kills file");
+        exit(EXIT_FAILURE);
+    }
+
+    // Test numbers of each mutant, turned into sets once all tests are known
+    std::vector<std::vector<unsigned> > killers;
+    std::map<std::string, unsigned> seen;
+    std::string line;
+    char buf[4096];
+    while (fgets(buf, sizeof(buf), in) != NULL) {
+        line += buf;
+        if (line[line.size() - 1] != '\n' && !feof(in)) {
+            continue; // longer than buf
+        }
+        std::stringstream ss(line);
+        line.clear();
+        std::string mutant;
+        if (!(ss >> mutant) || mutant[0] == '#') {
+            continue;
+        }
+        if (seen.count(mutant) != 0) {
+            fprintf(stderr, "Warning: mutant %s is listed twice, using the first\n", mutant.c_str());
+            continue;
+        }
+        seen[mutant] = mutants.size();
+        mutants.push_back(mutant);
+        killers.push_back(std::vector<unsigned>());
+        std::string test;
+        while (ss >> test) {
+            std::map<std::string, unsigned>::iterator t = tests.find(test);
+            if (t == tests.end()) {
+                t = tests.insert(std::make_pair(test, (unsigned) tests.size())).first;
+            }
+            killers.back().push_back(t->second);
+        }
+    }
+    fclose(in);
+
+    unsigned words = (tests.size() + 63) / 64;
+    kills.assign(mutants.size(), TestSet(words, 0));
+    for (unsigned i = 0; i < mutants.size(); i++) {
+        for (unsigned j = 0; j < killers[i].size(); j++) {
+            kills[i][killers[i][j] / 64] |= 1ULL << (killers[i][j] % 64);
+        }
+    }
+}
+
+// Returns true if a is a strict subset of b
+bool strictSubset(const TestSet &a, const TestSet &b) {
+    bool equal = true;
+    for (unsigned i = 0; i < a.size(); i++) {
+        if ((a[i] & ~b[i]) != 0) {
+            return false;
+        }
+        equal = equal && a[i] == b[i];
+    }
+    return !equal;
+}
+
+bool isEmpty(const TestSet &s) {
+    for (unsigned i = 0; i < s.size(); i++) {
+        if (s[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    parseCommandLine(argc, argv);
+    readKills();
+
+    // Group the killed mutants with the same tests, first listed first
+    std::map<TestSet, unsigned> groupOf;
+    std::vector<std::vector<unsigned> > groups;
+    std::vector<unsigned> live;
+    for (unsigned i = 0; i < mutants.size(); i++) {
+        if (isEmpty(kills[i])) {
+            live.push_back(i);
+            continue;
+        }
+        std::map<TestSet, unsigned>::iterator g = groupOf.find(kills[i]);
+        if (g == groupOf.end()) {
+            g = groupOf.insert(std::make_pair(kills[i], (unsigned) groups.size())).first;
+            groups.push_back(std::vector<unsigned>());
+        }
+        groups[g->second].push_back(i);
+    }
+
+    // subsumes[a][b]: group a strictly subsumes group b
+    unsigned numGroups = groups.size();
+    std::vector<std::vector<bool> > subsumes(numGroups, std::vector<bool>(numGroups, false));
+    std::vector<unsigned> minimal;
+    for (unsigned b = 0; b < numGroups; b++) {
+        bool isMinimal = true;
+        for (unsigned a = 0; a < numGroups; a++) {
+            subsumes[a][b] = strictSubset(kills[groups[a][0]], kills[groups[b][0]]);
+            isMinimal = isMinimal && !subsumes[a][b];
+        }
+        if (isMinimal) {
+            minimal.push_back(groups[b][0]);
+        }
+    }
+
+    if (!killedOnly) {
+        minimal.insert(minimal.end(), live.begin(), live.end());
+    }
+    std::sort(minimal.begin(), minimal.end());
+    for (unsigned i = 0; i < minimal.size(); i++) {
+        printf("%s\n", mutants[minimal[i]].c_str());
+    }
+
+    if (graphFile != NULL) {
+        FILE *out = fopen(graphFile, "w");
+        if (out == NULL) {
+            perror("Error: unable to open -graph file");
+            exit(EXIT_FAILURE);
+        }
+        for (unsigned a = 0; a < numGroups; a++) {
+            for (unsigned j = 1; j < groups[a].size(); j++) {
+                fprintf(out, "same %s %s\n", mutants[groups[a][0]].c_str(),
+                        mutants[groups[a][j]].c_str());
+            }
+            for (unsigned b = 0; b < numGroups; b++) {
+                if (!subsumes[a][b]) {
+                    continue;
+                }
+                // Leave out the edges implied by a path through another group
+                bool direct = true;
+                for (unsigned c = 0; c < numGroups && direct; c++) {
+                    direct = !(subsumes[a][c] && subsumes[c][b]);
+                }
+                if (direct) {
+                    fprintf(out, "subsumes %s %s\n", mutants[groups[a][0]].c_str(),
+                            mutants[groups[b][0]].c_str());
+                }
+            }
+        }
+        fclose(out);
+    }
+
+    fprintf(stderr, "%lu mutants, %lu killed in %u groups, %lu minimal, %lu live\n",
+            (unsigned long) mutants.size(), (unsigned long) (mutants.size() - live.size()),
+            numGroups, (unsigned long) (minimal.size() - (killedOnly ? 0 : live.size())),
+            (unsigned long) live.size());
+    return 0;
+}
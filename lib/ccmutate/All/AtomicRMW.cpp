@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file AtomicRMW.cpp
+ * \author Markus Kusano
+ *
+ * The AtomicRMW operator (../AtomicRMW/AtomicRMW.cpp) built into the combined plugin, its
+ * options are prefixed with -AtomicRMW- (see README.md)
+ */
+#define MUTATE_PREFIX "AtomicRMW-"
+#include "../AtomicRMW/AtomicRMW.cpp"
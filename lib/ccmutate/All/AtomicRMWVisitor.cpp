@@ -0,0 +1,10 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file AtomicRMWVisitor.cpp
+ * \author Markus Kusano
+ *
+ * ../AtomicRMW/AtomicRMWVisitor.cpp built into the combined plugin (see README.md)
+ */
+#include "../AtomicRMW/AtomicRMWVisitor.cpp"
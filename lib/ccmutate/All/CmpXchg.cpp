@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file CmpXchg.cpp
+ * \author Markus Kusano
+ *
+ * The CmpXchg operator (../CompareExchange/CmpXchg.cpp) built into the combined plugin, its
+ * options are prefixed with -CmpXchg- (see README.md)
+ */
+#define MUTATE_PREFIX "CmpXchg-"
+#include "../CompareExchange/CmpXchg.cpp"
@@ -0,0 +1,10 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file CmpXchgVisitor.cpp
+ * \author Markus Kusano
+ *
+ * ../CompareExchange/CmpXchgVisitor.cpp built into the combined plugin (see README.md)
+ */
+#include "../CompareExchange/CmpXchgVisitor.cpp"
@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file CondWait.cpp
+ * \author Markus Kusano
+ *
+ * The CondWait operator (../CondWait/CondWait.cpp) built into the combined plugin, its
+ * options are prefixed with -CondWait- (see README.md)
+ */
+#define MUTATE_PREFIX "CondWait-"
+#include "../CondWait/CondWait.cpp"
@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file Fence.cpp
+ * \author Markus Kusano
+ *
+ * The Fence operator (../Fence/Fence.cpp) built into the combined plugin, its
+ * options are prefixed with -Fence- (see README.md)
+ */
+#define MUTATE_PREFIX "Fence-"
+#include "../Fence/Fence.cpp"
@@ -0,0 +1,10 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file FenceVisitor.cpp
+ * \author Markus Kusano
+ *
+ * ../Fence/FenceVisitor.cpp built into the combined plugin (see README.md)
+ */
+#include "../Fence/FenceVisitor.cpp"
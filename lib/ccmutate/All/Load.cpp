@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file Load.cpp
+ * \author Markus Kusano
+ *
+ * The Load operator (../Load/Load.cpp) built into the combined plugin, its
+ * options are prefixed with -Load- (see README.md)
+ */
+#define MUTATE_PREFIX "Load-"
+#include "../Load/Load.cpp"
@@ -0,0 +1,10 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file LoadVisitor.cpp
+ * \author Markus Kusano
+ *
+ * ../Load/LoadVisitor.cpp built into the combined plugin (see README.md)
+ */
+#include "../Load/LoadVisitor.cpp"
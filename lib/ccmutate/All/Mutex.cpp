@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file Mutex.cpp
+ * \author Markus Kusano
+ *
+ * The Mutex operator (../Mutex/Mutex.cpp) built into the combined plugin, its
+ * options are prefixed with -Mutex- (see README.md)
+ */
+#define MUTATE_PREFIX "Mutex-"
+#include "../Mutex/Mutex.cpp"
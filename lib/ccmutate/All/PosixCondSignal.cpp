@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file PosixCondSignal.cpp
+ * \author Markus Kusano
+ *
+ * The PosixCondSignal operator (../PosixCondSignal/PosixCondSignal.cpp) built into the combined plugin, its
+ * options are prefixed with -PosixCondSignal- (see README.md)
+ */
+#define MUTATE_PREFIX "PosixCondSignal-"
+#include "../PosixCondSignal/PosixCondSignal.cpp"
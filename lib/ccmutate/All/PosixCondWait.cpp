@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file PosixCondWait.cpp
+ * \author Markus Kusano
+ *
+ * The PosixCondWait operator (../PosixCondWait/PosixCondWait.cpp) built into the combined plugin, its
+ * options are prefixed with -PosixCondWait- (see README.md)
+ */
+#define MUTATE_PREFIX "PosixCondWait-"
+#include "../PosixCondWait/PosixCondWait.cpp"
@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file PosixJoin.cpp
+ * \author Markus Kusano
+ *
+ * The PosixJoin operator (../PosixJoin/PosixJoin.cpp) built into the combined plugin, its
+ * options are prefixed with -PosixJoin- (see README.md)
+ */
+#define MUTATE_PREFIX "PosixJoin-"
+#include "../PosixJoin/PosixJoin.cpp"
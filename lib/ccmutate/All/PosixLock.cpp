@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file PosixLock.cpp
+ * \author Markus Kusano
+ *
+ * The PosixLock operator (../PosixLock/PosixLock.cpp) built into the combined plugin, its
+ * options are prefixed with -PosixLock- (see README.md)
+ */
+#define MUTATE_PREFIX "PosixLock-"
+#include "../PosixLock/PosixLock.cpp"
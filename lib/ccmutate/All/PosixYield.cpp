@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file PosixYield.cpp
+ * \author Markus Kusano
+ *
+ * The PosixYield operator (../PosixYield/PosixYield.cpp) built into the combined plugin, its
+ * options are prefixed with -PosixYield- (see README.md)
+ */
+#define MUTATE_PREFIX "PosixYield-"
+#include "../PosixYield/PosixYield.cpp"
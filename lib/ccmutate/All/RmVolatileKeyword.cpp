@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file RmVolatileKeyword.cpp
+ * \author Markus Kusano
+ *
+ * The RmVolatileKeyword operator (../RmVolatileKeyword/RmVolatileKeyword.cpp) built into the combined plugin, its
+ * options are prefixed with -RmVolatileKeyword- (see README.md)
+ */
+#define MUTATE_PREFIX "RmVolatileKeyword-"
+#include "../RmVolatileKeyword/RmVolatileKeyword.cpp"
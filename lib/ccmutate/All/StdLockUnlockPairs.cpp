@@ -0,0 +1,10 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file StdLockUnlockPairs.cpp
+ * \author Markus Kusano
+ *
+ * ../Mutex/StdLockUnlockPairs.cpp built into the combined plugin (see README.md)
+ */
+#include "../Mutex/StdLockUnlockPairs.cpp"
@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file Store.cpp
+ * \author Markus Kusano
+ *
+ * The Store operator (../Store/Store.cpp) built into the combined plugin, its
+ * options are prefixed with -Store- (see README.md)
+ */
+#define MUTATE_PREFIX "Store-"
+#include "../Store/Store.cpp"
@@ -0,0 +1,10 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file StoreVisitor.cpp
+ * \author Markus Kusano
+ *
+ * ../Store/StoreVisitor.cpp built into the combined plugin (see README.md)
+ */
+#include "../Store/StoreVisitor.cpp"
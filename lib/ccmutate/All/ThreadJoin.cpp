@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ThreadJoin.cpp
+ * \author Markus Kusano
+ *
+ * The ThreadJoin operator (../ThreadJoin/ThreadJoin.cpp) built into the combined plugin, its
+ * options are prefixed with -ThreadJoin- (see README.md)
+ */
+#define MUTATE_PREFIX "ThreadJoin-"
+#include "../ThreadJoin/ThreadJoin.cpp"
@@ -0,0 +1,10 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file VolatileVisitor.cpp
+ * \author Markus Kusano
+ *
+ * ../RmVolatileKeyword/VolatileVisitor.cpp built into the combined plugin (see README.md)
+ */
+#include "../RmVolatileKeyword/VolatileVisitor.cpp"
@@ -0,0 +1,12 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file mutate_PosixSema.cpp
+ * \author Markus Kusano
+ *
+ * The PosixSema operator (../PosixSemaphore/mutate_PosixSema.cpp) built into the combined plugin, its
+ * options are prefixed with -PosixSema- (see README.md)
+ */
+#define MUTATE_PREFIX "PosixSema-"
+#include "../PosixSemaphore/mutate_PosixSema.cpp"
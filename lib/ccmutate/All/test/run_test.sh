@@ -0,0 +1,43 @@
+# Test script, requires that the following variables be present to the shell:
+#	$opt: the location of opt
+#	$llvmlibdir: the library directory of LLVM (where opt modules can be found)
+#	$llvmdis: locatino of llvm-dis (for human readable output bitcode files)
+# Run make prior to running this
+
+# These run tests but the output of the tool needs to be checked by a human
+
+testLibName="mutate_all.so"
+
+llvmlibdir="/home/markus/Repos/src/ext_mutate/install/lib"
+
+echo "BEGIN TEST: Every operator analyzing in one run (same counts as the single plugins)"
+opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -Mutex -PosixLock -Fence -Store -PosixYield <test.bc >/dev/null
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: The site catalog and alias analysis are built once for the run above"
+opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -Mutex -PosixLock -Fence -Store -PosixYield -debug-pass=Structure <test.bc 2>&1 >/dev/null | grep -i "site\|alias"
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: Remove the std::mutex pair and the fence in one run, out to out_01.bc"
+opt -basicaa -load "$llvmlibdir"/"$testLibName" -Mutex -Mutex-rm -Mutex-pos=0,0 -Fence -Fence-rm -Fence-pos=0 <test.bc >out_01.bc
+opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -Mutex -Fence <out_01.bc >/dev/null
+$llvmdis out_01.bc
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: Weaken the store and remove sched_yield() in one run, out to out_02.bc"
+opt -load "$llvmlibdir"/"$testLibName" -Store -Store-mod -Store-order=1 -Store-pos=0 -PosixYield -PosixYield-rm -PosixYield-pos=0 <test.bc >out_02.bc
+$llvmdis out_02.bc
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: Tools options are shared, -filter-func applies to every operator"
+opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -Mutex -Fence -filter-func=main <test.bc >/dev/null
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: Unprefixed operator option (should fail, unknown option -pos)"
+opt -load "$llvmlibdir"/"$testLibName" -Fence -rm -pos=0 <test.bc >/dev/null
+echo "END TEST"
@@ -0,0 +1,37 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <cstdio>
+
+// One std::mutex pair, one pthread pair, one fence, one release store and
+// one sched_yield() per call of worker(), enough for each operator chained in
+// run_test.sh to find a site
+
+std::mutex mut;
+pthread_mutex_t pmut = PTHREAD_MUTEX_INITIALIZER;
+std::atomic<int> flag(0);
+int counter = 0;
+
+void worker() {
+    mut.lock();
+    counter++;
+    mut.unlock();
+
+    pthread_mutex_lock(&pmut);
+    counter++;
+    pthread_mutex_unlock(&pmut);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    flag.store(1, std::memory_order_release);
+    sched_yield();
+}
+
+int main() {
+    std::thread t(worker);
+    worker();
+    t.join();
+    printf("counter == %d, flag == %d\n", counter, flag.load(std::memory_order_acquire));
+    return 0;
+}
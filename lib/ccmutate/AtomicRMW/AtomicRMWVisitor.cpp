@@ -7,6 +7,7 @@
  */
 
 #include "AtomicRMWVisitor.h"
+#include "../Tools/SourceScope.h"
 
 // Enable debugging output
 //#define MUT_DEBUG
@@ -36,3 +37,11 @@ AtomicRMWInst *AtomicRMWVisitor::getInst(unsigned index) const {
         return NULL;
     }
 }
+
+void AtomicRMWVisitor::merge(const AtomicRMWVisitor &other) {
+    atomicRMWInsts.insert(atomicRMWInsts.end(), other.atomicRMWInsts.begin(), other.atomicRMWInsts.end());
+}
+
+void AtomicRMWVisitor::filter(SourceScope &scope) {
+    removeOutOfScope(atomicRMWInsts, scope);
+}
@@ -9,6 +9,8 @@
 #include "llvm/Support/InstVisitor.h"
 #include <vector>
 
+class SourceScope;
+
 using namespace llvm;
 
 class AtomicRMWVisitor : public InstVisitor<AtomicRMWVisitor> {
@@ -16,6 +18,12 @@ class AtomicRMWVisitor : public InstVisitor<AtomicRMWVisitor> {
         // Visitor function
         void visitAtomicRMWInst(AtomicRMWInst &I);
 
+        // Append the instructions found by other (used by parallelVisit())
+        void merge(const AtomicRMWVisitor &other);
+
+        // Remove the instructions outside of scope (used by parallelVisit())
+        void filter(SourceScope &scope);
+
         // Data accessor functions
         unsigned getSize() const;
         // Returns NULL if index out-of-bounds
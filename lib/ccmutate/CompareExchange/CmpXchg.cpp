@@ -14,7 +14,10 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 #include "CmpXchgVisitor.h"
+#include "../Tools/ParallelVisit.h"
 #include "../Tools/FileInfo.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/OperatorOption.h"
 
 using namespace llvm;
 
@@ -22,33 +25,33 @@ using namespace llvm;
 //#define MUT_DEBUG
 
 
-static cl::list<unsigned> positions("pos", 
+static cl::list<unsigned> positions(MUTATE_OPT("pos"), 
     cl::desc("occurances to remove or modify"),
     cl::value_desc("comma separated list of unsigned ints"),
     cl::CommaSeparated);
 
 
-static cl::opt<bool> verbose("verbose", 
+static cl::opt<bool> verbose(MUTATE_OPT("verbose"), 
         cl::desc("enable verbose output\n"),
         cl::init(false));
 
 // To be used in the future to support non-atomic to atomic load mutation
-static cl::opt<bool> onlyAtomic("onlyatomic", 
+static cl::opt<bool> onlyAtomic(MUTATE_OPT("onlyatomic"), 
         cl::desc("only enumerate and mutate atomic loads"),
         cl::Hidden,
         cl::init(true));
 
-static cl::opt<bool> modMode("mod", 
+static cl::opt<bool> modMode(MUTATE_OPT("mod"), 
         cl::desc("change atomic ordering of load instruction, use -order to specify ordering"),
         cl::init(false));
 
-static cl::list<unsigned> orderings("order",
+static cl::list<unsigned> orderings(MUTATE_OPT("order"),
         cl::desc("atomic ordering values for each position found in -pos"),
         cl::value_desc("comma separated list of unsigned ints. 0 = monotonic, "
                        "1 = acquire, 2 = release, 3 = acquire release, 4 = sequentially consistent"),
         cl::CommaSeparated);
 
-static cl::opt<bool> scope("scope", 
+static cl::opt<bool> scope(MUTATE_OPT("scope"), 
         cl::desc("change synchronization scope from single-threaded to multi-threaded and vice-versa"),
         cl::init(false));
 
@@ -57,8 +60,19 @@ namespace {
 struct CmpXchg : public ModulePass {
     static char ID;
     CmpXchgVisitor cmpXchgInsts;
+    MutantVerifier verifier;
     CmpXchg() : ModulePass(ID) { }
 
+    // Only the ordering or scope of a cmpxchg changes
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+        if (!modMode && !scope) {
+            AU.setPreservesAll(); // only analyzing
+        }
+        else {
+            AU.setPreservesCFG();
+        }
+    }
+
 
     virtual bool runOnModule(Module &M) {
         bool modified; 
@@ -68,7 +82,7 @@ struct CmpXchg : public ModulePass {
 
         checkCommandLineArgs();
 
-        cmpXchgInsts.visit(M);
+        parallelVisit(M, cmpXchgInsts);
 
         if (modMode) {
             modifyInstructions();
@@ -79,6 +93,10 @@ struct CmpXchg : public ModulePass {
             modified = true;
         }
 
+        if (modified) {
+            verifier.check(M, "CmpXchg");
+        }
+
 #ifdef MUT_DEBUG
         errs() << "[DEBUG] exiting runOnModule\n";
 #endif
@@ -101,6 +119,7 @@ struct CmpXchg : public ModulePass {
             curIndex = positions[i];
             if (curIndex < cmpXchgInsts.getSize()) {
                 curInst = cmpXchgInsts.getInst(curIndex);
+                verifier.touch(curInst);
                 if (curInst->getSynchScope() == CrossThread)
                     curInst->setSynchScope(SingleThread);
                 else // SingleThread
@@ -121,6 +140,7 @@ struct CmpXchg : public ModulePass {
             if (curIndex < cmpXchgInsts.getSize()) {
                 AtomicOrdering aorder;
                 curInst = cmpXchgInsts.getInst(curIndex); // non null since position in-bounds
+                verifier.touch(curInst);
                 aorder = getOrdering(curIndex);
                 curInst->setOrdering(aorder);
             }
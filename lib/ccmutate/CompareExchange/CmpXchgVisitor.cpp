@@ -7,6 +7,7 @@
  */
 
 #include "CmpXchgVisitor.h"
+#include "../Tools/SourceScope.h"
 
 // Enable debugging output
 //#define MUT_DEBUG
@@ -36,3 +37,11 @@ AtomicCmpXchgInst *CmpXchgVisitor::getInst(unsigned index) const {
         return NULL;
     }
 }
+
+void CmpXchgVisitor::merge(const CmpXchgVisitor &other) {
+    cmpXchgInsts.insert(cmpXchgInsts.end(), other.cmpXchgInsts.begin(), other.cmpXchgInsts.end());
+}
+
+void CmpXchgVisitor::filter(SourceScope &scope) {
+    removeOutOfScope(cmpXchgInsts, scope);
+}
@@ -9,6 +9,8 @@
 #include "llvm/Support/InstVisitor.h"
 #include <vector>
 
+class SourceScope;
+
 using namespace llvm;
 
 class CmpXchgVisitor : public InstVisitor<CmpXchgVisitor> {
@@ -16,6 +18,12 @@ class CmpXchgVisitor : public InstVisitor<CmpXchgVisitor> {
         // Visitor function
         void visitAtomicCmpXchgInst(AtomicCmpXchgInst &I);
 
+        // Append the instructions found by other (used by parallelVisit())
+        void merge(const CmpXchgVisitor &other);
+
+        // Remove the instructions outside of scope (used by parallelVisit())
+        void filter(SourceScope &scope);
+
         // Data accessor functions
         unsigned getSize() const;
         // Returns NULL if index out-of-bounds
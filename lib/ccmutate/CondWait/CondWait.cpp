@@ -21,6 +21,9 @@
 #include "llvm/IRBuilder.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "../Tools/EnumerateCallInst.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/SiteCatalog.h"
+#include "../Tools/OperatorOption.h"
 
 #define MUT_DEBUG
 
@@ -39,7 +42,7 @@ using namespace llvm;
 
 /// Command line option: specify if we should remove occurrences specified with
 /// -pos. Defaults to false. \sa MutatePos
-static cl::opt<bool> rmMode("rm", 
+static cl::opt<bool> rmMode(MUTATE_OPT("rm"), 
 	cl::desc("remove occurrences specified by -pos"),
 	cl::init(false));
 
@@ -52,14 +55,14 @@ static cl::opt<bool> rmMode("rm",
 ///
 /// \sa MutatePos 
 /// \sa ModVal
-static cl::opt<bool> TimeMod("tmod", 
+static cl::opt<bool> TimeMod(MUTATE_OPT("tmod"), 
 	cl::desc("modify wait value of occurrences specified by -val"),
 	cl::init(false));
 
 /// Command line option: Comma separated list of positions to mutate. The list
 /// is zero indexted (the first position is zero). \sa rmMode.
 /// Note: -pos 0 -pos 3 is equivalent to -pos=0,3
-static cl::list<unsigned> MutatePos("pos",
+static cl::list<unsigned> MutatePos(MUTATE_OPT("pos"),
 	cl::desc("occurances to mutate"),
 	cl::value_desc("comma separated list of occurances to mutate"),
 	cl::CommaSeparated);
@@ -69,7 +72,7 @@ static cl::list<unsigned> MutatePos("pos",
 /// the value used for the 0th instruction specified by -pos. If this list is
 /// shorter than -pos then the last value in the list will be used for the
 /// remaining positions to modify.
-static cl::list<int> NsecModVal("nsecval",
+static cl::list<int> NsecModVal(MUTATE_OPT("nsecval"),
 	cl::desc("modify values"),
 	cl::value_desc("comma separated list of values to use"),
 	cl::CommaSeparated);
@@ -79,7 +82,7 @@ static cl::list<int> NsecModVal("nsecval",
 /// the value used for the 0th instruction specified by -pos. If this list is
 /// shorter than -pos then the last value in the list will be used for the
 /// remaining positions to modify.
-static cl::list<int> SecModVal("secval",
+static cl::list<int> SecModVal(MUTATE_OPT("secval"),
 	cl::desc("modify values"),
 	cl::value_desc("comma separated list of values to use"),
 	cl::CommaSeparated);
@@ -90,7 +93,7 @@ static cl::list<int> SecModVal("secval",
 /// code is inserted before the specified instruction. If this list is shorter
 /// than -pos then the last value in the list will be used for the remaining
 /// position to modify.
-static cl::list<unsigned> InsertPoint("inspt",
+static cl::list<unsigned> InsertPoint(MUTATE_OPT("inspt"),
 	cl::desc("relative point to insert mutation code"),
 	cl::value_desc("comma separated list of ints"),
 	cl::CommaSeparated);
@@ -103,28 +106,28 @@ static cl::list<unsigned> InsertPoint("inspt",
 /// to false. 
 ///
 /// \sa rmMode
-static cl::opt<bool> verbose("verbose",
+static cl::opt<bool> verbose(MUTATE_OPT("verbose"),
 	cl::desc("enable verbose output, displays filename/linenumber info"),
 	cl::init(false));
 
 /// Command line option: Tells the pass to switch calls specified with -pos
 /// from timedwait to wait. The converse (wait to timedwait) is not implemented
 /// yet.
-static cl::opt<bool> switchMode("switch",
+static cl::opt<bool> switchMode(MUTATE_OPT("switch"),
 	cl::desc("switch calls to timedwait to wait"),
 	cl::init(false));
 
 /// Command line option: The pass will mutate POSIX condition variable calls.
-static cl::opt<bool> posix("posix",
+static cl::opt<bool> posix(MUTATE_OPT("posix"),
 	cl::desc("mutates posix condition calls"),
 	cl::init(false));
 
-static cl::opt<bool> cpp11("cpp",
+static cl::opt<bool> cpp11(MUTATE_OPT("cpp"),
 	cl::desc("mutates C++11 condition calls"),
 	cl::init(false));
 
 /// Verifies command line arguments are valid
-void checkCommandLineArgs();
+static void checkCommandLineArgs();
 
 /// Obtains the next second mutate and nsec mutate values from the nsecval and
 /// secval lists.
@@ -133,14 +136,14 @@ void checkCommandLineArgs();
 /// \param timedWait the call to pthread_cond_timedwait
 /// \param pos next position being mutated
 /// \return Instruction of the next insertion point
-Instruction *getNextMutateVals(int &secVal, int &nsecVal, CallInst *timedWait, unsigned pos);
+static Instruction *getNextMutateVals(int &secVal, int &nsecVal, Instruction *timedWait, unsigned pos);
 
 /// Returns an instruction poitner that corresponds to the val'th instruction
 /// in the passed function. 
 /// \param F function to iterate over
 /// \param val number of times to move the inst_iterator
 /// \return Instruction* 
-Instruction *getInstFromFunction(Function *F, unsigned val);
+static Instruction *getInstFromFunction(Function *F, unsigned val);
 
 void checkCommandLineArgs() {
     if (!posix && !cpp11) {
@@ -273,6 +276,14 @@ struct CondWait : public ModulePass {
     CondWait() : ModulePass(ID) { }
 
     EnumerateCallInst eci;
+    MutantVerifier verifier;
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+	AU.addRequired<SiteCatalog>();
+	if (!rmMode && !TimeMod && !switchMode) {
+	    AU.setPreservesAll(); // only analyzing
+	}
+    }
 
     virtual bool runOnModule(Module &M) {
 	checkCommandLineArgs();
@@ -289,7 +300,7 @@ struct CondWait : public ModulePass {
             eci.searchCpp();
         }
 
-	eci.visit(M);
+	eci.enumerate(getAnalysis<SiteCatalog>(), M);
 
 	if (!rmMode && !TimeMod &&!switchMode) {
 	    modified = false; // implicit print mode
@@ -343,6 +354,7 @@ struct CondWait : public ModulePass {
                 Instruction *insPoint;
 
                 curInst = eci.getInstructionAt(posToMod, &isCallInst, &error);
+                verifier.touch(curInst); // NULL if out of bounds
                 if (error == -1) {
                     errs() << "Warning: position " << posToMod << " is out of bounds, skipping\n";
                     continue;
@@ -485,6 +497,7 @@ struct CondWait : public ModulePass {
                 Instruction *curInst;
 
                 curInst = eci.getInstructionAt(posToMod, &isCallInst, &error);
+                verifier.touch(curInst); // NULL if out of bounds
                 if (error == -1) {
                     errs() << "Warning: position " << posToMod << " is out of bounds, skipping\n";
                     continue;
@@ -588,6 +601,10 @@ struct CondWait : public ModulePass {
 	    } // end for
 	} // end else
 
+	if (modified) {
+	    verifier.touch(eci.getMutatedFunctions());
+	    verifier.check(M, "CondWait");
+	}
 	return modified;
     } // end func
 
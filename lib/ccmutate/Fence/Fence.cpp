@@ -12,37 +12,40 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 #include "FenceVisitor.h"
+#include "../Tools/ParallelVisit.h"
 #include "../Tools/FileInfo.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/OperatorOption.h"
 
 using namespace llvm;
 
 // Enable Debugging Output
 //#define MUT_DEBUG
 
-static cl::opt<bool> rmMode("rm", 
+static cl::opt<bool> rmMode(MUTATE_OPT("rm"), 
     cl::desc("remove occurances of fence instruction"),
     cl::init(false));
 
-static cl::opt<bool> modMode("mod", 
+static cl::opt<bool> modMode(MUTATE_OPT("mod"), 
     cl::desc("modify atomic ordering, specify type with -order"),
     cl::init(false));
 
-static cl::opt<bool> scopeMode("scope", 
+static cl::opt<bool> scopeMode(MUTATE_OPT("scope"), 
     cl::desc("toggle the scope of the fence from singlethreaded to multithreaded"),
     cl::init(false));
 
-static cl::list<unsigned> orderings("order",
+static cl::list<unsigned> orderings(MUTATE_OPT("order"),
     cl::desc("ordering values to use with mod, each corresponds to a position in -pos"),
     cl::value_desc("comma separated, 0 == acquire, 1 == release, 2 == acq_rel, 3 == seq_cst"),
     cl::CommaSeparated);
 
-static cl::list<unsigned> positions("pos", 
+static cl::list<unsigned> positions(MUTATE_OPT("pos"), 
     cl::desc("occurances to remove or modify"),
     cl::value_desc("comma separated list of unsigned ints"),
     cl::CommaSeparated);
 
 
-static cl::opt<bool> verbose("verbose", 
+static cl::opt<bool> verbose(MUTATE_OPT("verbose"), 
         cl::desc("enable verbose output\n"),
         cl::init(false));
 
@@ -50,8 +53,21 @@ namespace {
 struct Fence : public ModulePass {
     static char ID;
     FenceVisitor fenceInsts;
+    MutantVerifier verifier;
     Fence() : ModulePass(ID) { }
 
+    // Fences are changed in place or erased, they are never terminators so the
+    // CFG is never modified. Analyses such as the DominatorTree stay valid for
+    // later passes
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+        if (!rmMode && !modMode && !scopeMode) {
+            AU.setPreservesAll(); // only analyzing
+        }
+        else {
+            AU.setPreservesCFG();
+        }
+    }
+
 
     virtual bool runOnModule(Module &M) {
         bool modified; 
@@ -61,7 +77,7 @@ struct Fence : public ModulePass {
 
         checkCommandLineArgs();
 
-        fenceInsts.visit(M);
+        parallelVisit(M, fenceInsts);
 
         if (rmMode) {
 #ifdef MUT_DEBUG
@@ -79,6 +95,10 @@ struct Fence : public ModulePass {
             modified = true;
         }
 
+        if (modified) {
+            verifier.check(M, "Fence");
+        }
+
 #ifdef MUT_DEBUG
         errs() << "[DEBUG] exiting runOnModule\n";
 #endif
@@ -98,6 +118,7 @@ struct Fence : public ModulePass {
             }
 
             curInst = fenceInsts.getInst(curIndex); // non NULL since position is in bounds
+            verifier.touch(curInst);
 
             if (curInst->getSynchScope() == SingleThread) {
                 curInst->setSynchScope(CrossThread);
@@ -120,6 +141,7 @@ struct Fence : public ModulePass {
             }
 
             curInst = fenceInsts.getInst(curIndex); // non NULL since position is in bounds
+            verifier.touch(curInst);
             curInst->eraseFromParent();
         }
     }
@@ -137,6 +159,7 @@ struct Fence : public ModulePass {
             }
 
             curInst = fenceInsts.getInst(curIndex); // non NULL since position is in bounds
+            verifier.touch(curInst);
 
             aorder = getOrdering(curIndex);
 
@@ -6,6 +6,7 @@
  * \date 2013-06-02
  */
 #include "FenceVisitor.h"
+#include "../Tools/SourceScope.h"
 
 // Enable debugging output
 //#define MUT_DEBUG
@@ -35,3 +36,11 @@ FenceInst* FenceVisitor::getInst(unsigned index) const {
         return NULL;
     }
 }
+
+void FenceVisitor::merge(const FenceVisitor &other) {
+    fenceInsts_m.insert(fenceInsts_m.end(), other.fenceInsts_m.begin(), other.fenceInsts_m.end());
+}
+
+void FenceVisitor::filter(SourceScope &scope) {
+    removeOutOfScope(fenceInsts_m, scope);
+}
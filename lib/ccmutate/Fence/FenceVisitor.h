@@ -8,6 +8,8 @@
 #include "llvm/Support/InstVisitor.h"
 #include <vector>
 
+class SourceScope;
+
 using namespace llvm;
 
 class FenceVisitor : public InstVisitor<FenceVisitor> {
@@ -15,6 +17,12 @@ class FenceVisitor : public InstVisitor<FenceVisitor> {
         // Visitor function
         void visitFenceInst(FenceInst &I);
 
+        // Append the instructions found by other (used by parallelVisit())
+        void merge(const FenceVisitor &other);
+
+        // Remove the instructions outside of scope (used by parallelVisit())
+        void filter(SourceScope &scope);
+
         // Data accessor functions
         unsigned getSize() const;
         // Returns NULL if index out-of-bounds
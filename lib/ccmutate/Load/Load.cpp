@@ -13,7 +13,10 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 #include "LoadVisitor.h"
+#include "../Tools/ParallelVisit.h"
 #include "../Tools/FileInfo.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/OperatorOption.h"
 
 using namespace llvm;
 
@@ -21,37 +24,37 @@ using namespace llvm;
 //#define MUT_DEBUG
 
 
-static cl::list<unsigned> positions("pos", 
+static cl::list<unsigned> positions(MUTATE_OPT("pos"), 
     cl::desc("occurances to remove or modify"),
     cl::value_desc("comma separated list of unsigned ints"),
     cl::CommaSeparated);
 
 
-static cl::opt<bool> verbose("verbose", 
+static cl::opt<bool> verbose(MUTATE_OPT("verbose"), 
         cl::desc("enable verbose output\n"),
         cl::init(false));
 
 // To be used in the future to support non-atomic to atomic load mutation
-static cl::opt<bool> onlyAtomic("onlyatomic", 
+static cl::opt<bool> onlyAtomic(MUTATE_OPT("onlyatomic"), 
         cl::desc("only enumerate and mutate atomic loads"),
         cl::Hidden,
         cl::init(true));
 
-static cl::opt<bool> toggle("toggle", 
+static cl::opt<bool> toggle(MUTATE_OPT("toggle"), 
         cl::desc("switch non-atomic load to atomic and vice versa"),
         cl::init(false));
 
-static cl::opt<bool> modMode("mod", 
+static cl::opt<bool> modMode(MUTATE_OPT("mod"), 
         cl::desc("change atomic ordering of load instruction, use -order to specify ordering"),
         cl::init(false));
 
-static cl::list<unsigned> orderings("order",
+static cl::list<unsigned> orderings(MUTATE_OPT("order"),
         cl::desc("atomic ordering values for each position found in -pos"),
         cl::value_desc("comma separated list of unsigned ints. 0 = unordered, 1 = monotonic, "
                        "2 = acquire, 3 = sequentially consistent"),
         cl::CommaSeparated);
 
-static cl::opt<bool> scope("scope", 
+static cl::opt<bool> scope(MUTATE_OPT("scope"), 
         cl::desc("change synchronization scope from single-threaded to multi-threaded and vice-versa"),
         cl::init(false));
 
@@ -60,8 +63,19 @@ namespace {
 struct Load : public ModulePass {
     static char ID;
     LoadVisitor loadInsts;
+    MutantVerifier verifier;
     Load() : ModulePass(ID) { }
 
+    // Only the ordering, scope or volatile flag of a load changes
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+        if (!toggle && !modMode && !scope) {
+            AU.setPreservesAll(); // only analyzing
+        }
+        else {
+            AU.setPreservesCFG();
+        }
+    }
+
 
     virtual bool runOnModule(Module &M) {
         bool modified; 
@@ -75,7 +89,7 @@ struct Load : public ModulePass {
             loadInsts.setOnlyAtomic(true);
         } // default only atomic is false
 
-        loadInsts.visit(M);
+        parallelVisit(M, loadInsts);
 
         if (toggle) {
             toggleInstructions();
@@ -90,6 +104,10 @@ struct Load : public ModulePass {
             modified = true;
         }
 
+        if (modified) {
+            verifier.check(M, "Load");
+        }
+
 #ifdef MUT_DEBUG
         errs() << "[DEBUG] exiting runOnModule\n";
 #endif
@@ -112,6 +130,7 @@ struct Load : public ModulePass {
             curIndex = positions[i];
             if (curIndex < loadInsts.getSize()) {
                 curInst = loadInsts.getInst(curIndex);
+                verifier.touch(curInst);
                 if (curInst->isAtomic()) {
                     curInst->setOrdering(NotAtomic);
                 }
@@ -134,6 +153,7 @@ struct Load : public ModulePass {
             curIndex = positions[i];
             if (curIndex < loadInsts.getSize()) {
                 curInst = loadInsts.getInst(curIndex);
+                verifier.touch(curInst);
                 if (curInst->getSynchScope() == CrossThread)
                     curInst->setSynchScope(SingleThread);
                 else // SingleThread
@@ -154,6 +174,7 @@ struct Load : public ModulePass {
             if (curIndex < loadInsts.getSize()) {
                 AtomicOrdering aorder;
                 curInst = loadInsts.getInst(curIndex); // non null since position in-bounds
+                verifier.touch(curInst);
                 aorder = getOrdering(curIndex);
                 curInst->setOrdering(aorder);
             }
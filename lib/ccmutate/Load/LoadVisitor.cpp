@@ -6,6 +6,7 @@
  * \date 2013-06-02
  */
 #include "LoadVisitor.h"
+#include "../Tools/SourceScope.h"
 
 // Enable debugging output
 //#define MUT_DEBUG
@@ -49,3 +50,11 @@ LoadInst *LoadVisitor::getInst(unsigned index) const {
         return NULL;
     }
 }
+
+void LoadVisitor::merge(const LoadVisitor &other) {
+    loadInsts.insert(loadInsts.end(), other.loadInsts.begin(), other.loadInsts.end());
+}
+
+void LoadVisitor::filter(SourceScope &scope) {
+    removeOutOfScope(loadInsts, scope);
+}
@@ -8,6 +8,8 @@
 #include "llvm/Support/InstVisitor.h"
 #include <vector>
 
+class SourceScope;
+
 using namespace llvm;
 
 class LoadVisitor : public InstVisitor<LoadVisitor> {
@@ -16,6 +18,12 @@ class LoadVisitor : public InstVisitor<LoadVisitor> {
         // Visitor function
         void visitLoadInst(LoadInst &I);
 
+        // Append the instructions found by other (used by parallelVisit())
+        void merge(const LoadVisitor &other);
+
+        // Remove the instructions outside of scope (used by parallelVisit())
+        void filter(SourceScope &scope);
+
         // Data accessor functions
         unsigned getSize() const;
         // Returns NULL if index out-of-bounds
@@ -10,25 +10,39 @@
  * for different combiations of lock-unlock calls being either CallInsts or
  * InvokeInsts.
  *
- * The first number specified with pos is the data structure, the second if the
- * index in that data structure:
+ * The first number specified with pos is the kind of pair, the second is the
+ * index among the pairs of that kind (see PairTable::PairKind):
  *  0: CallCallPairs
  *  1: CallInvokePairs
  *  2: InvokeCallPairs
  *  3: InvokeInvokePairs
+ *
+ * With -program the index among the pairs of a kind is global over all the
+ * files of the program (see ProgramSites.h).
  */
 #include "llvm/Pass.h"
+#include "llvm/PassManager.h"
+#include "llvm/DataLayout.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/Passes.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "../Tools/RemoveInst.h"
 #include "../Tools/ItaniumDemangle.h"
+#include "../Tools/ProgramSites.h"
+#include "../Tools/SiteCatalog.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/LegalOffsets.h"
+#include "../Tools/PairConflicts.h"
+#include "../Tools/ThreadContext.h"
+#include "../Tools/OperatorOption.h"
 
 #include "llvm/Support/InstIterator.h"
 
-#include "LockUnlockPairs.h"
+#include "StdLockUnlockPairs.h"
 
 // Enable debugging messages
 //#define MUT_DEBUG
@@ -40,18 +54,18 @@ using namespace llvm;
 /// Defaults to false
 ///
 /// \sa rmMode
-static cl::opt<bool> verbose("verbose",
+static cl::opt<bool> verbose(MUTATE_OPT("verbose"),
 	cl::desc("enable verbose output, displays filename/linenumber info"),
 	cl::init(false));
 
 /// Command line option: the pass will remove pairs specified by -pos
-static cl::opt<bool> rmMode("rm",
+static cl::opt<bool> rmMode(MUTATE_OPT("rm"),
 	cl::desc("enable remove mode, remove lock unlock pair specified by pos\n"),
 	cl::init(false));
 
 /// Command line option: the pass will swap pairs specified by -pos. This
 /// requires atleast 4 values to be speciied in -pos
-static cl::opt<bool> swapMode("swap",
+static cl::opt<bool> swapMode(MUTATE_OPT("swap"),
 	cl::desc("enable swap mode, swap lock unlock pairs specified by pos\n"),
 	cl::init(false));
 
@@ -60,7 +74,7 @@ static cl::opt<bool> swapMode("swap",
 /// the first one is the function index and the second is the pair. For example
 /// -pos=1,2 -pos=0,7 will specify function 1 pair 2 and function 0 pair 7 to
 /// be mutated. This is equivalent to -pos=1,2,0,7.
-static cl::list<unsigned> MutatePos("pos",
+static cl::list<unsigned> MutatePos(MUTATE_OPT("pos"),
 	cl::desc("occurances to mutate"),
 	cl::value_desc("comma separated list of occurances to mutate"),
 	cl::CommaSeparated);
@@ -68,7 +82,7 @@ static cl::list<unsigned> MutatePos("pos",
 /// Command line option: enables shift mode. This allows -lockdir and
 /// -unlockdir to be used in conjunction with -pos to shift pairs arbitrary
 /// amounts.
-static cl::opt<bool> shiftMode("shift",
+static cl::opt<bool> shiftMode(MUTATE_OPT("shift"),
 	cl::desc("enable shift mode, shift lock and unlock calls"),
 	cl::init(false));
 
@@ -78,7 +92,7 @@ static cl::opt<bool> shiftMode("shift",
 /// Each index in this list corresponds to a pair specified by -pos. If no
 /// value is specified for a pair (ie this list is shorter than -pos) then 0 is
 /// used.
-static cl::list<int> LockDir("lockdir",
+static cl::list<int> LockDir(MUTATE_OPT("lockdir"),
 	cl::desc("direction to shift lock call"),
 	cl::value_desc("comma separated list of directions for each mutation position"),
 	cl::CommaSeparated);
@@ -89,7 +103,7 @@ static cl::list<int> LockDir("lockdir",
 /// Each index in this list corresponds to a pair specified by -pos. If no
 /// value is specified for a pair (ie this list is shorter than -pos) then 0 is
 /// used.
-static cl::list<int> UnlockDir("unlockdir",
+static cl::list<int> UnlockDir(MUTATE_OPT("unlockdir"),
 	cl::desc("direction to shift unlock call"),
 	cl::value_desc("comma separated list of directions for each mutation position"),
 	cl::CommaSeparated);
@@ -100,7 +114,7 @@ static cl::list<int> UnlockDir("unlockdir",
 /// relative to the lock call in which the additional unlock and lock cal
 /// should be inserted. -splitpos=3,7 inserts a call to unlock 3 instructions
 /// down and a call to lock 7 instructions down.
-static cl::list<unsigned> SplitPos("splitpos",
+static cl::list<unsigned> SplitPos(MUTATE_OPT("splitpos"),
 	cl::desc("relative position to insert unlock and lock call to split a pair"),
 	cl::value_desc("comma separated list of pairs for each mutation position"),
 	cl::CommaSeparated);
@@ -108,26 +122,110 @@ static cl::list<unsigned> SplitPos("splitpos",
 /// Command line option: used to specify that the pass should split a
 /// lock-unlock pair. Pairs are specified with -pos and the split points are
 /// specified with -splitpos
-static cl::opt<bool> splitMode("split",
+static cl::opt<bool> splitMode(MUTATE_OPT("split"),
 	cl::desc("enable split mode, split a lock and unlock pair"),
 	cl::init(false));
 
+/// Command line option: bitcode files making up the whole program, in link
+/// order. When given, -analyze reports the pairs of the whole program and the
+/// second number of a -pos is a global index over all the files. Positions in
+/// other files are ignored so only the file owning a pair is changed.
+static cl::list<std::string> ProgramFiles(MUTATE_OPT("program"),
+	cl::desc("bitcode files of the whole program, numbers pairs across all of them"),
+	cl::value_desc("comma separated list of bitcode files"),
+	cl::CommaSeparated);
+
+/// Command line option: the entry in -program the module being mutated was
+/// read from. Defaults to the module identifier, which is the input filename
+/// unless the module is read from stdin.
+static cl::opt<std::string> ProgramSelf(MUTATE_OPT("program-self"),
+	cl::desc("file in -program being mutated (default: the input filename)"),
+	cl::init(""));
+
+/// Command line option: with -analyze, list the -lockdir, -unlockdir and
+/// -splitpos values of each pair that produce a valid mutant different from
+/// the other listed values (see LegalOffsets.h)
+static cl::opt<bool> offsetsMode(MUTATE_OPT("offsets"),
+	cl::desc("list the legal shift and split offsets of each pair"),
+	cl::init(false));
+
+/// Command line option: with -analyze, list the pairs of each kind that
+/// cannot be mutated in the same mutant (see PairConflicts.h). The output is
+/// read by `combinations -g`.
+static cl::opt<bool> conflictsMode(MUTATE_OPT("conflicts"),
+	cl::desc("list the conflicting pairs of each kind"),
+	cl::init(false));
+
+/// Command line option: with -analyze, list the features of each pair used to
+/// predict how likely its mutants are killed and how long they take to test.
+/// The output is read by `prioritize -features`.
+static cl::opt<bool> featuresMode(MUTATE_OPT("features"),
+	cl::desc("list the features of each pair for mutant prioritization"),
+	cl::init(false));
 
 namespace {
-struct StdMutex : public ModulePass {
-    enum LockUnlockType {
-        CallCall,
-        CallInvoke,
-        InvokeCall,
-        InvokeInvoke,
-        TypeError
-    };
+/// Features of a pair printed with -features
+struct PairFeatures {
+    int dist;                  // instructions from the lock to the unlock
+    unsigned funcSize;         // instructions in the function
+    unsigned loopDepth;        // loops around the lock
+    ThreadContextKind context; // of the lock (see ThreadContext.h)
+};
+
+/// Counts the pairs of each kind of another file of the program. It runs in
+/// its own PassManager so the file gets its own AliasAnalysis (-basicaa, the
+/// one required of the pass with -program) instead of the one of the module
+/// being mutated.
+struct CountProgramPairs : public ModulePass {
+    static char ID;
 
+    unsigned *counts;
+
+    CountProgramPairs(unsigned *counts) : ModulePass(ID), counts(counts) { }
+
+    virtual const char *getPassName() const {
+        return "Count the Mutex pairs of a file of the program";
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+        AU.addRequired<AliasAnalysis>();
+        AU.setPreservesAll();
+    }
+
+    virtual bool runOnModule(Module &M) {
+        StdLockUnlockPairs pairs;
+        pairs.enumerate(M, getAnalysis<AliasAnalysis>());
+        for (unsigned k = 0; k < PairTable::NumKinds; k++) {
+            counts[k] = pairs.getPairs().getNumOfKind(k);
+        }
+        return false;
+    }
+};
+
+struct StdMutex : public ModulePass {
     static char ID;
 
-    StdMutex() : ModulePass(ID) { }
+    StdMutex() : ModulePass(ID), curModule(NULL) { }
+
+    StdLockUnlockPairs lockPairs;
+
+    // Global numbering of the pairs when -program is used
+    ProgramSites program;
 
-    LockUnlockPairs lockPairs;
+    // Module the pass is running on, used by countPairs()
+    Module *curModule;
+
+    // Checks the mutant before it is written
+    MutantVerifier verifier;
+
+    // Legal offsets of each pair in the PairTable when -offsets is used
+    std::vector<LegalOffsets> offsets;
+
+    // Conflicts between the pairs of each kind when -conflicts is used
+    std::vector<PairConflict> conflicts[PairTable::NumKinds];
+
+    // Features of each pair in the PairTable when -features is used
+    std::vector<PairFeatures> features;
 
     // Sets of instructions to mutate
     SmallPtrSet<CallInst *, 64> mutateCalls;
@@ -135,7 +233,20 @@ struct StdMutex : public ModulePass {
 
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
 	AU.addRequired<AliasAnalysis>();
-	AU.addPreserved<AliasAnalysis>();
+	AU.addRequired<SiteCatalog>();
+	if (offsetsMode) {
+	    AU.addRequired<DominatorTree>();
+	}
+	if (featuresMode) {
+	    AU.addRequired<LoopInfo>();
+	}
+	if (!rmMode && !swapMode && !shiftMode && !splitMode) {
+	    // Only analyzing, later passes can reuse everything
+	    AU.setPreservesAll();
+	}
+	else {
+	    AU.addPreserved<AliasAnalysis>();
+	}
     }
 
     virtual bool runOnModule(Module &M) {
@@ -145,88 +256,67 @@ struct StdMutex : public ModulePass {
 
 	checkCommandLineArgs();
 
-	lockPairs.enumerate(M, AA);
+	lockPairs.enumerate(getAnalysis<SiteCatalog>(), AA);
+
+        if (ProgramFiles.size() != 0) {
+            if (!usesBasicAA()) {
+                errs() << "Error: -program requires -basicaa, the other files "
+                       << "are counted with it\n";
+                exit(EXIT_FAILURE);
+            }
+            curModule = &M;
+            std::vector<std::string> files(ProgramFiles.begin(), ProgramFiles.end());
+            std::string self;
+            self = ProgramSelf;
+            if (self.empty()) {
+                self = M.getModuleIdentifier();
+            }
+            program.build(files, M, self, PairTable::NumKinds, &countPairs, this);
+        }
+
+        if (offsetsMode) {
+            findOffsets();
+        }
+
+        if (featuresMode) {
+            findFeatures(M);
+        }
+
+        if (conflictsMode) {
+            ProgramOrder &PO = getAnalysis<SiteCatalog>().getProgramOrder();
+            for (unsigned kind = 0; kind < PairTable::NumKinds; kind++) {
+                conflicts[kind].clear();
+                findPairConflicts(lockPairs.getPairs(), kind, PO, conflicts[kind]);
+            }
+        }
 
 	if (rmMode) {
 #ifdef MUT_DEBUG
 	    errs() << "DEBUG: In rmMode\n";
 #endif
-	    //LockUnlockPairs::lockUnlockPair *curPair;
+	    const PairTable &pairs = lockPairs.getPairs();
 	    for (unsigned i = 0; i < MutatePos.size(); i += 2) {
-                unsigned pos1, pos2;
-                pos1 = MutatePos[i];
-                pos2 = MutatePos[i+1];
-                if (pos1 == 0) {
-                    LockUnlockPairs::CallCallLockPair *curCallCallPair;
-                    curCallCallPair = lockPairs.getCallCallPair(pos2);
-                    if (curCallCallPair == NULL) {
-                        posOutOfBoundsWarning(pos1, pos2);
-                    }
-                    else {
-#ifdef MUT_DEBUG
-                        errs() << "DEBUG: adding to remove: " << *(curCallCallPair->lockCall) << '\n';
-                        errs() << "DEBUG: adding to remove: " << *(curCallCallPair->unlockCall) << '\n';
-#endif
-                        mutateCalls.insert(curCallCallPair->lockCall);
-                        mutateCalls.insert(curCallCallPair->unlockCall);
-                    }
+                int pair;
+                pair = getPairIndex(MutatePos[i], MutatePos[i+1]);
+                if (pair < 0) {
+                    continue;
                 }
-                else if (pos1 == 1) {
-                    // TODO: No test case for Call-Invoke pair found
+                touchPair(pair);
 #ifdef MUT_DEBUG
-                    errs() << "DEBUG: removing CallInvoke pair (found test case)\n";
+                errs() << "DEBUG: adding to remove: " << *(pairs.getLock(pair)) << '\n';
+                errs() << "DEBUG: adding to remove: " << *(pairs.getUnlock(pair)) << '\n';
 #endif
-                    LockUnlockPairs::CallInvokeLockPair *curCallInvokePair;
-                    curCallInvokePair = lockPairs.getCallInvokePair(pos2);
-                    if (curCallInvokePair == NULL) {
-                        posOutOfBoundsWarning(pos1, pos2);
-                    }
-                    else {
-#ifdef MUT_DEBUG
-                        errs() << "DEBUG: adding to remove: " << *(curCallInvokePair->lockCall) << '\n';
-                        errs() << "DEBUG: adding to remove: " << *(curCallInvokePair->unlockInvoke) << '\n';
-#endif
-                        mutateCalls.insert(curCallInvokePair->lockCall);
-                        mutateInvokes.insert(curCallInvokePair->unlockInvoke);
-                    }
+                if (pairs.lockIsCall(pair)) {
+                    mutateCalls.insert(cast<CallInst>(pairs.getLock(pair)));
                 }
-                else if (pos1 == 2) {
-                    LockUnlockPairs::InvokeCallLockPair *curInvokeCallPair;
-                    curInvokeCallPair = lockPairs.getInvokeCallPair(pos2);
-                    if (curInvokeCallPair == NULL) {
-                        posOutOfBoundsWarning(pos1, pos2);
-                    }
-                    else {
-#ifdef MUT_DEBUG
-                        errs() << "DEBUG: adding to remove: " << *(curInvokeCallPair->lockInvoke) << '\n';
-                        errs() << "DEBUG: adding to remove: " << *(curInvokeCallPair->unlockCall) << '\n';
-#endif
-                        mutateInvokes.insert(curInvokeCallPair->lockInvoke);
-                        mutateCalls.insert(curInvokeCallPair->unlockCall);
-                    }
-
+                else {
+                    mutateInvokes.insert(cast<InvokeInst>(pairs.getLock(pair)));
                 }
-                else if (pos1 == 3){
-                    // TODO: No test case for Invoke-Invoke pair found
-#ifdef MUT_DEBUG
-                    errs() << "DEBUG: removing InvokeInvoke pair (found test case)\n";
-#endif
-                    LockUnlockPairs::InvokeInvokeLockPair *curInvokeInvokePair;
-                    curInvokeInvokePair = lockPairs.getInvokeInvokePair(pos2);
-                    if (curInvokeInvokePair == NULL) {
-                        posOutOfBoundsWarning(pos1, pos2);
-                    }
-                    else {
-#ifdef MUT_DEBUG
-                        errs() << "DEBUG: adding to remove: " << *(curInvokeInvokePair->lockInvoke) << '\n';
-                        errs() << "DEBUG: adding to remove: " << *(curInvokeInvokePair->unlockInvoke) << '\n';
-#endif
-                        mutateInvokes.insert(curInvokeInvokePair->lockInvoke);
-                        mutateInvokes.insert(curInvokeInvokePair->unlockInvoke);
-                    }
+                if (pairs.unlockIsCall(pair)) {
+                    mutateCalls.insert(cast<CallInst>(pairs.getUnlock(pair)));
                 }
                 else {
-                    posOutOfBoundsWarning(pos1, pos2);
+                    mutateInvokes.insert(cast<InvokeInst>(pairs.getUnlock(pair)));
                 }
             } // end for
 
@@ -256,90 +346,42 @@ struct StdMutex : public ModulePass {
         }
         else if (swapMode) {
             errs() << "DEBUG: in swap mode\n";
+	    const PairTable &pairs = lockPairs.getPairs();
 	    for (unsigned i = 0; i < MutatePos.size(); i += 4) {
-                // Pairs for each possible pair of pairs to swap. Should have
-                // probably introduced some kind of generic interface in
-                // LockUnlockPairs because this is getting messy.
-                //LockUnlockPairs::CallCallLockPair *curCallCallPair1 = NULL;
-                //LockUnlockPairs::CallInvokeLockPair *curCallInvokePair1 = NULL;
-                //LockUnlockPairs::InvokeCallLockPair *curInvokeCallPair1 = NULL;
-                //LockUnlockPairs::CallInvokeLockPair *curCallInvokePair1 = NULL;
-
-                //LockUnlockPairs::CallCallLockPair *curCallCallPair2 = NULL;
-                //LockUnlockPairs::CallInvokeLockPair *curCallInvokePair2 = NULL;
-                //LockUnlockPairs::InvokeCallLockPair *curInvokeCallPair2 = NULL;
-                //LockUnlockPairs::CallInvokeLockPair *curCallInvokePair2 = NULL;
-                // Or we can just make it generic here
-
-                void *pair1;
-                void *pair2;
-                LockUnlockType pair1Type;
-                LockUnlockType pair2Type;
-
-                void *lockCall1;
-                void *unlockCall1;
-                void *lockCall2;
-                void *unlockCall2;
-
-                bool lock1IsCall;
-                bool lock2IsCall;
-                bool unlock1IsCall;
-                bool unlock2IsCall;
-
-                unsigned pos1, pos2, pos3, pos4;
-
-                // Pair 1
-                pos1 = MutatePos[i];
-                pos2 = MutatePos[i+1];
-
-                // Pair 2
-                pos3 = MutatePos[i+2];
-                pos4 = MutatePos[i+3];
+                int pair1;
+                int pair2;
+
+                Instruction *lockCall1;
+                Instruction *unlockCall1;
+                Instruction *lockCall2;
+                Instruction *unlockCall2;
+
                 // Indicies are checked to be valid in groups of four in
                 // checkCommandLineArgs()
-
-                pair1 = getGenericPair(pos1, pos2);
-                if (pair1 == NULL) {
+                if (program.isBuilt()
+                        && program.findFile(MutatePos[i], MutatePos[i+1]) >= 0
+                        && program.findFile(MutatePos[i+2], MutatePos[i+3]) >= 0
+                        && program.findFile(MutatePos[i], MutatePos[i+1])
+                           != program.findFile(MutatePos[i+2], MutatePos[i+3])) {
+                    errs() << "Warning: unable to swap pairs in different files of the program, skipping\n";
                     continue;
                 }
-
-                pair2 = getGenericPair(pos3, pos4);
-                if (pair2 == NULL) {
+                pair1 = getPairIndex(MutatePos[i], MutatePos[i+1]);
+                if (pair1 < 0) {
                     continue;
                 }
+                touchPair(pair1);
 
-                pair1Type = getTypeFromPos(pos1);
-                if (pair1Type == TypeError) {
-                    errs() << "Warning: type error encountered from position 1, skipping\n";
+                pair2 = getPairIndex(MutatePos[i+2], MutatePos[i+3]);
+                if (pair2 < 0) {
                     continue;
                 }
+                touchPair(pair2);
 
-                pair2Type = getTypeFromPos(pos3);
-                if (pair2Type == TypeError) {
-                    errs() << "Warning: type error encountered from position 1, skipping\n";
-                    continue;
-                }
-
-                lockCall1 = getLockCall(pair1, pair1Type, &lock1IsCall);
-                if (lockCall1 == NULL) {
-                    errs() << "Warning: unable to get lock from pair, skipping\n";
-                    continue;
-                }
-                unlockCall1 = getUnlockCall(pair1, pair1Type, &unlock1IsCall);
-                if (unlockCall1 == NULL) {
-                    errs() << "Warning: unable to get unlock from pair, skipping\n";
-                    continue;
-                }
-                lockCall2 = getLockCall(pair2, pair2Type, &lock2IsCall);
-                if (lockCall2 == NULL) {
-                    errs() << "Warning: unable to get lock from pair, skipping\n";
-                    continue;
-                }
-                unlockCall2 = getUnlockCall(pair2, pair2Type, &unlock2IsCall);
-                if (unlockCall2 == NULL) {
-                    errs() << "Warning: unable to get unlock from pair, skipping\n";
-                    continue;
-                }
+                lockCall1 = pairs.getLock(pair1);
+                unlockCall1 = pairs.getUnlock(pair1);
+                lockCall2 = pairs.getLock(pair2);
+                unlockCall2 = pairs.getUnlock(pair2);
 
                 if (lockCall1 == lockCall2) {
                     errs() << "Warning: lock pair stem from the same lock call, skipping\n";
@@ -351,11 +393,13 @@ struct StdMutex : public ModulePass {
                 }
 
                 int ret;
-                ret = swapCallOrInvoke(lockCall1, lockCall2, lock1IsCall, lock2IsCall);
+                ret = swapCallOrInvoke(lockCall1, lockCall2, pairs.lockIsCall(pair1),
+                        pairs.lockIsCall(pair2));
                 if (ret == 0) {
                     modified = true;
                 }
-                ret = swapCallOrInvoke(unlockCall1, unlockCall2, unlock1IsCall, unlock2IsCall);
+                ret = swapCallOrInvoke(unlockCall1, unlockCall2, pairs.unlockIsCall(pair1),
+                        pairs.unlockIsCall(pair2));
                 if (ret == 0) {
                     modified = true;
                 }
@@ -368,39 +412,25 @@ struct StdMutex : public ModulePass {
 #ifdef MUT_DEBUG
             errs() << "DEBUG: in shift mode\n";
 #endif
+	    const PairTable &pairs = lockPairs.getPairs();
 	    for (unsigned i = 0; i < MutatePos.size(); i += 2) {
-                void *pair;
-                LockUnlockType pairType; // pair and type info
-
-                void *lockCall;
-                void *unlockCall;
+                int pair;
+                Instruction *lockCall;
+                Instruction *unlockCall;
                 bool lockIsCall;
                 bool unlockIsCall; // call/invokes and type info
 
-                unsigned pos1, pos2;
-
                 // checkCommandLineArgs() guarantees that i+1 is valid
-                pos1 = MutatePos[i];
-                pos2 = MutatePos[i+1];
-
-                pair = getGenericPair(pos1, pos2);
-                pairType = getTypeFromPos(pos1);
-
-                if (pairType == TypeError) {
-                    errs() << "Warning: type error encountered from " << pos1 << ", skipping\n";
+                pair = getPairIndex(MutatePos[i], MutatePos[i+1]);
+                if (pair < 0) {
                     continue;
                 }
+                touchPair(pair);
 
-                lockCall = getLockCall(pair, pairType, &lockIsCall);
-                if (lockCall == NULL) {
-                    errs() << "Warning: error getting lock call from pair, skipping\n";
-                    continue;
-                }
-                unlockCall = getUnlockCall(pair, pairType, &unlockIsCall);
-                if (unlockCall == NULL) {
-                    errs() << "Warning: error getting unlock call from pair, skipping\n";
-                    continue;
-                }
+                lockCall = pairs.getLock(pair);
+                unlockCall = pairs.getUnlock(pair);
+                lockIsCall = pairs.lockIsCall(pair);
+                unlockIsCall = pairs.unlockIsCall(pair);
 
 		// Each element in LockDir and UnlockDir corresponds to one
 		// pair of items in MutatePos
@@ -412,10 +442,10 @@ struct StdMutex : public ModulePass {
 		    }
 		    else {
                         if (lockIsCall) {
-                            shiftCallInst((CallInst *) lockCall, shiftDir);
+                            shiftCallInst(cast<CallInst>(lockCall), shiftDir);
                         }
                         else {
-                            shiftInvokeInst((InvokeInst *) lockCall, shiftDir);
+                            shiftInvokeInst(cast<InvokeInst>(lockCall), shiftDir);
                         }
                         modified = true;
 		    }
@@ -432,10 +462,10 @@ struct StdMutex : public ModulePass {
 		    }
 		    else {
                         if (unlockIsCall) {
-                            shiftCallInst((CallInst *) unlockCall, shiftDir);
+                            shiftCallInst(cast<CallInst>(unlockCall), shiftDir);
                         }
                         else {
-                            shiftInvokeInst((InvokeInst *) unlockCall, shiftDir);
+                            shiftInvokeInst(cast<InvokeInst>(unlockCall), shiftDir);
                         }
 			modified = true;
 		    }
@@ -452,47 +482,32 @@ struct StdMutex : public ModulePass {
 #endif
             // checkCommandLineArgs() guarantees that MutatePos will be valid
             // in pairs of two.
+	    const PairTable &pairs = lockPairs.getPairs();
 	    for (unsigned i = 0; i < MutatePos.size(); i +=2) {
-                void *pair;
-                void *lockCall;
-                void *unlockCall;
-                unsigned pos1;
-                unsigned pos2;
+                int pair;
+                Instruction *lockCall;
+                Instruction *unlockCall;
                 bool lockIsCall;
                 bool unlockIsCall;
                 CallInst *lockSplit;
                 CallInst *unlockSplit;
-                LockUnlockType pairType;
-
-                pos1 = MutatePos[i];
-                pos2 = MutatePos[i+1];
-                pair = getGenericPair(pos1, pos2);
 
-                if (pair == NULL) {
+                pair = getPairIndex(MutatePos[i], MutatePos[i+1]);
+                if (pair < 0) {
                     continue;
                 }
-                pairType = getTypeFromPos(pos1);
+                touchPair(pair);
 
-                if (pairType == TypeError) {
-                    errs() << "Warning: type error encountered from " << pos1 << ", skipping\n";
-                }
-
-                lockCall = getLockCall(pair, pairType, &lockIsCall);
-                if (lockCall == NULL) {
-                    errs() << "Warning: error getting lock call from pair, skipping\n";
-                    continue;
-                }
-                unlockCall = getUnlockCall(pair, pairType, &unlockIsCall);
-                if (unlockCall == NULL) {
-                    errs() << "Warning: error getting unlock call from pair, skipping\n";
-                    continue;
-                }
+                lockCall = pairs.getLock(pair);
+                unlockCall = pairs.getUnlock(pair);
+                lockIsCall = pairs.lockIsCall(pair);
+                unlockIsCall = pairs.unlockIsCall(pair);
 
 		int dist;
 		int unlockPos;
 		int lockPos;
 
-		dist = lockPairs.calcDistanceBetween((Instruction *)lockCall, (Instruction *)unlockCall);
+		dist = lockPairs.calcDistanceBetween(lockCall, unlockCall);
 #ifdef MUT_DEBUG
 		errs() << "DEBUG: distance between pair == " << dist << '\n';
 #endif
@@ -535,28 +550,28 @@ struct StdMutex : public ModulePass {
                 // blocks during the split
                 if (lockIsCall) {
                     int error;
-                    lockSplit = createMutexCopy((CallInst *) lockCall, error);
+                    lockSplit = createMutexCopy(cast<CallInst>(lockCall), error);
                     if (error != 0) {
                         continue;
                     }
                 }
                 else {
                     int error;
-                    lockSplit = createMutexCopy((InvokeInst *) lockCall, error);
+                    lockSplit = createMutexCopy(cast<InvokeInst>(lockCall), error);
                     if (error != 0) {
                         continue;
                     }
                 }
                 if (unlockIsCall) {
                     int error;
-                    unlockSplit = createMutexCopy((CallInst *) unlockCall, error);
+                    unlockSplit = createMutexCopy(cast<CallInst>(unlockCall), error);
                     if (error != 0) {
                         continue;
                     }
                 }
                 else {
                     int error;
-                    unlockSplit = createMutexCopy((InvokeInst *) unlockCall, error);
+                    unlockSplit = createMutexCopy(cast<InvokeInst>(unlockCall), error);
                     if (error != 0) {
                         continue;
                     }
@@ -564,19 +579,45 @@ struct StdMutex : public ModulePass {
 
                 modified = true;
 
-		insertInstructionRelative((Instruction *)lockCall, (Instruction *)unlockSplit, unlockPos);
+		insertInstructionRelative(lockCall, unlockSplit, unlockPos);
 		if (unlockPos < lockPos) {
                     // Add 1 to the lock position to account for the fact that
                     // the unlock call was just inserted in its path
 		    lockPos += 1;
 		}
-		insertInstructionRelative((Instruction *)lockCall, (Instruction *)lockSplit, lockPos);
+		insertInstructionRelative(lockCall, lockSplit, lockPos);
             } // end for
         } // end else if splitMode
+	if (modified) {
+	    verifier.check(M, "Mutex");
+	}
 	return modified;
     }
 
     virtual void print(llvm::raw_ostream &O, const Module *M) const {
+        if (offsetsMode) {
+            printOffsets();
+            return;
+        }
+        if (conflictsMode) {
+            printConflicts();
+            return;
+        }
+        if (featuresMode) {
+            printFeatures();
+            return;
+        }
+        if (program.isBuilt()) {
+            // Totals of the whole program, in the same format as a single file
+            for (unsigned k = 0; k < PairTable::NumKinds; k++) {
+                if (program.getTotal(k) != 0)
+                    errs() << k << '\t' << program.getTotal(k) << '\n';
+            }
+            if (verbose) {
+                program.print(errs());
+            }
+            return;
+        }
 	if (!verbose) {
             if (lockPairs.getNumCallCallPairs() != 0)
                 errs() << 0 << '\t' << lockPairs.getNumCallCallPairs() << '\n';
@@ -617,6 +658,29 @@ struct StdMutex : public ModulePass {
 	    errs() << "Error: -shift and -split cannot be specified at the same time\n";
 	    exit(EXIT_FAILURE);
 	}
+	if (offsetsMode && (rmMode || swapMode || shiftMode || splitMode)) {
+	    errs() << "Error: -offsets only lists offsets and cannot be used "
+		      "with a mutation\n";
+	    exit(EXIT_FAILURE);
+	}
+	if (conflictsMode && (rmMode || swapMode || shiftMode || splitMode)) {
+	    errs() << "Error: -conflicts only lists conflicts and cannot be used "
+		      "with a mutation\n";
+	    exit(EXIT_FAILURE);
+	}
+	if (conflictsMode && offsetsMode) {
+	    errs() << "Error: -conflicts and -offsets cannot be specified at the same time\n";
+	    exit(EXIT_FAILURE);
+	}
+	if (featuresMode && (rmMode || swapMode || shiftMode || splitMode)) {
+	    errs() << "Error: -features only lists features and cannot be used "
+		      "with a mutation\n";
+	    exit(EXIT_FAILURE);
+	}
+	if (featuresMode && (offsetsMode || conflictsMode)) {
+	    errs() << "Error: -features cannot be used with -offsets or -conflicts\n";
+	    exit(EXIT_FAILURE);
+	}
 
 	if (rmMode) {
 	    if (MutatePos.size() == 0) {
@@ -737,84 +801,23 @@ struct StdMutex : public ModulePass {
         }
     }
 
-    void *getLockCall(void *pair, LockUnlockType type, bool *isCall = NULL) {
-        if (type == CallCall) {
-            if (isCall != NULL)
-                *isCall = true;
-            return ((LockUnlockPairs::CallCallLockPair *) pair)->lockCall;
-        }
-        else if (type == CallInvoke) {
-            if (isCall != NULL)
-                *isCall = true;
-            return ((LockUnlockPairs::CallInvokeLockPair *) pair)->lockCall;
-        }
-        else if (type == InvokeCall) {
-            if (isCall != NULL)
-                *isCall = false;
-            return ((LockUnlockPairs::InvokeCallLockPair *) pair)->lockInvoke;
-        }
-        else if (type == InvokeInvoke) {
-            if (isCall != NULL)
-                *isCall = false;
-            return ((LockUnlockPairs::InvokeInvokeLockPair *) pair)->lockInvoke;
-        }
-        return NULL;
-    }
-
-    void *getUnlockCall(void *pair, LockUnlockType type, bool *isCall) {
-        if (type == CallCall) {
-            if (isCall != NULL)
-                *isCall = true;
-            return ((LockUnlockPairs::CallCallLockPair *) pair)->unlockCall;
-        }
-        else if (type == CallInvoke) {
-            if (isCall != NULL)
-                *isCall = false;
-            return ((LockUnlockPairs::CallInvokeLockPair *) pair)->unlockInvoke;
-        }
-        else if (type == InvokeCall) {
-            if (isCall != NULL)
-                *isCall = true;
-            return ((LockUnlockPairs::InvokeCallLockPair *) pair)->unlockCall;
-        }
-        else if (type == InvokeInvoke) {
-            if (isCall != NULL)
-                *isCall = false;
-            return ((LockUnlockPairs::InvokeInvokeLockPair *) pair)->unlockInvoke;
-        }
-        return NULL;
-    }
-
     // Swaps gen1 with gen2 using gen{1,2}IsCall to determine if call1 or
     // call2 is a CallInst or an InvokeInst
-    int swapCallOrInvoke(void *gen1, void *gen2, bool gen1IsCall, bool gen2IsCall) {
+    int swapCallOrInvoke(Instruction *gen1, Instruction *gen2, bool gen1IsCall, bool gen2IsCall) {
         if (gen1IsCall && gen2IsCall) {
-            return swapCalls((CallInst *) gen1, (CallInst *) gen2);
+            return swapCalls(cast<CallInst>(gen1), cast<CallInst>(gen2));
         }
         else if (gen1IsCall && !gen2IsCall) {
-            return swapCallInvoke((CallInst *) gen1, (InvokeInst *) gen2);
+            return swapCallInvoke(cast<CallInst>(gen1), cast<InvokeInst>(gen2));
         }
         else if (!gen1IsCall && gen2IsCall) {
-            return swapCallInvoke((CallInst *) gen2, (InvokeInst *) gen1);
+            return swapCallInvoke(cast<CallInst>(gen2), cast<InvokeInst>(gen1));
         }
         else { // implicit both false
-            return swapInvokes((InvokeInst *) gen1, (InvokeInst *) gen2);
+            return swapInvokes(cast<InvokeInst>(gen1), cast<InvokeInst>(gen2));
         }
     }
 
-    LockUnlockType getTypeFromPos(unsigned pos) {
-        if (pos == 0)
-            return CallCall;
-        else if (pos == 1)
-            return CallInvoke;
-        else if (pos == 2)
-            return InvokeCall;
-        else if (pos == 3)
-            return InvokeInvoke;
-
-        return TypeError;
-    }
-
     int swapCalls(CallInst *call1, CallInst *call2) {
 #ifdef MUT_DEBUG
         errs() << "DEBUG: swapping:\n"
@@ -1232,6 +1235,119 @@ struct StdMutex : public ModulePass {
         shiftCallInst(callCopy, dir);
     }
 
+    // Fills offsets with the legal offsets of every pair. Pairs are kept
+    // function by function so the DominatorTree of each function is only
+    // computed once.
+    void findOffsets() {
+        const PairTable &pairs = lockPairs.getPairs();
+        Function *curFunc;
+        DominatorTree *DT;
+
+        offsets.clear();
+        offsets.resize(pairs.size());
+        curFunc = NULL;
+        DT = NULL;
+        for (unsigned i = 0; i < pairs.size(); i++) {
+            Function *F;
+            F = pairs.getLock(i)->getParent()->getParent();
+            if (F != curFunc) {
+                curFunc = F;
+                DT = &getAnalysis<DominatorTree>(*F);
+            }
+            findLegalOffsets(pairs.getLock(i), pairs.getUnlock(i), *DT, offsets[i]);
+        }
+    }
+
+    // Prints `<kind>\t<index>\t<offsets>` for each pair with the index used by
+    // -pos (global with -program)
+    void printOffsets() const {
+        const PairTable &pairs = lockPairs.getPairs();
+        for (unsigned kind = 0; kind < PairTable::NumKinds; kind++) {
+            unsigned first;
+            first = 0;
+            if (program.isBuilt()) {
+                first = program.getOffset(program.getCurFile(), kind);
+            }
+            for (unsigned i = 0; i < pairs.getNumOfKind(kind); i++) {
+                errs() << kind << '\t' << first + i << '\t';
+                printLegalOffsets(errs(), offsets[pairs.lookupByKind(kind, i)]);
+                errs() << '\n';
+            }
+        }
+    }
+
+    // Prints `<kind>\t<index>\t<index>\t<reason>` for each conflict with the
+    // indices used by -pos (global with -program)
+    void printConflicts() const {
+        for (unsigned kind = 0; kind < PairTable::NumKinds; kind++) {
+            unsigned first;
+            first = 0;
+            if (program.isBuilt()) {
+                first = program.getOffset(program.getCurFile(), kind);
+            }
+            for (unsigned i = 0; i < conflicts[kind].size(); i++) {
+                const PairConflict &c = conflicts[kind][i];
+                errs() << kind << '\t' << first + c.a << '\t' << first + c.b << '\t'
+                       << PairConflict::getReasonName(c.reason) << '\n';
+            }
+        }
+    }
+
+    // Fills features for every pair. Like findOffsets(), the LoopInfo of each
+    // function is only computed once.
+    void findFeatures(Module &M) {
+        const PairTable &pairs = lockPairs.getPairs();
+        ThreadContext threads(M);
+        Function *curFunc;
+        LoopInfo *LI;
+        unsigned funcSize;
+
+        features.clear();
+        features.resize(pairs.size());
+        curFunc = NULL;
+        LI = NULL;
+        funcSize = 0;
+        for (unsigned i = 0; i < pairs.size(); i++) {
+            Instruction *lock = pairs.getLock(i);
+            Function *F = lock->getParent()->getParent();
+            if (F != curFunc) {
+                curFunc = F;
+                LI = &getAnalysis<LoopInfo>(*F);
+                funcSize = 0;
+                for (Function::iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB) {
+                    funcSize += BB->size();
+                }
+            }
+            features[i].dist = lockPairs.calcDistanceBetween(lock, pairs.getUnlock(i));
+            features[i].funcSize = funcSize;
+            features[i].loopDepth = LI->getLoopDepth(lock->getParent());
+            features[i].context = threads.getContext(lock);
+        }
+    }
+
+    // Prints a header naming the columns and `<kind>\t<index>\t<features>` for
+    // each pair with the index used by -pos (global with -program). The
+    // thread context is 0 (single), 1 (unknown) or 2 (multi).
+    void printFeatures() const {
+        const PairTable &pairs = lockPairs.getPairs();
+        errs() << "# kind\tindex\tdist\tfuncsize\tloopdepth\tcontext\t"
+                  "lockinvoke\tunlockinvoke\n";
+        for (unsigned kind = 0; kind < PairTable::NumKinds; kind++) {
+            unsigned first;
+            first = 0;
+            if (program.isBuilt()) {
+                first = program.getOffset(program.getCurFile(), kind);
+            }
+            for (unsigned i = 0; i < pairs.getNumOfKind(kind); i++) {
+                int pair = pairs.lookupByKind(kind, i);
+                const PairFeatures &f = features[pair];
+                errs() << kind << '\t' << first + i << '\t' << f.dist << '\t'
+                       << f.funcSize << '\t' << f.loopDepth << '\t' << f.context << '\t'
+                       << !pairs.lockIsCall(pair) << '\t' << !pairs.unlockIsCall(pair) << '\n';
+            }
+        }
+    }
+
     // Inserts insertMe before the instruction distance instructions from base
     void insertInstructionRelative(Instruction *base, Instruction *insertMe, unsigned distance) {
 	inst_iterator iter = inst_begin(base->getParent()->getParent());
@@ -1258,6 +1374,44 @@ struct StdMutex : public ModulePass {
 	bb->getInstList().insert(&*iter, insertMe);
     }
 
+    // ProgramSites::CountFunc counting the pairs of each kind in M. arg is
+    // the pass. The module being mutated was already enumerated by the pass,
+    // the AliasAnalysis of the pass belongs to it and is not used on the
+    // other files: each one is counted in its own PassManager with -basicaa.
+    static void countPairs(Module &M, unsigned *counts, void *arg) {
+        StdMutex *self = (StdMutex *) arg;
+        if (&M == self->curModule) {
+            for (unsigned k = 0; k < PairTable::NumKinds; k++) {
+                counts[k] = self->lockPairs.getPairs().getNumOfKind(k);
+            }
+            return;
+        }
+
+        PassManager PM;
+        if (!M.getDataLayout().empty()) {
+            PM.add(new DataLayout(&M));
+        }
+        PM.add(createBasicAliasAnalysisPass());
+        PM.add(new CountProgramPairs(counts));
+        PM.run(M);
+    }
+
+    // Returns true if the AliasAnalysis of the pass is -basicaa. The other
+    // files of -program are counted with -basicaa, so the module being
+    // mutated must be too for the numbering to be the same in every run.
+    bool usesBasicAA() {
+        const PassInfo *basic = PassRegistry::getPassRegistry()->getPassInfo(StringRef("basicaa"));
+        Pass *impl = getResolver()->findImplPass(&AliasAnalysis::ID);
+        return basic != NULL && impl != NULL && impl->getPassID() == basic->getTypeInfo();
+    }
+
+    // Record the function of a pair that is about to be mutated
+    void touchPair(int pair) {
+        const PairTable &pairs = lockPairs.getPairs();
+        verifier.touch(pairs.getLock(pair));
+        verifier.touch(pairs.getUnlock(pair));
+    }
+
     void posOutOfBoundsWarning(int pos1, int pos2) {
         errs() << "Warning: position (" << pos1 << ", " << pos2
                << ") is out of bounds, skipping\n";
@@ -1267,77 +1421,42 @@ struct StdMutex : public ModulePass {
         errs() << "Warning: unable to mutate pairs of pairs involving POSIX and C++11, skipping\n";
     }
 
-    // Returns a pointer to the LockUnlock pair at pos1 and pos2. pos1
-    // determinest the type so the caller should know this. Returns NULL on
-    // failure and will output a warning message.
-    void *getGenericPair(unsigned pos1, unsigned pos2) {
-        void *pair = NULL;
-
-        if (pos1 == 0) { // CallCall
-            pair = lockPairs.getCallCallPair(pos2);
-            if (pair == NULL) {
-                posOutOfBoundsWarning(pos1, pos2);
-            }
+    // Returns the index in lockPairs.getPairs() of the pair at pos1 and pos2.
+    // pos1 is the kind of the pair and pos2 the index among that kind (global
+    // with -program). Returns -1 on failure and will output a warning message
+    // unless the pair is in another file of the program.
+    int getPairIndex(unsigned pos1, unsigned pos2) {
+        int pair;
+        if (program.isBuilt()) {
+            int local;
+            local = program.toLocal(pos1, pos2);
+            if (local == -2) {
+                // The pair is in another file of the program
 #ifdef MUT_DEBUG
-            else {
-                errs() << "DEBUG: Found pair:\n\t" 
-                       << *(((LockUnlockPairs::CallCallLockPair *) pair)->lockCall) << "\n\t"
-                       << *(((LockUnlockPairs::CallCallLockPair *) pair)->unlockCall) << "\n";
-            }
+                errs() << "DEBUG: position (" << pos1 << ", " << pos2
+                       << ") is in " << program.getFile(program.findFile(pos1, pos2))
+                       << '\n';
 #endif
-        }
-        else if (pos1 == 1) { // CallInvoke
-            // TODO: This needs a test case
-#ifdef MUT_DEBUG
-            errs() << "DEBUG: call-invoke test found\n";
-#endif
-            pair = lockPairs.getCallInvokePair(pos2);
-            if (pair == NULL) {
-                posOutOfBoundsWarning(pos1, pos2);
-            }
-#ifdef MUT_DEBUG
-            else {
-                errs() << "DEBUG: Found pair:\n\t" 
-                       << *(((LockUnlockPairs::CallInvokeLockPair *) pair)->lockCall) << "\n\t"
-                       << *(((LockUnlockPairs::CallInvokeLockPair *) pair)->unlockInvoke) << "\n";
+                return -1;
             }
-#endif
-        }
-        else if (pos1 == 2) { // InvokeCall
-            pair = lockPairs.getInvokeCallPair(pos2);
-            if (pair == NULL) {
+            if (local == -1) {
                 posOutOfBoundsWarning(pos1, pos2);
+                return -1;
             }
-#ifdef MUT_DEBUG
-            else {
-                errs() << "DEBUG: Found pair:\n\t" 
-                       << *(((LockUnlockPairs::InvokeCallLockPair *) pair)->lockInvoke) << "\n\t"
-                       << *(((LockUnlockPairs::InvokeCallLockPair *) pair)->unlockCall) << "\n";
-            }
-#endif
+            pos2 = local;
         }
-        else if (pos1 == 3) { // InvokeInvoke
-            // TODO: this needs a test case
-#ifdef MUT_DEBUG
-            errs() << "DEBUG: invoke-invoke test found\n";
-#endif
-            pair = lockPairs.getInvokeInvokePair(pos1);
-            if (pair == NULL) {
-                posOutOfBoundsWarning(pos1, pos2);
-            }
-#ifdef MUT_DEBUG
-            else {
-                errs() << "DEBUG: Found pair:\n\t" 
-                       << *(((LockUnlockPairs::InvokeInvokeLockPair *) pair)->lockInvoke) << "\n\t"
-                       << *(((LockUnlockPairs::InvokeInvokeLockPair *) pair)->unlockInvoke) << "\n";
-            }
-#endif
+        pair = lockPairs.getPairIndex(pos1, pos2);
+        if (pair < 0) {
+            posOutOfBoundsWarning(pos1, pos2);
         }
+#ifdef MUT_DEBUG
         else {
-            posOutOfBoundsWarning(pos1, pos2);
-            pair = NULL;
+            const PairTable &pairs = lockPairs.getPairs();
+            errs() << "DEBUG: Found pair:\n\t" 
+                   << *(pairs.getLock(pair)) << "\n\t"
+                   << *(pairs.getUnlock(pair)) << "\n";
         }
-
+#endif
         return pair;
     }
 
@@ -1417,4 +1536,5 @@ struct StdMutex : public ModulePass {
 } // namespace
 
 char StdMutex::ID = 0;
+char CountProgramPairs::ID = 0;
 static RegisterPass<StdMutex> X("Mutex", "mutate pairs of calls to std::mutex::lock and std::mutex::unlock", false, false);
@@ -2,9 +2,11 @@
  * This file is distributed under the University of Illinois Open Source
  * License. See LICENSE for details.
  */
-#include "LockUnlockPairs.h"
-#include "../Tools/ItaniumDemangle.h"
+#include "StdLockUnlockPairs.h"
 #include "../Tools/FileInfo.h"
+#include "../Tools/ProgramOrder.h"
+#include "../Tools/SyncSymbols.h"
+#include "../Tools/SiteCatalog.h"
 
 #include "llvm/Support/InstIterator.h"
 #include "llvm/Support/raw_ostream.h"
@@ -19,77 +21,124 @@
 // Enable verbose output
 #define MUT_DEBUG_VERBOSE
 
-void LockUnlockPairs::enumerate(Module &M, AliasAnalysis &AA) {
-    // Iterate over every function
+void StdLockUnlockPairs::enumerate(Module &M, AliasAnalysis &AA) {
+    // Every lock & unlock call in the module. Only the uses of the matching
+    // declarations are looked at instead of every instruction in the module
+    std::vector<CallInst *> mutexCalls;
+    std::vector<InvokeInst *> mutexInvokes;
+    SourceScope scope;
+
     Module::iterator fIter = M.begin();
     Module::iterator fEnd = M.end();
-
     for(;fIter != fEnd; ++fIter) {
+        if (isMatch(&*fIter)) {
+#ifdef MUT_DEBUG_VERB
+            errs() << "DEBUG: collecting uses of " << fIter->getName() << '\n';
+#endif
+            collectCallSites(&*fIter, mutexCalls, mutexInvokes, scope);
+        }
+    }
+
+    // Put the calls back in the order they appear in the module so pairs
+    // are numbered the same as when every instruction was visited
+    ProgramOrder PO(M);
+    sortInProgramOrder(mutexCalls, PO);
+    sortInProgramOrder(mutexInvokes, PO);
+
+    enumerateSites(mutexCalls, mutexInvokes, PO, AA);
+}
+
+void StdLockUnlockPairs::enumerate(const SiteCatalog &catalog, AliasAnalysis &AA) {
+    static const SyncKind mutexKinds[] = {
+        SK_PthreadMutexLock, SK_PthreadMutexUnlock,
+        SK_StdMutexLock, SK_StdMutexUnlock
+    };
+    std::vector<CallInst *> mutexCalls;
+    std::vector<InvokeInst *> mutexInvokes;
+
+    catalog.getCallSites(mutexKinds, 4, mutexCalls, mutexInvokes);
+    enumerateSites(mutexCalls, mutexInvokes, catalog.getProgramOrder(), AA);
+}
+
+void StdLockUnlockPairs::enumerateSites(std::vector<CallInst *> &mutexCalls,
+        std::vector<InvokeInst *> &mutexInvokes, ProgramOrder &PO,
+        AliasAnalysis &AA) {
+    // Pairs can only be in the same function. Both vectors are sorted so
+    // each function's calls are next to each other; take the function that
+    // comes first in the module and record the range of its calls.
+    // groupStart holds four values per function: the first call, the end
+    // of the calls, the first invoke and the end of the invokes
+    std::vector<unsigned> groupStart;
+    unsigned maxPairs = 0;
+    unsigned callIdx = 0;
+    unsigned invokeIdx = 0;
+    while (callIdx < mutexCalls.size() || invokeIdx < mutexInvokes.size()) {
+        Function *curFunc;
+        if (invokeIdx == mutexInvokes.size()
+                || (callIdx < mutexCalls.size()
+                    && PO.comesBefore(mutexCalls[callIdx], mutexInvokes[invokeIdx]))) {
+            curFunc = mutexCalls[callIdx]->getParent()->getParent();
+        }
+        else {
+            curFunc = mutexInvokes[invokeIdx]->getParent()->getParent();
+        }
+
+        unsigned numLocks = 0;
+        unsigned numSites = 0;
+        groupStart.push_back(callIdx);
+        while (callIdx < mutexCalls.size()
+                && mutexCalls[callIdx]->getParent()->getParent() == curFunc) {
+            if (isLockCall(mutexCalls[callIdx]->getCalledFunction())) {
+                numLocks++;
+            }
+            numSites++;
+            callIdx++;
+        }
+        groupStart.push_back(callIdx);
+        groupStart.push_back(invokeIdx);
+        while (invokeIdx < mutexInvokes.size()
+                && mutexInvokes[invokeIdx]->getParent()->getParent() == curFunc) {
+            if (isLockCall(mutexInvokes[invokeIdx]->getCalledFunction())) {
+                numLocks++;
+            }
+            numSites++;
+            invokeIdx++;
+        }
+        groupStart.push_back(invokeIdx);
+
+        // Each lock can at most pair with every other site in the function
+        maxPairs += numLocks * (numSites - 1);
+    }
+
+    unsigned numFuncs = groupStart.size() / 4;
+    pairs.reserve(maxPairs, numFuncs);
+
+    for (unsigned f = 0; f < numFuncs; f++) {
+        unsigned callBegin = groupStart[4 * f];
+        unsigned callEnd = groupStart[4 * f + 1];
+        unsigned invokeBegin = groupStart[4 * f + 2];
+        unsigned invokeEnd = groupStart[4 * f + 3];
 #ifdef MUT_DEBUG_VERB
-        errs() << "DEBUG: checking new function\n";
+        errs() << "DEBUG: finding pairs in function " << f << '\n';
 #endif
-        // Vector to hold all lock & unlock call for the function
-        std::vector<CallInst *> mutexCalls;
-        std::vector<InvokeInst *> mutexInvokes;
-
-        // Iterate over every instruction
-	inst_iterator I;
-	inst_iterator E;
-	for (I = inst_begin(&*fIter), E = inst_end(&*fIter);
-		I != E; ++I) {
-            // Find target call/invoke instructions
-	    if (CallInst* callInst = dyn_cast<CallInst>(&*I)) {
-		Function *calledFunc = callInst->getCalledFunction();
-		if (calledFunc) {
-                    //StringRef funcName = calledFunc->getName();
-                    bool matchedFuncCall;
-                    matchedFuncCall = isMatch(calledFunc);
-                    if (matchedFuncCall) {
-                        mutexCalls.push_back(callInst);
-                    }
-		}
-	    }
-            else if (InvokeInst* invokeInst = dyn_cast<InvokeInst>(&*I)) {
-		Function *calledFunc = invokeInst->getCalledFunction();
-		if (calledFunc) {
-                    //StringRef funcName = calledFunc->getName();
-                    bool matchedFuncCall;
-                    matchedFuncCall = isMatch(calledFunc);
-                    if (matchedFuncCall) {
-                        mutexInvokes.push_back(invokeInst);
-                    }
-		}
-	    }
-        } // end for (insts)
-        // Find pairs in the current function
-        //findCallPairs(mutexCalls, AA);
-        //findInvokePairs(mutexInvokes, AA);
-        findPairs(mutexCalls, mutexInvokes, AA);
-    } // end for (funcs)
+        findPairs(mutexCalls.empty() ? NULL : &mutexCalls[0] + callBegin, callEnd - callBegin,
+                mutexInvokes.empty() ? NULL : &mutexInvokes[0] + invokeBegin,
+                invokeEnd - invokeBegin, f, AA);
+    }
+    pairs.finish();
 } // end func
 
-bool LockUnlockPairs::isMatch(Function *func) {
-    std::string noParams;
+bool StdLockUnlockPairs::isMatch(Function *func) {
+    SyncKind kind;
     bool ret;
-    ret = false;
-    noParams = getFunctionName(func);
+    kind = classifyFunction(func);
 
 #ifdef MUT_DEBUG_VERB
-    errs() << "DEBUG: checking for match: " << noParams << '\n';
+    errs() << "DEBUG: checking for match: " << getSyncKindName(kind) << '\n';
 #endif
 
-    if (noParams == "std::__1::mutex::unlock") {
-        ret = true;
-    }
-    else if (noParams == "std::__1::mutex::lock") {
-        ret = true;
-    }
-    else if (noParams == "pthread_mutex_lock") {
-        ret = true;
-    }
-    else if (noParams == "pthread_mutex_unlock") {
-        ret = true;
-    }
+    ret = kind == SK_StdMutexLock || kind == SK_StdMutexUnlock
+        || kind == SK_PthreadMutexLock || kind == SK_PthreadMutexUnlock;
 
 #ifdef MUT_DEBUG_VERB
     errs() << "DEBUG: match found? " << ret << '\n';
@@ -99,7 +148,7 @@ bool LockUnlockPairs::isMatch(Function *func) {
 
 #if 0 // These two functions don't provide full coverage of the case when a
       // lock is a CallInst and the unlock call is an Invoke and vice versa.
-void LockUnlockPairs::findCallPairs(std::vector<CallInst *> &calls, AliasAnalysis &AA) {
+void StdLockUnlockPairs::findCallPairs(std::vector<CallInst *> &calls, AliasAnalysis &AA) {
 #ifdef MUT_DEBUG
     errs() << "DEBUG: attempting to find call pairs in the following\n (size == " 
            << calls.size() << ")\n";
@@ -133,7 +182,7 @@ void LockUnlockPairs::findCallPairs(std::vector<CallInst *> &calls, AliasAnalysi
     }
 }
 
-void LockUnlockPairs::findInvokePairs(std::vector<InvokeInst *> &calls, AliasAnalysis &AA) {
+void StdLockUnlockPairs::findInvokePairs(std::vector<InvokeInst *> &calls, AliasAnalysis &AA) {
 #ifdef MUT_DEBUG
     errs() << "DEBUG: attempting to find invoke pairs in the following\n (size == " 
            << calls.size() << ")\n";
@@ -167,20 +216,20 @@ void LockUnlockPairs::findInvokePairs(std::vector<InvokeInst *> &calls, AliasAna
 }
 #endif
 
-void LockUnlockPairs::findPairs(std::vector<CallInst *> &calls, std::vector<InvokeInst *> &invokes,
-        AliasAnalysis &AA) {
+void StdLockUnlockPairs::findPairs(CallInst **calls, unsigned numCalls, InvokeInst **invokes,
+        unsigned numInvokes, unsigned funcIndex, AliasAnalysis &AA) {
     // For each lock instruction found in either calls or invokes compare it to
     // every other unlock call to see if they are a pair. There is probably a
     // more optimal way to do this by also comparing unlock calls to lock
     // calls.
 
     // Compare all the call instructions
-    for (unsigned i = 0; i < calls.size(); i++) {
+    for (unsigned i = 0; i < numCalls; i++) {
         CallInst *call1;
         call1 = calls[i];
         if (isLockCall(call1->getCalledFunction())) {
             // Compare to all other CallInsts
-            for (unsigned j = 0; j < calls.size(); j++) {
+            for (unsigned j = 0; j < numCalls; j++) {
                 CallInst *call2;
                 call2 = calls[j];
                 if (call1 == call2) {
@@ -194,14 +243,10 @@ void LockUnlockPairs::findPairs(std::vector<CallInst *> &calls, std::vector<Invo
 #ifdef MUT_DEBUG_VERB
                     errs() << "DEBUG: found pair:\n\t" << *call1 << "\n\t" << *call2 << '\n';
 #endif
-                    CallCallLockPair *newPair;
-                    newPair = new CallCallLockPair;
-                    newPair->lockCall = call1;
-                    newPair->unlockCall = call2;
-                    CallCallPairs.push_back(newPair);
+                    pairs.add(call1, call2, funcIndex);
                 }
             } // end for
-            for (unsigned j = 0; j < invokes.size(); j++) {
+            for (unsigned j = 0; j < numInvokes; j++) {
                 // Compare to invoke instructions
                 InvokeInst *invoke2;
                 invoke2 = invokes[j];
@@ -209,37 +254,29 @@ void LockUnlockPairs::findPairs(std::vector<CallInst *> &calls, std::vector<Invo
 #ifdef MUT_DEBUG_VERB
                     errs() << "DEBUG: found pair:\n\t" << *call1 << "\n\t" << *invoke2 << '\n';
 #endif
-                    CallInvokeLockPair *newPair;
-                    newPair = new CallInvokeLockPair;
-                    newPair->lockCall = call1;
-                    newPair->unlockInvoke = invoke2;
-                    CallInvokePairs.push_back(newPair);
+                    pairs.add(call1, invoke2, funcIndex);
                 }
             }
         }
     } // end for
 
     // Compare all the invokes
-    for (unsigned i = 0; i < invokes.size(); i++) {
+    for (unsigned i = 0; i < numInvokes; i++) {
         InvokeInst *invoke1;
         invoke1 = invokes[i];
         if (isLockCall(invoke1->getCalledFunction())) {
             // Compare to all other CallInsts
-            for (unsigned j = 0; j < calls.size(); j++) {
+            for (unsigned j = 0; j < numCalls; j++) {
                 CallInst *call2;
                 call2 = calls[j];
                 if (isLockUnlockPair(invoke1, call2, AA)) {
 #ifdef MUT_DEBUG_VERB
                     errs() << "DEBUG: found pair:\n\t" << *invoke1 << "\n\t" << *call2 << '\n';
 #endif
-                    InvokeCallLockPair *newPair;
-                    newPair = new InvokeCallLockPair;
-                    newPair->lockInvoke = invoke1;
-                    newPair->unlockCall = call2;
-                    InvokeCallPairs.push_back(newPair);
+                    pairs.add(invoke1, call2, funcIndex);
                 }
             } // end for
-            for (unsigned j = 0; j < invokes.size(); j++) {
+            for (unsigned j = 0; j < numInvokes; j++) {
                 // Compare to invoke instructions
                 InvokeInst *invoke2;
                 invoke2 = invokes[j];
@@ -254,37 +291,20 @@ void LockUnlockPairs::findPairs(std::vector<CallInst *> &calls, std::vector<Invo
 #ifdef MUT_DEBUG_VERB
                     errs() << "DEBUG: found pair:\n\t" << *invoke1 << "\n\t" << *invoke2 << '\n';
 #endif
-                    InvokeInvokeLockPair *newPair;
-                    newPair = new InvokeInvokeLockPair;
-                    newPair->lockInvoke = invoke1;
-                    newPair->unlockInvoke = invoke2;
-                    InvokeInvokePairs.push_back(newPair);
+                    pairs.add(invoke1, invoke2, funcIndex);
                 }
             } // end for
         }
     } // end for
 }
-bool LockUnlockPairs::isLockCall(Function *func) const {
-    StringRef funcName;
-    std::string noParams;
-    bool ret = false;
-    if (func == NULL) {
-        return false; // indirect function calls are not resolved
-    }
-
-    noParams = getFunctionName(func);
-
-    if (noParams == "pthread_mutex_lock") {
-        ret = true;
-    }
-    else if (noParams == "std::__1::mutex::lock") {
-        ret = true;
-    }
+bool StdLockUnlockPairs::isLockCall(Function *func) const {
+    SyncKind kind;
+    kind = classifyFunction(func); // SK_None for indirect calls
 
-    return ret;
+    return kind == SK_PthreadMutexLock || kind == SK_StdMutexLock;
 }
 
-bool LockUnlockPairs::isLockUnlockPair(Function *lockFunc, Function *otherFunc, 
+bool StdLockUnlockPairs::isLockUnlockPair(Function *lockFunc, Function *otherFunc, 
         AliasAnalysis &AA, Value *mut1, Value *mut2) {
     if (lockFunc == NULL) {
         return false;
@@ -301,22 +321,22 @@ bool LockUnlockPairs::isLockUnlockPair(Function *lockFunc, Function *otherFunc,
         return false;
     }
 
-    std::string lockFuncName;
-    std::string otherFuncName;
-    otherFuncName = getFunctionName(otherFunc);
-    lockFuncName = getFunctionName(lockFunc);
+    SyncKind lockKind;
+    SyncKind otherKind;
+    otherKind = classifyFunction(otherFunc);
+    lockKind = classifyFunction(lockFunc);
 
 
     AliasAnalysis::AliasResult res;
     res = AA.alias(mut1, mut2);
 
-    if (lockFuncName == "pthread_mutex_lock" && otherFuncName == "pthread_mutex_unlock") {
+    if (lockKind == SK_PthreadMutexLock && otherKind == SK_PthreadMutexUnlock) {
         // The calls are both to posix locks. The first parameters is the mutex
         if (res == AliasAnalysis::MustAlias) {
             return true;
         }
     }
-    else if (lockFuncName == "std::__1::mutex::lock" && otherFuncName == "std::__1::mutex::unlock") {
+    else if (lockKind == SK_StdMutexLock && otherKind == SK_StdMutexUnlock) {
         if (res == AliasAnalysis::MustAlias) {
             return true;
         }
@@ -325,7 +345,7 @@ bool LockUnlockPairs::isLockUnlockPair(Function *lockFunc, Function *otherFunc,
     return false;
 }
 
-bool LockUnlockPairs::isLockUnlockPair(CallInst *lockCall, CallInst *otherCall, AliasAnalysis &AA) {
+bool StdLockUnlockPairs::isLockUnlockPair(CallInst *lockCall, CallInst *otherCall, AliasAnalysis &AA) {
     if (lockCall->getNumArgOperands() < 1) {
         errs() << "Warning: found a pthread or std::mutex call with < 1 operand, skipping\n";
         return false;
@@ -347,7 +367,7 @@ bool LockUnlockPairs::isLockUnlockPair(CallInst *lockCall, CallInst *otherCall,
     return isLockUnlockPair(lockFunc, otherFunc, AA, mut1, mut2);
 }
 
-bool LockUnlockPairs::isLockUnlockPair(InvokeInst *lockCall, InvokeInst *otherCall, AliasAnalysis &AA) {
+bool StdLockUnlockPairs::isLockUnlockPair(InvokeInst *lockCall, InvokeInst *otherCall, AliasAnalysis &AA) {
     if (lockCall->getNumArgOperands() < 1) {
         errs() << "Warning: found a pthread or std::mutex invoke with < 1 operand, skipping\n";
         return false;
@@ -369,7 +389,7 @@ bool LockUnlockPairs::isLockUnlockPair(InvokeInst *lockCall, InvokeInst *otherCa
     return isLockUnlockPair(lockFunc, otherFunc, AA, mut1, mut2);
 }
 
-bool LockUnlockPairs::isLockUnlockPair(CallInst *lockCall, InvokeInst *otherInvoke, AliasAnalysis &AA) {
+bool StdLockUnlockPairs::isLockUnlockPair(CallInst *lockCall, InvokeInst *otherInvoke, AliasAnalysis &AA) {
     if (lockCall->getNumArgOperands() < 1) {
         errs() << "Warning: found a pthread or std::mutex call with < 1 operand, skipping\n";
         return false;
@@ -391,7 +411,7 @@ bool LockUnlockPairs::isLockUnlockPair(CallInst *lockCall, InvokeInst *otherInvo
     return isLockUnlockPair(lockFunc, otherFunc, AA, mut1, mut2);
 }
 
-bool LockUnlockPairs::isLockUnlockPair(InvokeInst *lockInvoke, CallInst *otherCall, AliasAnalysis &AA) {
+bool StdLockUnlockPairs::isLockUnlockPair(InvokeInst *lockInvoke, CallInst *otherCall, AliasAnalysis &AA) {
     if (lockInvoke->getNumArgOperands() < 1) {
         errs() << "Warning: found a pthread or std::mutex call with < 1 operand, skipping\n";
         return false;
@@ -413,104 +433,48 @@ bool LockUnlockPairs::isLockUnlockPair(InvokeInst *lockInvoke, CallInst *otherCa
     return isLockUnlockPair(lockFunc, otherFunc, AA, mut1, mut2);
 }
 
-unsigned LockUnlockPairs::getNumPairs() const {
-    int ret;
-    ret = 0;
-    ret += CallCallPairs.size();
-    ret += CallInvokePairs.size();
-    ret += InvokeCallPairs.size();
-    ret += InvokeInvokePairs.size();
-
-    return ret;
+unsigned StdLockUnlockPairs::getNumPairs() const {
+    return pairs.size();
 }
 
-unsigned LockUnlockPairs::getNumCallCallPairs() const {
-    return CallCallPairs.size();
+unsigned StdLockUnlockPairs::getNumCallCallPairs() const {
+    return pairs.getNumOfKind(PairTable::CallCall);
 }
-unsigned LockUnlockPairs::getNumCallInvokePairs() const {
-    return CallInvokePairs.size();
+unsigned StdLockUnlockPairs::getNumCallInvokePairs() const {
+    return pairs.getNumOfKind(PairTable::CallInvoke);
 }
-unsigned LockUnlockPairs::getNumInvokeCallPairs() const {
-    return InvokeCallPairs.size();
+unsigned StdLockUnlockPairs::getNumInvokeCallPairs() const {
+    return pairs.getNumOfKind(PairTable::InvokeCall);
 }
 
-unsigned LockUnlockPairs::getNumInvokeInvokePairs() const {
-    return InvokeInvokePairs.size();
+unsigned StdLockUnlockPairs::getNumInvokeInvokePairs() const {
+    return pairs.getNumOfKind(PairTable::InvokeInvoke);
 }
 
-void LockUnlockPairs::printDebugInfo() const {
-    for (unsigned i = 0; i < CallCallPairs.size(); i++) {
-        CallCallLockPair *curPair;
-        CallInst *lockCall;
-        CallInst *unlockCall;
-        Function *parent;
-
-        curPair = CallCallPairs[i];
-        lockCall = curPair->lockCall;
-        unlockCall = curPair->unlockCall;
-
-        parent = lockCall->getParent()->getParent();
-        errs() << parent->getName() << '\t' << 0 << '\t' << i << '\n';
-        errs() << '\t' << *lockCall << '\n';
-        errs() << '\t' << *unlockCall << '\n';
-
-
-        printDebugInfo(lockCall, unlockCall);
-    }
-    for (unsigned i = 0; i < CallInvokePairs.size(); i++) {
-        CallInvokeLockPair *curPair;
-        CallInst *lockCall;
-        InvokeInst *unlockInvoke;
-        Function *parent;
-
-        curPair = CallInvokePairs[i];
-        lockCall = curPair->lockCall;
-        unlockInvoke = curPair->unlockInvoke;
-
-        parent = lockCall->getParent()->getParent();
-        errs() << parent->getName() << '\t' << 1 << '\t' << i << '\n';
-        errs() << '\t' << *lockCall << '\n';
-        errs() << '\t' << *unlockInvoke << '\n';
-
-        printDebugInfo(lockCall, unlockInvoke);
-    }
-    for (unsigned i = 0; i < InvokeCallPairs.size(); i++) {
-        InvokeCallLockPair *curPair;
-        InvokeInst *lockInvoke;
-        CallInst *unlockCall;
-        Function *parent;
-
-        curPair = InvokeCallPairs[i];
-        lockInvoke = curPair->lockInvoke;
-        unlockCall = curPair->unlockCall;
-
-        parent = lockInvoke->getParent()->getParent();
-        errs() << parent->getName() << '\t' << 2 << '\t' << i << '\n';
-        errs() << '\t' << *lockInvoke << '\n';
-        errs() << '\t' << *unlockCall << '\n';
-        
-        printDebugInfo(lockInvoke, unlockCall);
-    }
-    for (unsigned i = 0; i < InvokeInvokePairs.size(); i++) {
-        InvokeInvokeLockPair *curPair;
-        InvokeInst *lockInvoke;
-        InvokeInst *unlockInvoke;
-        Function *parent;
-
-        curPair = InvokeInvokePairs[i];
-        lockInvoke = curPair->lockInvoke;
-        unlockInvoke = curPair->unlockInvoke;
-
-        parent = lockInvoke->getParent()->getParent();
-        errs() << parent->getName() << 3 << '\t' << i << '\n';
-        errs() << '\t' << *lockInvoke << '\n';
-        errs() << '\t' << *unlockInvoke << '\n';
-
-        printDebugInfo(lockInvoke, unlockInvoke);
+void StdLockUnlockPairs::printDebugInfo() const {
+    // Output is grouped by kind, the same order as the indices used by -pos
+    for (unsigned kind = 0; kind < PairTable::NumKinds; kind++) {
+        for (unsigned i = 0; i < pairs.getNumOfKind(kind); i++) {
+            Instruction *lockCall;
+            Instruction *unlockCall;
+            Function *parent;
+            int index;
+
+            index = pairs.lookupByKind(kind, i);
+            lockCall = pairs.getLock(index);
+            unlockCall = pairs.getUnlock(index);
+
+            parent = lockCall->getParent()->getParent();
+            errs() << parent->getName() << '\t' << kind << '\t' << i << '\n';
+            errs() << '\t' << *lockCall << '\n';
+            errs() << '\t' << *unlockCall << '\n';
+
+            printDebugInfo(lockCall, unlockCall);
+        }
     }
 }
 
-int LockUnlockPairs::calcDistanceBetween(Instruction *inst1, Instruction *inst2) const {
+int StdLockUnlockPairs::calcDistanceBetween(Instruction *inst1, Instruction *inst2) const {
     // Check that the instructions are from the same function
     if (inst1->getParent()->getParent() != inst2->getParent()->getParent()) {
 	errs() << "Warning: unable to calculate the distance between two "
@@ -537,7 +501,7 @@ int LockUnlockPairs::calcDistanceBetween(Instruction *inst1, Instruction *inst2)
     return distance;
 }
 
-void LockUnlockPairs::printDebugInfo(Instruction *lockCall, Instruction *unlockCall) const {
+void StdLockUnlockPairs::printDebugInfo(Instruction *lockCall, Instruction *unlockCall) const {
     // Lock call filename and line number
     StringRef fileName1 = getDebugFilename(lockCall);
     unsigned lineNum1 = getDebugLineNum(lockCall);
@@ -581,38 +545,10 @@ void LockUnlockPairs::printDebugInfo(Instruction *lockCall, Instruction *unlockC
     }
 }
 
-LockUnlockPairs::CallCallLockPair *LockUnlockPairs::getCallCallPair(unsigned index) {
-    if (index < CallCallPairs.size()) {
-        return CallCallPairs[index];
-    }
-    else {
-        return NULL;
-    }
-}
-
-LockUnlockPairs::CallInvokeLockPair *LockUnlockPairs::getCallInvokePair(unsigned index) {
-    if (index < CallInvokePairs.size()) {
-        return CallInvokePairs[index];
-    }
-    else {
-        return NULL;
-    }
-}
-
-LockUnlockPairs::InvokeCallLockPair *LockUnlockPairs::getInvokeCallPair(unsigned index) {
-    if (index < InvokeCallPairs.size()) {
-        return InvokeCallPairs[index];
-    }
-    else {
-        return NULL;
-    }
+int StdLockUnlockPairs::getPairIndex(unsigned kind, unsigned index) const {
+    return pairs.lookupByKind(kind, index);
 }
 
-LockUnlockPairs::InvokeInvokeLockPair *LockUnlockPairs::getInvokeInvokePair(unsigned index) {
-    if (index < InvokeInvokePairs.size()) {
-        return InvokeInvokePairs[index];
-    }
-    else {
-        return NULL;
-    }
+const PairTable &StdLockUnlockPairs::getPairs() const {
+    return pairs;
 }
@@ -2,45 +2,42 @@
  * This file is distributed under the University of Illinois Open Source
  * License. See LICENSE for details.
  *
- * \file LockUnlockPairs
+ * \file StdLockUnlockPairs.h
  * \author Markus Kusano
  * 2013-04-01
  *
  * Finds function local std::mutex::lock and std::mutex::unlock calls. Requires
  * alias analysis information to be provided.
+ *
+ * The pairs are kept in a PairTable. A pair is addressed by its kind (whether
+ * the lock and unlock are CallInsts or InvokeInsts, see PairTable::PairKind)
+ * and its index among the pairs of that kind.
+ *
+ * Tools/LockUnlockPairs.h is the pthread counterpart used by PosixLock. The
+ * two have different names so both can be linked into the combined plugin.
  */
 #pragma once
 
+#include "../Tools/PairTable.h"
+#include "../Tools/ProgramOrder.h"
+#include "../Tools/SiteCatalog.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Module.h"
 
+#include <vector>
+
 using namespace llvm;
 
-class LockUnlockPairs {
+class StdLockUnlockPairs {
     public:
-        // Sadly it doesn't seem that CallInst and InvokeInst have a parent
-        // class with enough functionality to perform mutations.
-        struct CallCallLockPair {
-            CallInst *lockCall;
-            CallInst *unlockCall;
-        };
-        struct CallInvokeLockPair {
-            CallInst *lockCall;
-            InvokeInst *unlockInvoke;
-        };
-        struct InvokeInvokeLockPair {
-            InvokeInst *lockInvoke;
-            InvokeInst *unlockInvoke;
-        };
-        struct InvokeCallLockPair {
-            InvokeInst *lockInvoke;
-            CallInst *unlockCall;
-        };
-
         /// Finds lock unlock pairs for the passed module using the passed
         /// AliasAnalysis for find pairs.
         void enumerate(Module &M, AliasAnalysis &AA);
 
+        /// Same as enumerate(M, AA) but takes the lock and unlock calls from
+        /// a SiteCatalog instead of looking for them.
+        void enumerate(const SiteCatalog &catalog, AliasAnalysis &AA);
+
         /// returns the total number of pairs found
         unsigned getNumPairs() const;
 
@@ -57,14 +54,22 @@ class LockUnlockPairs {
 	/// positive distance between the two instructions.
 	int calcDistanceBetween(Instruction *inst1, Instruction *inst2) const;
 
-        // Obtains the callcall pair, or null if index is out of bounds
-        CallCallLockPair *getCallCallPair(unsigned index);
-        CallInvokeLockPair *getCallInvokePair(unsigned index);
-        InvokeCallLockPair *getInvokeCallPair(unsigned index);
-        InvokeInvokeLockPair *getInvokeInvokePair(unsigned index);
+        /// Returns the index in getPairs() of the index'th pair of the
+        /// passed kind (see PairTable::PairKind). Returns -1 if either value
+        /// is out of bounds.
+        int getPairIndex(unsigned kind, unsigned index) const;
+
+        /// Table of every pair found
+        const PairTable &getPairs() const;
 
 
     private:
+        // Groups the lock and unlock calls (both in program order) by
+        // function and fills the pair table
+        void enumerateSites(std::vector<CallInst *> &mutexCalls,
+                std::vector<InvokeInst *> &mutexInvokes, ProgramOrder &PO,
+                AliasAnalysis &AA);
+
         // Returns true if the func is a lock or unlock call to either
         // std::mutex to pthread_mutex_t (ie it is a function call we are
         // interested in). 
@@ -80,8 +85,11 @@ class LockUnlockPairs {
         // InvokePairs vector.
         //void findInvokePairs(std::vector<InvokeInst *> &calls, AliasAnalysis &AA);
 
-        void findPairs(std::vector<CallInst *> &calls, std::vector<InvokeInst *> &invokes, 
-                AliasAnalysis &AA);
+        // Finds the pairs in one function. calls and invokes are all the
+        // lock and unlock sites of the function, funcIndex is the index of
+        // the function among the functions with sites.
+        void findPairs(CallInst **calls, unsigned numCalls, InvokeInst **invokes,
+                unsigned numInvokes, unsigned funcIndex, AliasAnalysis &AA);
 
         // Checks if the passed otherFunc is a matching unlock call to
         // lockFunc. It is a match if otherFunc is an unlock call, is from the
@@ -102,9 +110,6 @@ class LockUnlockPairs {
         // instructions.
         void printDebugInfo(Instruction *lockCall, Instruction *unlockCall) const;
 
-        // Vector of pairs of CallInsts to lock/unlock calls
-        std::vector<CallCallLockPair *> CallCallPairs;
-        std::vector<CallInvokeLockPair *> CallInvokePairs;
-        std::vector<InvokeCallLockPair *> InvokeCallPairs;
-        std::vector<InvokeInvokeLockPair *> InvokeInvokePairs;
+        // Every pair of lock/unlock calls
+        PairTable pairs;
 };
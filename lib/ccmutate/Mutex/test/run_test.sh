@@ -17,6 +17,40 @@ opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName <test.bc
 echo "END TEST: Find non verbose"
 echo " "
 
+echo "BEGIN TEST: Find legal shift and split offsets"
+opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName -offsets <test.bc >/dev/null
+echo "END TEST"
+echo " "
+
+# combinations is built in the top level combinations directory
+combo="../../../../combinations/combinations"
+
+echo "BEGIN TEST: Find conflicting pairs, then pick two pairs of kind 0 without a conflict"
+opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName -conflicts <test.bc 2>conflicts.txt >/dev/null
+cat conflicts.txt
+npairs=`opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName <test.bc 2>&1 >/dev/null | awk '$1 == 0 { print $2 }'`
+$combo -g conflicts.txt -p 0 -k 2 "$((npairs - 1))"
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: Pick two pairs of kind 0 for -swap, only shared conflicts (nested pairs allowed)"
+awk -F'\t' '$4 == "shared"' conflicts.txt >swap_conflicts.txt
+cat swap_conflicts.txt
+$combo -g swap_conflicts.txt -p 0 -k 2 "$((npairs - 1))"
+rm conflicts.txt swap_conflicts.txt
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: Find the features of each pair (header then one line per pair)"
+opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName -features <test.bc >/dev/null
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: features and a mutation mode (should fail)"
+opt -basicaa -load "$llvmlibdir"/"$testLibName" -$libraryName -features -rm -pos=0,0 <test.bc >/dev/null
+echo "END TEST"
+echo " "
+
 #echo "BEGIN TEST: Find verbose"
 #$opt -basicaa -analyze -debug -load "$llvmlibdir"/"$testLibName" -$libraryName -verbose <test.bc >/dev/null
 #echo "END TEST: Find verbose"
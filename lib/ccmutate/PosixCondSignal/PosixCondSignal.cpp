@@ -17,29 +17,32 @@
 #include "llvm/Support/CommandLine.h"
 
 #include "../Tools/EnumerateCallInst.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/SiteCatalog.h"
+#include "../Tools/OperatorOption.h"
 
 using namespace llvm;
 
 //#define MUT_DEBUG
 
 static cl::opt<bool> 
-    verbose("verbose", 
+    verbose(MUTATE_OPT("verbose"), 
 	cl::desc("Enable verbose output. "
 	    "Displays filename and location of occurances"),
 	cl::init(false));
 
 // Specifies if we are in remove mode
-static cl::opt<bool> rmMode("rm", 
+static cl::opt<bool> rmMode(MUTATE_OPT("rm"), 
 	cl::desc("remove occurances of posix_cond_signal"),
 	cl::init(false));
 
 // Specifies if we are in replace mode
-static cl::opt<bool> repMode("repmode", 
+static cl::opt<bool> repMode(MUTATE_OPT("repmode"), 
 	cl::desc("replace occurance of pthread_cond_signal with pthread_cond_broadcast "
 		    "or vice versa"),
 	cl::init(false));
 
-static cl::list<unsigned> PosToRm("pos", 
+static cl::list<unsigned> PosToRm(MUTATE_OPT("pos"), 
 	cl::desc("occurances to remove or replace"),
 	cl::value_desc("comma seperated list of occurances to alter"),
 	cl::CommaSeparated);
@@ -50,15 +53,23 @@ namespace {
     PosixCondSignal() : ModulePass(ID) { numCalls = 0; }
 
     EnumerateCallInst sigVis;
+    MutantVerifier verifier;
 
     unsigned numCalls;
 
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+	AU.addRequired<SiteCatalog>();
+	if (!rmMode && !repMode) {
+	    AU.setPreservesAll(); // only analyzing
+	}
+    }
+
     virtual bool runOnModule(Module &M) {
 	//errs() << "Mutate Posix Signal\n";
 	sigVis.addFuncNameToSearch("pthread_cond_broadcast");
 	sigVis.addFuncNameToSearch("pthread_cond_signal");
 
-	sigVis.visit(M);
+	sigVis.enumerate(getAnalysis<SiteCatalog>(), M);
 	numCalls = sigVis.callInsts.size();
 
 	bool modified;
@@ -170,6 +181,10 @@ namespace {
 	    }
 	}
 
+	if (modified) {
+	    verifier.touch(sigVis.getMutatedFunctions());
+	    verifier.check(M, "PosixCondSignal");
+	}
 	return modified;
     }
 
@@ -20,6 +20,8 @@
 #include "llvm/IRBuilder.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "../Tools/EnumerateCallInst.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/OperatorOption.h"
 
 #define MUT_DEBUG
 
@@ -38,7 +40,7 @@ using namespace llvm;
 
 /// Command line option: specify if we should remove occurrences specified with
 /// -pos. Defaults to false. \sa MutatePos
-static cl::opt<bool> rmMode("rm", 
+static cl::opt<bool> rmMode(MUTATE_OPT("rm"), 
 	cl::desc("remove occurrences specified by -pos"),
 	cl::init(false));
 
@@ -51,14 +53,14 @@ static cl::opt<bool> rmMode("rm",
 ///
 /// \sa MutatePos 
 /// \sa ModVal
-static cl::opt<bool> TimeMod("tmod", 
+static cl::opt<bool> TimeMod(MUTATE_OPT("tmod"), 
 	cl::desc("modify wait value of occurrences specified by -val"),
 	cl::init(false));
 
 /// Command line option: Comma separated list of positions to mutate. The list
 /// is zero indexted (the first position is zero). \sa rmMode.
 /// Note: -pos 0 -pos 3 is equivalent to -pos=0,3
-static cl::list<unsigned> MutatePos("pos",
+static cl::list<unsigned> MutatePos(MUTATE_OPT("pos"),
 	cl::desc("occurances to mutate"),
 	cl::value_desc("comma separated list of occurances to mutate"),
 	cl::CommaSeparated);
@@ -68,7 +70,7 @@ static cl::list<unsigned> MutatePos("pos",
 /// the value used for the 0th instruction specified by -pos. If this list is
 /// shorter than -pos then the last value in the list will be used for the
 /// remaining positions to modify.
-static cl::list<int> NsecModVal("nsecval",
+static cl::list<int> NsecModVal(MUTATE_OPT("nsecval"),
 	cl::desc("modify values"),
 	cl::value_desc("comma separated list of values to use"),
 	cl::CommaSeparated);
@@ -78,7 +80,7 @@ static cl::list<int> NsecModVal("nsecval",
 /// the value used for the 0th instruction specified by -pos. If this list is
 /// shorter than -pos then the last value in the list will be used for the
 /// remaining positions to modify.
-static cl::list<int> SecModVal("secval",
+static cl::list<int> SecModVal(MUTATE_OPT("secval"),
 	cl::desc("modify values"),
 	cl::value_desc("comma separated list of values to use"),
 	cl::CommaSeparated);
@@ -89,7 +91,7 @@ static cl::list<int> SecModVal("secval",
 /// code is inserted before the specified instruction. If this list is shorter
 /// than -pos then the last value in the list will be used for the remaining
 /// position to modify.
-static cl::list<unsigned> InsertPoint("inspt",
+static cl::list<unsigned> InsertPoint(MUTATE_OPT("inspt"),
 	cl::desc("relative point to insert mutation code"),
 	cl::value_desc("comma separated list of ints"),
 	cl::CommaSeparated);
@@ -102,19 +104,19 @@ static cl::list<unsigned> InsertPoint("inspt",
 /// to false. 
 ///
 /// \sa rmMode
-static cl::opt<bool> verbose("verbose",
+static cl::opt<bool> verbose(MUTATE_OPT("verbose"),
 	cl::desc("enable verbose output, displays filename/linenumber info"),
 	cl::init(false));
 
 /// Command line option: Tells the pass to switch calls specified with -pos
 /// from timedwait to wait. The converse (wait to timedwait) is not implemented
 /// yet.
-static cl::opt<bool> switchMode("switch",
+static cl::opt<bool> switchMode(MUTATE_OPT("switch"),
 	cl::desc("switch calls to timedwait to wait"),
 	cl::init(false));
 
 /// Verifies command line arguments are valid
-void checkCommandLineArgs();
+static void checkCommandLineArgs();
 
 /// Obtains the next second mutate and nsec mutate values from the nsecval and
 /// secval lists.
@@ -123,14 +125,14 @@ void checkCommandLineArgs();
 /// \param timedWait the call to pthread_cond_timedwait
 /// \param pos next position being mutated
 /// \return Instruction of the next insertion point
-Instruction *getNextMutateVals(int &secVal, int &nsecVal, CallInst *timedWait, unsigned pos);
+static Instruction *getNextMutateVals(int &secVal, int &nsecVal, CallInst *timedWait, unsigned pos);
 
 /// Returns an instruction poitner that corresponds to the val'th instruction
 /// in the passed function. 
 /// \param F function to iterate over
 /// \param val number of times to move the inst_iterator
 /// \return Instruction* 
-Instruction *getInstFromFunction(Function *F, unsigned val);
+static Instruction *getInstFromFunction(Function *F, unsigned val);
 
 void checkCommandLineArgs() {
     // Both verbose and rm should not be specified together
@@ -259,6 +261,7 @@ struct PosixCondWait : public ModulePass {
     PosixCondWait() : ModulePass(ID) { }
 
     EnumerateCallInst eci;
+    MutantVerifier verifier;
 
     virtual bool runOnModule(Module &M) {
 	checkCommandLineArgs();
@@ -266,7 +269,7 @@ struct PosixCondWait : public ModulePass {
 	// Enumerate instances of call instructions to mutate
 	eci.addFuncNameToSearch("pthread_cond_wait");
 	eci.addFuncNameToSearch("pthread_cond_timedwait");
-	eci.visit(M);
+	eci.enumerate(M);
 
 	if (!rmMode && !TimeMod &&!switchMode) {
 	    modified = false; // implicit print mode
@@ -308,6 +311,7 @@ struct PosixCondWait : public ModulePass {
 		int nsecMod;
 		CallInst *curInst = eci.callInsts[posToMod];
 		Instruction *insPoint;
+		verifier.touch(curInst);
 		insPoint = getNextMutateVals(secMod, nsecMod, curInst, MutatePos[i]);
 
 		if (curInst->getCalledFunction()->getName() == "pthread_cond_timedwait") {
@@ -383,6 +387,7 @@ struct PosixCondWait : public ModulePass {
 		}
 
 		CallInst *curCall = eci.callInsts[posToMod];
+		verifier.touch(curCall);
 		Function *curFunc = curCall->getCalledFunction();
 
 		if (!curFunc) {
@@ -424,6 +429,10 @@ struct PosixCondWait : public ModulePass {
 	    }
 	}
 
+	if (modified) {
+	    verifier.touch(eci.getMutatedFunctions());
+	    verifier.check(M, "PosixCondWait");
+	}
 	return modified;
     }
 
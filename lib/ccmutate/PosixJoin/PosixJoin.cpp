@@ -19,6 +19,9 @@
 
 //#include "FindPosixJoinVisitor.h"
 #include "../Tools/EnumerateCallInst.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/SiteCatalog.h"
+#include "../Tools/OperatorOption.h"
 
 #define MUT_DEBUG
 
@@ -26,18 +29,18 @@ using namespace llvm;
 
 // Command line flags
 static cl::opt<bool> 
-    verbose("v", 
+    verbose(MUTATE_OPT("v"), 
 	cl::desc("Enable verbose output. "
 	    "Displays filename and location of occurances"),
 	cl::init(false));
 
 // Specifies if we are in remove mode
-static cl::opt<bool> rmMode("rmmode", 
+static cl::opt<bool> rmMode(MUTATE_OPT("rmmode"), 
 	cl::desc("remove occurances of pthread_join"),
 	cl::init(false));
 
 // Specifies if we are in replace join with sleep mode
-static cl::opt<bool> repMode("repmode", 
+static cl::opt<bool> repMode(MUTATE_OPT("repmode"), 
 	cl::desc("replace occurance of pthread_join with sleep"),
 	cl::init(false));
 
@@ -45,12 +48,12 @@ static cl::opt<bool> repMode("repmode",
 // removed. Use the analysis FindPosixJoin to get the enumeration. Specify a
 // comma seperated list of 0 indexed values (e.g. -pos=1,3,4) which will
 // remove occurances 1, 3 and 4.
-static cl::list<unsigned> PosToRm("pos", 
+static cl::list<unsigned> PosToRm(MUTATE_OPT("pos"), 
 	cl::desc("occurances to remove or replace with sleep"),
 	cl::value_desc("comma seperated list of occurances to alter"),
 	cl::CommaSeparated);
 
-static cl::opt<unsigned> SleepValue("sleepval",
+static cl::opt<unsigned> SleepValue(MUTATE_OPT("sleepval"),
 	cl::desc("value to be passed to call to sleep, default is 1"),
 	cl::value_desc("positive integer"),
 	cl::init(1));
@@ -64,12 +67,20 @@ namespace {
      * Visitor to find CallInst to pthread_join
      */
     EnumerateCallInst pjv;
+    MutantVerifier verifier;
 
     /**
      * Number of calls to pthread_join found
      */
     unsigned numCalls;
 
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+	AU.addRequired<SiteCatalog>();
+	if (!rmMode && !repMode) {
+	    AU.setPreservesAll(); // only analyzing
+	}
+    }
+
     /**
      * Uses a FindPosixJoinVisitor to find occurances of CallInst to
      * pthread_join
@@ -77,7 +88,7 @@ namespace {
     virtual bool runOnModule(Module &M) {
 	errs() << "FindPosixJoin: \n";
 	pjv.addFuncNameToSearch("pthread_join");
-	pjv.visit(M);
+	pjv.enumerate(getAnalysis<SiteCatalog>(), M);
 
 #ifdef MUT_DEBUG
 	DEBUG(errs() << "DEBUG: Found " << pjv.callInsts.size()
@@ -183,6 +194,10 @@ namespace {
 	// Use print method (-print) to display the results
 	//errs() << numCalls << '\n';
 
+	if (modified) {
+	    verifier.touch(pjv.getMutatedFunctions());
+	    verifier.check(M, "PosixJoin");
+	}
 	return modified;
     }
 
@@ -20,6 +20,9 @@
 #include "llvm/Support/InstIterator.h"
 
 #include "../Tools/LockUnlockPairs.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/LegalOffsets.h"
+#include "../Tools/OperatorOption.h"
 
 #include <algorithm> // std::sort and std::unique
 
@@ -33,18 +36,18 @@ using namespace llvm;
 /// Defaults to false
 ///
 /// \sa rmMode
-static cl::opt<bool> verbose("verbose",
+static cl::opt<bool> verbose(MUTATE_OPT("verbose"),
 	cl::desc("enable verbose output, displays filename/linenumber info"),
 	cl::init(false));
 
 /// Command line option: the pass will remove pairs specified by -pos
-static cl::opt<bool> rmMode("rm",
+static cl::opt<bool> rmMode(MUTATE_OPT("rm"),
 	cl::desc("enable remove mode, remove lock unlock pair specified by pos\n"),
 	cl::init(false));
 
 /// Command line option: the pass will swap pairs specified by -pos. This
 /// requires atleast 4 values to be speciied in -pos
-static cl::opt<bool> swapMode("swap",
+static cl::opt<bool> swapMode(MUTATE_OPT("swap"),
 	cl::desc("enable swap mode, swap lock unlock pairs specified by pos\n"),
 	cl::init(false));
 
@@ -53,7 +56,7 @@ static cl::opt<bool> swapMode("swap",
 /// the first one is the function index and the second is the pair. For example
 /// -pos=1,2 -pos=0,7 will specify function 1 pair 2 and function 0 pair 7 to
 /// be mutated. This is equivalent to -pos=1,2,0,7.
-static cl::list<unsigned> MutatePos("pos",
+static cl::list<unsigned> MutatePos(MUTATE_OPT("pos"),
 	cl::desc("occurances to mutate"),
 	cl::value_desc("comma separated list of occurances to mutate"),
 	cl::CommaSeparated);
@@ -61,7 +64,7 @@ static cl::list<unsigned> MutatePos("pos",
 /// Command line option: enables shift mode. This allows -lockdir and
 /// -unlockdir to be used in conjunction with -pos to shift pairs arbitrary
 /// amounts.
-static cl::opt<bool> shiftMode("shift",
+static cl::opt<bool> shiftMode(MUTATE_OPT("shift"),
 	cl::desc("enable shift mode, shift lock and unlock calls"),
 	cl::init(false));
 
@@ -71,7 +74,7 @@ static cl::opt<bool> shiftMode("shift",
 /// Each index in this list corresponds to a pair specified by -pos. If no
 /// value is specified for a pair (ie this list is shorter than -pos) then 0 is
 /// used.
-static cl::list<int> LockDir("lockdir",
+static cl::list<int> LockDir(MUTATE_OPT("lockdir"),
 	cl::desc("direction to shift lock call"),
 	cl::value_desc("comma separated list of directions for each mutation position"),
 	cl::CommaSeparated);
@@ -82,7 +85,7 @@ static cl::list<int> LockDir("lockdir",
 /// Each index in this list corresponds to a pair specified by -pos. If no
 /// value is specified for a pair (ie this list is shorter than -pos) then 0 is
 /// used.
-static cl::list<int> UnlockDir("unlockdir",
+static cl::list<int> UnlockDir(MUTATE_OPT("unlockdir"),
 	cl::desc("direction to shift unlock call"),
 	cl::value_desc("comma separated list of directions for each mutation position"),
 	cl::CommaSeparated);
@@ -93,7 +96,7 @@ static cl::list<int> UnlockDir("unlockdir",
 /// relative to the lock call in which the additional unlock and lock cal
 /// should be inserted. -splitpos=3,7 inserts a call to unlock 3 instructions
 /// down and a call to lock 7 instructions down.
-static cl::list<unsigned> SplitPos("splitpos",
+static cl::list<unsigned> SplitPos(MUTATE_OPT("splitpos"),
 	cl::desc("relative position to insert unlock and lock call to split a pair"),
 	cl::value_desc("comma separated list of pairs for each mutation position"),
 	cl::CommaSeparated);
@@ -101,10 +104,17 @@ static cl::list<unsigned> SplitPos("splitpos",
 /// Command line option: used to specify that the pass should split a
 /// lock-unlock pair. Pairs are specified with -pos and the split points are
 /// specified with -splitpos
-static cl::opt<bool> splitMode("split",
+static cl::opt<bool> splitMode(MUTATE_OPT("split"),
 	cl::desc("enable split mode, split a lock and unlock pair"),
 	cl::init(false));
 
+/// Command line option: with -analyze, list the -lockdir, -unlockdir and
+/// -splitpos values of each pair that produce a valid mutant different from
+/// the other listed values (see LegalOffsets.h)
+static cl::opt<bool> offsetsMode(MUTATE_OPT("offsets"),
+	cl::desc("list the legal shift and split offsets of each pair"),
+	cl::init(false));
+
 
 namespace {
 struct RmLockPair : public ModulePass {
@@ -114,6 +124,13 @@ struct RmLockPair : public ModulePass {
 
     LockUnlockPairs lockPairs;
 
+    // Checks the mutant before it is written
+    MutantVerifier verifier;
+
+    // Legal offsets of each pair, function by function, when -offsets is
+    // used
+    std::vector<LegalOffsets> offsets;
+
     // Vector of instructions to mutate. This is used with std::sort and
     // std::unique to keep only one occurrence of each instruction to be
     // mutated. This is done so that the same mutation operator is not
@@ -125,6 +142,9 @@ struct RmLockPair : public ModulePass {
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
 	AU.addRequired<AliasAnalysis>();
 	AU.addPreserved<AliasAnalysis>();
+	if (offsetsMode) {
+	    AU.addRequired<DominatorTree>();
+	}
     }
 
     virtual bool runOnModule(Module &M) {
@@ -136,24 +156,29 @@ struct RmLockPair : public ModulePass {
 
 	checkCommandLineArgs();
 
+	if (offsetsMode) {
+	    findOffsets();
+	}
+
 	if (rmMode) {
 #ifdef MUT_DEBUG
 	    errs() << "DEBUG: In rmMode\n";
 #endif
-	    LockUnlockPairs::lockUnlockPair *curPair;
+	    LockUnlockPairs::lockUnlockPair curPair;
 	    for (unsigned i = 0; i < MutatePos.size(); i += 2) {
 		curPair = lockPairs.getPair(MutatePos[i], MutatePos[i+1]);
-		if (!curPair) {
+		if (!curPair.lockCall) {
 		    errs() << "Warning: position pair (" << MutatePos[i] << ' '
 			   << MutatePos[i+1] << ") is out of bounds, skipping\n";
 		    continue;
 		}
+		verifier.touch(curPair.lockCall); // pairs are function local
 #ifdef MUT_DEBUG
-		errs() << "DEBUG: adding to remove: " << *(curPair->lockCall) << '\n';
-		errs() << "DEBUG: adding to remove: " << *(curPair->unlockCall) << '\n';
+		errs() << "DEBUG: adding to remove: " << *(curPair.lockCall) << '\n';
+		errs() << "DEBUG: adding to remove: " << *(curPair.unlockCall) << '\n';
 #endif
-		mutateInsts.insert(curPair->lockCall);
-		mutateInsts.insert(curPair->unlockCall);
+		mutateInsts.insert(curPair.lockCall);
+		mutateInsts.insert(curPair.unlockCall);
 	    }
 
 #ifdef MUT_DEBUG
@@ -181,34 +206,36 @@ struct RmLockPair : public ModulePass {
 #ifdef MUT_DEBUG
 	    errs() << "DEBUG: in swapMode\n";
 #endif
-	    LockUnlockPairs::lockUnlockPair *pair1;
-	    LockUnlockPairs::lockUnlockPair *pair2;
+	    LockUnlockPairs::lockUnlockPair pair1;
+	    LockUnlockPairs::lockUnlockPair pair2;
 	    for (unsigned i = 0; i < MutatePos.size(); i += 4) {
 		pair1 = lockPairs.getPair(MutatePos[i], MutatePos[i+1]);
 		pair2 = lockPairs.getPair(MutatePos[i+2], MutatePos[i+3]);
-		if (!pair1) {
+		if (!pair1.lockCall) {
 		    errs() << "Warning: position pair (" << MutatePos[i] << ' '
 			   << MutatePos[i+1] << ") is out of bounds, skipping\n";
 		    continue;
 		}
-		if (!pair2) {
+		verifier.touch(pair1.lockCall); // pairs are function local
+		if (!pair2.lockCall) {
 		    errs() << "Warning: position pair (" << MutatePos[i+2] << ' '
 			   << MutatePos[i+3] << ") is out of bounds, skipping\n";
 		    continue;
 		}
+		verifier.touch(pair2.lockCall);
 
 #ifdef MUT_DEBUG
 		errs() << "DEBUG: swapping:\n"
-		       << '\t' << *(pair1->lockCall) << '\n'
-		       << '\t' << *(pair1->unlockCall) << '\n'
+		       << '\t' << *(pair1.lockCall) << '\n'
+		       << '\t' << *(pair1.unlockCall) << '\n'
 		       << "with\n"
-		       << '\t' << *(pair2->lockCall) << '\n'
-		       << '\t' << *(pair2->unlockCall) << '\n';
+		       << '\t' << *(pair2.lockCall) << '\n'
+		       << '\t' << *(pair2.unlockCall) << '\n';
 #endif
 
 		// Check and see if the user is trying to swap a pair that
 		// stems from the same lock call
-		if (pair1->lockCall == pair2->lockCall) {
+		if (pair1.lockCall == pair2.lockCall) {
 		    errs() << "Warning: position pair (" << MutatePos[i] << ' '
 			   << MutatePos[i+1] << ") and position pair (" 
 			   << MutatePos[i+2] << ' ' << MutatePos[i+3] 
@@ -222,37 +249,37 @@ struct RmLockPair : public ModulePass {
 		CallInst *lock2;
 		CallInst *unlock2;
 
-		if (pair1->lockCall->getNumArgOperands() < 1) {
+		if (pair1.lockCall->getNumArgOperands() < 1) {
 		    errs() << "Warning: lock call found with less than one arg operand, skipping\n";
 		    continue;
 		}
-		if (pair1->unlockCall->getNumArgOperands() < 1) {
+		if (pair1.unlockCall->getNumArgOperands() < 1) {
 		    errs() << "Warning: unlock call found with less than one arg operand, skipping\n";
 		    continue;
 		}
-		if (pair2->lockCall->getNumArgOperands() < 1) {
+		if (pair2.lockCall->getNumArgOperands() < 1) {
 		    errs() << "Warning: lock call found with less than one arg operand, skipping\n";
 		    continue;
 		}
-		if (pair2->unlockCall->getNumArgOperands() < 1) {
+		if (pair2.unlockCall->getNumArgOperands() < 1) {
 		    errs() << "Warning: unlock call found with less than one arg operand, skipping\n";
 		    continue;
 		}
 
 		modified = true; 
 
-		ArrayRef<Value *> lock1Args(pair1->lockCall->getArgOperand(0));
-		ArrayRef<Value *> unlock1Args(pair1->unlockCall->getArgOperand(0));
-		ArrayRef<Value *> lock2Args(pair2->lockCall->getArgOperand(0));
-		ArrayRef<Value *> unlock2Args(pair2->unlockCall->getArgOperand(0));
+		ArrayRef<Value *> lock1Args(pair1.lockCall->getArgOperand(0));
+		ArrayRef<Value *> unlock1Args(pair1.unlockCall->getArgOperand(0));
+		ArrayRef<Value *> lock2Args(pair2.lockCall->getArgOperand(0));
+		ArrayRef<Value *> unlock2Args(pair2.unlockCall->getArgOperand(0));
 
-		lock1 = CallInst::Create(pair1->lockCall->getCalledFunction(), 
+		lock1 = CallInst::Create(pair1.lockCall->getCalledFunction(), 
 			    lock1Args, "mut_lock1");
-		unlock1 = CallInst::Create(pair1->unlockCall->getCalledFunction(), 
+		unlock1 = CallInst::Create(pair1.unlockCall->getCalledFunction(), 
 			    unlock1Args, "mut_unlock1");
-		lock2 = CallInst::Create(pair2->lockCall->getCalledFunction(), 
+		lock2 = CallInst::Create(pair2.lockCall->getCalledFunction(), 
 			    lock2Args, "mut_lock2");
-		unlock2 = CallInst::Create(pair2->unlockCall->getCalledFunction(), 
+		unlock2 = CallInst::Create(pair2.unlockCall->getCalledFunction(), 
 			    unlock2Args, "mut_unlock2");
 
 #ifdef MUT_DEBUG
@@ -264,20 +291,20 @@ struct RmLockPair : public ModulePass {
 		errs() << '\t' << *unlock2 << '\n';
 
 #endif
-		BasicBlock::iterator iter1(pair1->lockCall);
-		ReplaceInstWithInst(pair1->lockCall->getParent()->getInstList(),
+		BasicBlock::iterator iter1(pair1.lockCall);
+		ReplaceInstWithInst(pair1.lockCall->getParent()->getInstList(),
 			iter1, lock2);
 
-		BasicBlock::iterator iter2(pair1->unlockCall);
-		ReplaceInstWithInst(pair1->unlockCall->getParent()->getInstList(),
+		BasicBlock::iterator iter2(pair1.unlockCall);
+		ReplaceInstWithInst(pair1.unlockCall->getParent()->getInstList(),
 			iter2, unlock2);
 
-		BasicBlock::iterator iter3(pair2->lockCall);
-		ReplaceInstWithInst(pair2->lockCall->getParent()->getInstList(),
+		BasicBlock::iterator iter3(pair2.lockCall);
+		ReplaceInstWithInst(pair2.lockCall->getParent()->getInstList(),
 			iter3, lock1);
 
-		BasicBlock::iterator iter4(pair2->unlockCall);
-		ReplaceInstWithInst(pair2->unlockCall->getParent()->getInstList(),
+		BasicBlock::iterator iter4(pair2.unlockCall);
+		ReplaceInstWithInst(pair2.unlockCall->getParent()->getInstList(),
 			iter4, unlock1);
 	    } // end for
 	} // end else if
@@ -289,13 +316,14 @@ struct RmLockPair : public ModulePass {
 	    // checkCommandLineArgs() guarantees this will have atleast two
 	    // elements
 	    for (unsigned i = 0; i < MutatePos.size(); i += 2) {
-		LockUnlockPairs::lockUnlockPair *curPair;
+		LockUnlockPairs::lockUnlockPair curPair;
 		curPair = lockPairs.getPair(MutatePos[i], MutatePos[i+1]);
-		if (!curPair) {
+		if (!curPair.lockCall) {
 		    errs() << "Warning: position pair (" << MutatePos[i] << ' '
 			   << MutatePos[i+1] << ") is out of bounds, skipping\n";
 		    continue;
 		}
+		verifier.touch(curPair.lockCall); // pairs are function local
 
 		// Each element in LockDir and UnlockDir corresponds to one
 		// pair of items in MutatePos
@@ -306,7 +334,7 @@ struct RmLockPair : public ModulePass {
 			errs() << "Warning: a shift of positive 1 is a no-op\n";
 		    }
 		    else {
-			shiftCallInst(curPair->lockCall, shiftDir);
+			shiftCallInst(curPair.lockCall, shiftDir);
 		    }
 		}
 		else {
@@ -321,7 +349,7 @@ struct RmLockPair : public ModulePass {
 		    }
 		    else {
 			modified = true;
-			shiftCallInst(curPair->unlockCall, shiftDir);
+			shiftCallInst(curPair.unlockCall, shiftDir);
 		    }
 		}
 		else {
@@ -334,19 +362,20 @@ struct RmLockPair : public ModulePass {
 #ifdef MUT_DEBUG
 	    errs() << "DEBUG: in split mode\n";
 #endif
-	    LockUnlockPairs::lockUnlockPair *curPair;
+	    LockUnlockPairs::lockUnlockPair curPair;
 	    for (unsigned i = 0; i < MutatePos.size(); i +=2) {
 		curPair = lockPairs.getPair(MutatePos[i], MutatePos[i+1]);
-		if (!curPair) {
+		if (!curPair.lockCall) {
 		    errs() << "Warning: position pair (" << MutatePos[i] << ' '
 			   << MutatePos[i+1] << ") is out of bounds, skipping\n";
 		    continue;
 		}
+		verifier.touch(curPair.lockCall); // pairs are function local
 		int dist;
 		int unlockPos;
 		int lockPos;
 
-		dist = lockPairs.calcDistanceBetween(curPair->lockCall, curPair->unlockCall);
+		dist = lockPairs.calcDistanceBetween(curPair.lockCall, curPair.unlockCall);
 #ifdef MUT_DEBUG
 		errs() << "DEBUG: distance between pair == " << dist << '\n';
 #endif
@@ -385,12 +414,12 @@ struct RmLockPair : public ModulePass {
 #endif
 
 		// Create copies of the lock and unlock calls
-		if (curPair->lockCall->getNumArgOperands() < 1) {
+		if (curPair.lockCall->getNumArgOperands() < 1) {
 		    errs() << "Warning: encountered a lockCall with less than "
 			      "one argument operand, skipping\n";
 		    continue;
 		}
-		if (curPair->unlockCall->getNumArgOperands() < 1) {
+		if (curPair.unlockCall->getNumArgOperands() < 1) {
 		    errs() << "Warning: encountered an unlock call with less than "
 			      "one argument operand, skipping\n";
 		    continue;
@@ -398,30 +427,46 @@ struct RmLockPair : public ModulePass {
 		modified = true;
 		CallInst *lockCall;
 		CallInst *unlockCall;
-		ArrayRef<Value *> lockArgs(curPair->lockCall->getArgOperand(0));
-		ArrayRef<Value *> unlockArgs(curPair->unlockCall->getArgOperand(0));
+		ArrayRef<Value *> lockArgs(curPair.lockCall->getArgOperand(0));
+		ArrayRef<Value *> unlockArgs(curPair.unlockCall->getArgOperand(0));
 
-		lockCall = CallInst::Create(curPair->lockCall->getCalledFunction(), 
+		lockCall = CallInst::Create(curPair.lockCall->getCalledFunction(), 
 			    lockArgs, "mut_lockSplit");
-		unlockCall = CallInst::Create(curPair->unlockCall->getCalledFunction(), 
+		unlockCall = CallInst::Create(curPair.unlockCall->getCalledFunction(), 
 			    unlockArgs, "mut_unlockSplit");
 
 
-		insertInstructionRelative(curPair->lockCall, unlockCall, unlockPos);
+		insertInstructionRelative(curPair.lockCall, unlockCall, unlockPos);
 		if (unlockPos < lockPos) {
 		    // Add 1 to the lock position to account for the fact that
 		    // the unlock call was just inserted in its path
 		    lockPos += 1;
 		}
-		insertInstructionRelative(curPair->lockCall, lockCall, lockPos);
+		insertInstructionRelative(curPair.lockCall, lockCall, lockPos);
 	    }
 
 	}
 
+	if (modified) {
+	    verifier.check(M, "PosixLock");
+	}
 	return modified;
     }
 
     virtual void print(llvm::raw_ostream &O, const Module *M) const {
+	if (offsetsMode) {
+	    // <function index> <pair index> <offsets>
+	    unsigned next;
+	    next = 0;
+	    for (unsigned i = 0; i < lockPairs.getFuncsSize(); i++) {
+		for (unsigned j = 0; j < lockPairs.getPairsSizeAtFunc(i); j++) {
+		    errs() << i << '\t' << j << '\t';
+		    printLegalOffsets(errs(), offsets[next++]);
+		    errs() << '\n';
+		}
+	    }
+	    return;
+	}
 	if (!verbose) {
 	    errs() << lockPairs.getFuncsSize() << "\n";
 	    for (unsigned i = 0; i < lockPairs.getFuncsSize(); i++) {
@@ -459,6 +504,11 @@ struct RmLockPair : public ModulePass {
 	    errs() << "Error: -shift and -split cannot be specified at the same time\n";
 	    exit(EXIT_FAILURE);
 	}
+	if (offsetsMode && (rmMode || swapMode || shiftMode || splitMode)) {
+	    errs() << "Error: -offsets only lists offsets and cannot be used "
+		      "with a mutation\n";
+	    exit(EXIT_FAILURE);
+	}
 
 	if (rmMode) {
 	    if (MutatePos.size() == 0) {
@@ -612,6 +662,24 @@ struct RmLockPair : public ModulePass {
 	bb->getInstList().insert(&*iter, instCopy);
     }
 
+    // Fills offsets with the legal offsets of every pair
+    void findOffsets() {
+	offsets.clear();
+	for (unsigned i = 0; i < lockPairs.getFuncsSize(); i++) {
+	    if (lockPairs.getPairsSizeAtFunc(i) == 0) {
+		continue;
+	    }
+	    DominatorTree &DT = getAnalysis<DominatorTree>(*lockPairs.getFunc(i));
+	    for (unsigned j = 0; j < lockPairs.getPairsSizeAtFunc(i); j++) {
+		LockUnlockPairs::lockUnlockPair curPair;
+		curPair = lockPairs.getPair(i, j);
+		offsets.push_back(LegalOffsets());
+		findLegalOffsets(curPair.lockCall, curPair.unlockCall, DT,
+			offsets.back());
+	    }
+	}
+    }
+
     // Inserts insertMe before the instruction distance instructions from base
     void insertInstructionRelative(Instruction *base, Instruction *insertMe, unsigned distance) {
 	inst_iterator iter = inst_begin(base->getParent()->getParent());
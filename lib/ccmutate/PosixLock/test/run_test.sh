@@ -20,6 +20,11 @@ $opt -basicaa -analyze -debug -load "$llvmlibdir"/"$testLibName" -$libraryName -
 echo "END TEST: Find verbose"
 echo " "
 
+echo "BEGIN TEST: Find legal shift and split offsets"
+$opt -basicaa -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName -offsets <test_local.bc >/dev/null
+echo "END TEST"
+echo " "
+
 echo "BEGIN TEST: rmMode odd positions specified"
 $opt -basicaa -debug -load "$llvmlibdir"/"$testLibName" -$libraryName -rm -pos=0,1,7 <test_local.bc >/dev/null
 echo "END TEST"
@@ -16,25 +16,28 @@
 #include "llvm/DebugInfo.h"
 
 #include "../Tools/EnumerateCallInst.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/SiteCatalog.h"
+#include "../Tools/OperatorOption.h"
 
 using namespace llvm;
 
 /// boolean for verbose output control. Requires that the file be compiled with
 /// debugging metadata
-static cl::opt<bool> verbose("v", 
+static cl::opt<bool> verbose(MUTATE_OPT("v"), 
 	cl::desc("Enable verbose output. Display filename and line number of occurrences"),
 	cl::init(false));
 
-static cl::opt<bool> modify("mod", 
+static cl::opt<bool> modify(MUTATE_OPT("mod"), 
 	cl::desc("Enable modify mode"),
 	cl::init(false));
 
-static cl::list<unsigned> posToMod("pos",
+static cl::list<unsigned> posToMod(MUTATE_OPT("pos"),
 	cl::desc("Positions to modify"),
 	cl::value_desc("Comma seperated list of positions to modify"),
 	cl::CommaSeparated);
 
-static cl::list<unsigned> valToMod("val",
+static cl::list<unsigned> valToMod(MUTATE_OPT("val"),
 	cl::desc("Values to modify with"),
 	cl::value_desc("Comma seperated list of values to use to modify respective positions"),
 	cl::CommaSeparated);
@@ -63,6 +66,14 @@ namespace {
     mutate_PosixSema() : ModulePass(ID) { }
 
     EnumerateCallInst semVis;
+    MutantVerifier verifier;
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+	AU.addRequired<SiteCatalog>();
+	if (!modify) {
+	    AU.setPreservesAll(); // only analyzing
+	}
+    }
 
     virtual bool runOnModule(Module &M) {
 	bool modified;
@@ -73,7 +84,7 @@ namespace {
 	errs() << "mutate_PosixSema: \n";
 	semVis.addFuncNameToSearch("sem_open");
 	semVis.addFuncNameToSearch("sem_init");
-	semVis.visit(M);
+	semVis.enumerate(getAnalysis<SiteCatalog>(), M);
 	DEBUG(errs() << "DEBUG: Found " << semVis.callInsts.size()
 		     << " instances of calls to sema permit count modifying calls\n");
 
@@ -162,6 +173,10 @@ namespace {
 		}
 	    }
 	}
+	if (modified) {
+	    verifier.touch(semVis.getMutatedFunctions());
+	    verifier.check(M, "PosixSemaphore");
+	}
 	return modified;
     }
 
@@ -16,6 +16,9 @@
 #include "llvm/LLVMContext.h"
 
 #include "../Tools/EnumerateCallInst.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/SiteCatalog.h"
+#include "../Tools/OperatorOption.h"
 
 // Enable debugging messages
 #define MUT_DEBUG
@@ -27,14 +30,14 @@ using std::string;
 /// {sched,posix}_yield(). Positions to remove are specified with the `--pos`
 /// command line option. This defaults to false, the default operation of the
 /// is to print information about where occurances are.
-static cl::opt<bool> rmMode("rm", 
+static cl::opt<bool> rmMode(MUTATE_OPT("rm"), 
 	cl::desc("remove occurances specified by -pos"),
 	cl::init(false));
 
 /// Command line option: Comma separated list of positions to mutate. The list
 /// is zero indexted (the first position is zero). \sa rmMode.
 /// Note: -pos 0 -pos 3 is equivalent to -pos=0,3
-static cl::list<unsigned> MutatePos("pos",
+static cl::list<unsigned> MutatePos(MUTATE_OPT("pos"),
 	cl::desc("occurances to mutate"),
 	cl::value_desc("comma separated list of occurances to mutate"),
 	cl::CommaSeparated);
@@ -47,12 +50,12 @@ static cl::list<unsigned> MutatePos("pos",
 /// to false. 
 ///
 /// \sa rmMode
-static cl::opt<bool> verbose("verbose",
+static cl::opt<bool> verbose(MUTATE_OPT("verbose"),
 	cl::desc("enable verbose output, displays filename/linenumber info"),
 	cl::init(false));
 
 /// Checks if the commandline args are valid
-void checkCommandLineArgs();
+static void checkCommandLineArgs();
 
 void checkCommandLineArgs() {
     // Both verbose and rm should not be specified together
@@ -77,6 +80,14 @@ struct PosixYield : public ModulePass {
     PosixYield() : ModulePass(ID) { }
 
     EnumerateCallInst eci;
+    MutantVerifier verifier;
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+	AU.addRequired<SiteCatalog>();
+	if (!rmMode) {
+	    AU.setPreservesAll(); // only analyzing
+	}
+    }
 
     virtual bool runOnModule(Module &M) {
 	checkCommandLineArgs();
@@ -84,7 +95,7 @@ struct PosixYield : public ModulePass {
 	// Enumerate instances of posix_yield and sched_yield
 	eci.addFuncNameToSearch("pthread_yield");
 	eci.addFuncNameToSearch("sched_yield");
-	eci.visit(M);
+	eci.enumerate(getAnalysis<SiteCatalog>(), M);
 
 	if (!rmMode) {
 	    modified = false;
@@ -108,6 +119,10 @@ struct PosixYield : public ModulePass {
 		}
 	    }
 	}
+	if (modified) {
+	    verifier.touch(eci.getMutatedFunctions());
+	    verifier.check(M, "PosixYield");
+	}
 	return modified;
     }
 
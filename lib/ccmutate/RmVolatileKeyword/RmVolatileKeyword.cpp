@@ -14,6 +14,9 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/DebugInfo.h"
 #include "VolatileVisitor.h"
+#include "../Tools/ParallelVisit.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/OperatorOption.h"
 #include "llvm/Support/CommandLine.h"
 
 using namespace llvm;
@@ -21,21 +24,22 @@ using namespace llvm;
 
 // Specifies verbose output
 static cl::opt<bool> 
-    verbose("v", 
+    verbose(MUTATE_OPT("v"), 
 	cl::desc("Enable verbose output."),
 	cl::init(false));
 
 // Specifies occurances to remove, e.g. -rmpos=1,2,3 which is equivalant to
 // -rmpos=1 -rmpos=2 -rmpos=3.
-static cl::list<unsigned> PosToRm("rmpos", 
+static cl::list<unsigned> PosToRm(MUTATE_OPT("rmpos"), 
 	cl::desc("occurances to remove"),
 	cl::value_desc("comma seperated list of occurances to remove"),
 	cl::CommaSeparated, cl::ZeroOrMore);
 
+// Number of threads used to find volatile instructions
 /// Sets the passed instruction as non-volatile if it is a LoadInst,
 /// StoreInst, AtomicCmpXchgInst, AtomicRMWInst, or llvm.{memcpy, memmove,
 /// memset}
-bool removeVolatile(Instruction *I);
+static bool removeVolatile(Instruction *I);
 
 namespace {
 struct RmVolatileKeyword : public ModulePass {
@@ -43,6 +47,9 @@ struct RmVolatileKeyword : public ModulePass {
 
     VolatileVisitor volVis;
 
+    /// Checks the mutant before it is written
+    MutantVerifier verifier;
+
     /// Number of volatile instructions found
     unsigned numInsts;
 
@@ -50,7 +57,7 @@ struct RmVolatileKeyword : public ModulePass {
 
     virtual bool runOnModule(Module &M) {
 	errs() << "RmVolatileKeyword\n";
-	volVis.visit(M);
+	parallelVisit(M, volVis);
 	DEBUG(errs() << "DEBUG: Found " << volVis.getVolaInstsSize()
 		     << " instances of potentially volatile instructions\n");
 	numInsts = volVis.getVolaInstsSize();
@@ -75,22 +82,31 @@ struct RmVolatileKeyword : public ModulePass {
 			       << "found volatile instructions, skipping\n";
 		    }
 		    else {
+			verifier.touch(I);
 			modified = removeVolatile(I);
 		    }
 		}
 	    }
 	}
 
+	if (modified) {
+	    verifier.check(M, "RmVolatileKeyword");
+	}
 	return modified;
     }
 
 
-    /**
-     * TODO: We only sometimes modify the program. Incase we run in a string of
-     * passes controlled by pass manager then maybe we should let the manager
-     * know when we do/do not invalidate the analyses. But, I can't see how
-     * this can be run in pass manager since it requires command line arguments
-     */
+    /// The program is only modified when -rmpos is given, and then only the
+    /// volatile flag of some instructions changes. Let the pass manager keep
+    /// its analyses for any passes that follow.
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+	if (PosToRm.size() == 0) {
+	    AU.setPreservesAll();
+	}
+	else {
+	    AU.setPreservesCFG();
+	}
+    }
 
     /// In non verbose mode, simply prints out the number of volatile /
     /// instructions found. In verbose mode, prints out filename and linenumber.
@@ -9,6 +9,7 @@
  * Visitor functions for instructions that potentially could be volatile
  */
 #include "VolatileVisitor.h"
+#include "../Tools/SourceScope.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Debug.h"
 
@@ -82,3 +83,12 @@ Instruction *VolatileVisitor::getVolaInst(unsigned int index) const {
 
     return volaInsts[index];
 }
+
+void VolatileVisitor::merge(const VolatileVisitor &other) {
+    volaInsts.insert(volaInsts.end(), other.volaInsts.begin(),
+	    other.volaInsts.end());
+}
+
+void VolatileVisitor::filter(SourceScope &scope) {
+	removeOutOfScope(volaInsts, scope);
+}
@@ -12,6 +12,8 @@
 #include "llvm/Support/InstVisitor.h"
 #include <vector>
 
+class SourceScope;
+
 using llvm::InstVisitor;
 using llvm::LoadInst;
 using llvm::StoreInst;
@@ -40,6 +42,12 @@ class VolatileVisitor: public InstVisitor<VolatileVisitor> {
 	/// \return the size of the data structure volaInsts
 	unsigned getVolaInstsSize() const;
 
+	/// Append the instructions found by other (used by parallelVisit())
+	void merge(const VolatileVisitor &other);
+
+	/// Remove the instructions outside of scope (used by parallelVisit())
+	void filter(SourceScope &scope);
+
 	/// \param index of value to obtain
 	/// \return obtain the value at index 
 	Instruction *getVolaInst(unsigned int index) const;
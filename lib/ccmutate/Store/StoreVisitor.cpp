@@ -7,6 +7,7 @@
  */
 
 #include "StoreVisitor.h"
+#include "../Tools/SourceScope.h"
 
 // Enable debugging output
 //#define MUT_DEBUG
@@ -50,3 +51,11 @@ StoreInst *StoreVisitor::getInst(unsigned index) const {
         return NULL;
     }
 }
+
+void StoreVisitor::merge(const StoreVisitor &other) {
+    storeInsts.insert(storeInsts.end(), other.storeInsts.begin(), other.storeInsts.end());
+}
+
+void StoreVisitor::filter(SourceScope &scope) {
+    removeOutOfScope(storeInsts, scope);
+}
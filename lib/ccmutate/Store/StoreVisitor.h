@@ -9,6 +9,8 @@
 #include "llvm/Support/InstVisitor.h"
 #include <vector>
 
+class SourceScope;
+
 using namespace llvm;
 
 class StoreVisitor : public InstVisitor<StoreVisitor> {
@@ -17,6 +19,12 @@ class StoreVisitor : public InstVisitor<StoreVisitor> {
         // Visitor function
         void visitStoreInst(StoreInst &I);
 
+        // Append the instructions found by other (used by parallelVisit())
+        void merge(const StoreVisitor &other);
+
+        // Remove the instructions outside of scope (used by parallelVisit())
+        void filter(SourceScope &scope);
+
         // Data accessor functions
         unsigned getSize() const;
         // Returns NULL if index out-of-bounds
@@ -0,0 +1,109 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file TCE.cpp
+ * \author Markus Kusano
+ *
+ * Trivial compiler equivalence: prints the structural hash (see
+ * StructuralHash.h) of a module so equivalent and duplicate mutants can be
+ * dropped. Meant to run after a fixed optimization pipeline, e.g.
+ *
+ *     opt -O2 -load mutate_TCE.so -TCE -analyze <mutant.bc
+ *
+ * With -machine the hash is of the machine code generated for the target
+ * instead (see MachineHash.h), which also finds mutants that only differ in
+ * the IR.
+ *
+ * See README.md for more information.
+ */
+#include "llvm/Pass.h"
+#include "llvm/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "../Tools/StructuralHash.h"
+#include "../Tools/MachineHash.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace llvm;
+
+/// Command line option: also print the hash of every function defined in the
+/// module
+static cl::opt<bool> verbose("verbose",
+        cl::desc("print the hash of each function"),
+        cl::init(false));
+
+/// Command line option: hash the machine code of the module instead of the IR
+static cl::opt<bool> machine("machine",
+        cl::desc("hash the machine code generated for the target instead of the IR"),
+        cl::init(false));
+
+/// Command line option: target triple used with -machine. Defaults to the
+/// triple of the module, or the host if the module has none.
+static cl::opt<std::string> targetTriple("tce-triple",
+        cl::desc("target triple to generate code for with -machine"),
+        cl::init(""));
+
+/// Command line option: target cpu used with -machine
+static cl::opt<std::string> targetCPU("tce-cpu",
+        cl::desc("target cpu to generate code for with -machine"),
+        cl::init(""));
+
+namespace {
+struct TCE : public ModulePass {
+    static char ID;
+    TCE() : ModulePass(ID) { }
+
+    uint64_t moduleHash;
+
+    // Hash and name of every function defined in the module, in module order
+    std::vector<std::pair<uint64_t, std::string> > funcHashes;
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+        AU.setPreservesAll();
+    }
+
+    virtual bool runOnModule(Module &M) {
+        funcHashes.clear();
+        if (machine) {
+            MachineHash code;
+            std::string error;
+            if (!code.run(M, targetTriple, targetCPU, error)) {
+                errs() << "Error: -machine: " << error << '\n';
+                exit(EXIT_FAILURE);
+            }
+            moduleHash = code.getModuleHash();
+            if (verbose) {
+                funcHashes = code.getFunctionHashes();
+            }
+            return false;
+        }
+
+        moduleHash = hashModule(M);
+        if (verbose) {
+            for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+                if (!F->isDeclaration()) {
+                    funcHashes.push_back(std::make_pair(hashFunction(*F), F->getName().str()));
+                }
+            }
+        }
+        return false;
+    }
+
+    // <moduleHash>
+    // <functionHash>\t<functionName>    (with -verbose)
+    virtual void print(llvm::raw_ostream &O, const Module *M) const {
+        errs() << format("%016llx", (unsigned long long) moduleHash) << '\n';
+        for (unsigned i = 0; i < funcHashes.size(); i++) {
+            errs() << format("%016llx", (unsigned long long) funcHashes[i].first)
+                   << '\t' << funcHashes[i].second << '\n';
+        }
+    }
+};
+}
+
+char TCE::ID = 0;
+static RegisterPass<TCE> X("TCE", "Structural hash for trivial compiler equivalence", false, true);
@@ -0,0 +1,57 @@
+# Test script, requires that the following variables be present to the shell:
+#	$opt: the location of opt
+#	$llvmlibdir: the library directory of LLVM (where opt modules can be found)
+#	$llvmdis: locatino of llvm-dis (for human readable output bitcode files)
+# Run make_test.sh prior to running this
+
+# These run tests but the output of the tool needs to be checked by a human
+
+testLibName="mutate_TCE.so"
+libraryName="TCE"
+storeLib="mutate_Store.so"
+
+# Mutants of the seq_cst store in producer():
+#   out_equivalent.bc  seq_cst again, the same as the original
+#   out_monotonic.bc   monotonic
+#   out_duplicate.bc   release then monotonic, the same as out_monotonic.bc
+$opt -load "$llvmlibdir"/"$storeLib" -Store -mod -pos=0 -order=3 <test.bc >out_equivalent.bc
+$opt -load "$llvmlibdir"/"$storeLib" -Store -mod -pos=0 -order=1 <test.bc >out_monotonic.bc
+$opt -load "$llvmlibdir"/"$storeLib" -Store -mod -pos=0 -order=2 <test.bc \
+    | $opt -load "$llvmlibdir"/"$storeLib" -Store -mod -pos=0 -order=1 >out_duplicate.bc
+$llvmdis out_monotonic.bc
+
+echo "BEGIN TEST: Hash the original"
+$opt -O2 -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName <test.bc >/dev/null
+echo "END TEST: Hash the original"
+echo " "
+
+echo "BEGIN TEST: Hash the equivalent mutant (same hash as the original)"
+$opt -O2 -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName <out_equivalent.bc >/dev/null
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: Hash the monotonic mutant (different hash)"
+$opt -O2 -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName <out_monotonic.bc >/dev/null
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: Hash the duplicate mutant (same hash as the monotonic mutant)"
+$opt -O2 -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName <out_duplicate.bc >/dev/null
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: verbose, one hash per function"
+$opt -O2 -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName -verbose <out_monotonic.bc >/dev/null
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: machine code hashes for x86-64"
+$opt -O2 -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName -machine -tce-triple=x86_64-unknown-linux-gnu <test.bc >/dev/null
+$opt -O2 -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName -machine -tce-triple=x86_64-unknown-linux-gnu <out_monotonic.bc >/dev/null
+echo "END TEST"
+echo " "
+
+echo "BEGIN TEST: -machine with an unknown triple (should fail)"
+$opt -O2 -analyze -load "$llvmlibdir"/"$testLibName" -$libraryName -machine -tce-triple=nonsense <test.bc >/dev/null
+echo "END TEST"
+echo " "
@@ -0,0 +1,23 @@
+#include <pthread.h>
+#include <stdlib.h>
+
+int ready;
+int data;
+
+void *producer(void *arg) {
+    data = 42;
+    __atomic_store_n(&ready, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t t;
+    pthread_create(&t, NULL, producer, NULL);
+    while (!__atomic_load_n(&ready, __ATOMIC_SEQ_CST)) {
+    }
+    if (data != 42) {
+        abort();
+    }
+    pthread_join(t, NULL);
+    return 0;
+}
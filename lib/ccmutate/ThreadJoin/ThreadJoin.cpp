@@ -18,7 +18,10 @@
 #include "llvm/Support/CommandLine.h"
 
 #include "../Tools/EnumerateCallInst.h"
-#include "../Tools/ItaniumDemangle.h"
+#include "../Tools/MutantVerifier.h"
+#include "../Tools/SiteCatalog.h"
+#include "../Tools/SyncSymbols.h"
+#include "../Tools/OperatorOption.h"
 
 using namespace llvm;
 
@@ -26,26 +29,26 @@ using namespace llvm;
 
 // Command line flags
 static cl::opt<bool> 
-    verbose("v", 
+    verbose(MUTATE_OPT("v"), 
 	cl::desc("Enable verbose output."
 	    "Displays filename and location of occurances"),
 	cl::init(false));
 
-static cl::opt<bool> posix("posix",
+static cl::opt<bool> posix(MUTATE_OPT("posix"),
         cl::desc("Enable mutation of POSIX thread calls"),
         cl::init(false));
 
-static cl::opt<bool> cxx11("c++11",
+static cl::opt<bool> cxx11(MUTATE_OPT("c++11"),
         cl::desc("Enable mutation of C++11 thread calls"),
         cl::init(false));
 
 // Specifies if we are in remove mode
-static cl::opt<bool> rmMode("rm", 
+static cl::opt<bool> rmMode(MUTATE_OPT("rm"), 
 	cl::desc("remove occurances of join"),
 	cl::init(false));
 
 // Specifies if we are in replace join with sleep mode
-static cl::opt<bool> repMode("rep", 
+static cl::opt<bool> repMode(MUTATE_OPT("rep"), 
 	cl::desc("replace occurance of join with sleep"),
 	cl::init(false));
 
@@ -53,14 +56,14 @@ static cl::opt<bool> repMode("rep",
 // removed. Use the analysis FindPosixJoin to get the enumeration. Specify a
 // comma seperated list of 0 indexed values (e.g. -pos=1,3,4) which will
 // remove occurances 1, 3 and 4.
-static cl::list<unsigned> PosToRm("pos", 
+static cl::list<unsigned> PosToRm(MUTATE_OPT("pos"), 
 	cl::desc("occurances to remove or replace with sleep"),
 	cl::value_desc("comma seperated list of occurances to alter"),
 	cl::CommaSeparated);
 
 /// TODO: This could be a list so that different values to sleep could be
 /// passed for different selected occurrences.
-static cl::opt<unsigned> SleepValue("sleepval",
+static cl::opt<unsigned> SleepValue(MUTATE_OPT("sleepval"),
 	cl::desc("value to be passed to call to sleep, default is 1"),
 	cl::value_desc("positive integer"),
 	cl::init(1));
@@ -74,12 +77,20 @@ namespace {
      * Visitor to find CallInst or Invokes to join
      */
     EnumerateCallInst pjv;
+    MutantVerifier verifier;
 
     /**
      * Number of calls to join found
      */
     unsigned numCalls;
 
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+	AU.addRequired<SiteCatalog>();
+	if (!rmMode && !repMode) {
+	    AU.setPreservesAll(); // only analyzing
+	}
+    }
+
     /**
      * Uses a FindPosixJoinVisitor to find occurances of CallInst to
      * pthread_join
@@ -97,7 +108,7 @@ namespace {
             pjv.searchCpp();
         }
 
-	pjv.visit(M);
+	pjv.enumerate(getAnalysis<SiteCatalog>(), M);
 
 #ifdef MUT_DEBUG
         errs() << "DEBUG: found " << pjv.callInsts.size() << " CallInsts and " 
@@ -255,6 +266,10 @@ namespace {
 	// Use print method (-print) to display the results
 	//errs() << numCalls << '\n';
 
+	if (modified) {
+	    verifier.touch(pjv.getMutatedFunctions());
+	    verifier.check(M, "ThreadJoin");
+	}
 	return modified;
     }
 
@@ -334,33 +349,18 @@ namespace {
 	    }
 	}
     }
-    // Returns true if the passed instruction demangles to some kind of call to
-    // std::__1::thread::join. Requires a bool to specify if the pointer is of
-    // type CallInst or InvokeInst.
+    // Returns true if the passed instruction is some kind of call to
+    // std::__1::thread::join (or std::thread::join in libstdc++). Requires a
+    // bool to specify if the pointer is of type CallInst or InvokeInst.
     bool isStdThreadJoin(Instruction *inst, bool isCallInst) {
         Function *calledFunc;
-        StringRef funcName;
         if (isCallInst) {
             calledFunc = ((CallInst *)inst)->getCalledFunction();
         }
         else {
             calledFunc = ((InvokeInst *)inst)->getCalledFunction();
         }
-        funcName = calledFunc->getName();
-        char *demangled = demangleCpp(funcName);
-
-        if (demangled == NULL) {
-            return false;
-        }
-        std::string noParams;
-        noParams = removeParameters(demangled);
-
-        free(demangled);
-
-        if (noParams == "std::__1::thread::join") {
-            return true;
-        }
-        return false;
+        return classifyFunction(calledFunc) == SK_StdThreadJoin;
     }
 
 
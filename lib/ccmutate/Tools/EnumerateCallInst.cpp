@@ -11,6 +11,8 @@
 #include "EnumerateCallInst.h"
 #include "RemoveInst.h"
 #include "ItaniumDemangle.h"
+#include "SyncSymbols.h"
+#include "ProgramOrder.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/DebugInfo.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
@@ -28,6 +30,55 @@ void EnumerateCallInst::addFuncNameToSearch(std::string funcName) {
     funcNames.insert(funcName);
 }
 
+void EnumerateCallInst::enumerate(Module &M) {
+    bool found = false;
+    SourceScope scope;
+
+    for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+        if (checkIfMatch(&*F)) {
+#ifdef MUT_DEBUG
+            errs() << "DEBUG: Collecting uses of " << F->getName() << '\n';
+#endif
+            collectCallSites(&*F, callInsts, invokeInsts, scope);
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return;
+    }
+
+    ProgramOrder PO(M);
+    sortInProgramOrder(callInsts, PO);
+    sortInProgramOrder(invokeInsts, PO);
+}
+
+void EnumerateCallInst::enumerate(const SiteCatalog &catalog, Module &M) {
+    std::vector<SyncKind> kinds;
+    if (!getSearchedKinds(kinds)) {
+        enumerate(M);
+        return;
+    }
+    if (kinds.size() != 0) {
+        catalog.getCallSites(&kinds[0], kinds.size(), callInsts, invokeInsts);
+    }
+}
+
+bool EnumerateCallInst::getSearchedKinds(std::vector<SyncKind> &kinds) const {
+    for (unsigned k = SK_None + 1; k < SK_NumKinds; k++) {
+        std::string name = getSyncKindName((SyncKind) k);
+        if (!funcNames.count(name)) {
+            continue;
+        }
+        if (!isCpp && name.find("::") != std::string::npos) {
+            return false;
+        }
+        kinds.push_back((SyncKind) k);
+    }
+    // Every name has to be a kind
+    return kinds.size() == funcNames.size();
+}
+
 void EnumerateCallInst::visitCallInst(CallInst &I) {
     // Check if the function being called is in the search set
     Function *call;
@@ -61,6 +112,7 @@ void EnumerateCallInst::visitInvokeInst(InvokeInst &I) {
 bool EnumerateCallInst::checkIfMatch(Function *F) {
     char *demangledFuncName;
     std::string foundName;
+    SyncKind kind;
 
     if (F) {
 	// Assumption: calls to searched for will never be indirect
@@ -68,7 +120,11 @@ bool EnumerateCallInst::checkIfMatch(Function *F) {
 	errs() << "DEBUG: function calling: ";
 	errs() << F->getName()<< '\n';
 #endif
-        if (isCpp) {
+        if (isCpp && (kind = classifySyncSymbol(F->getName())) != SK_None) {
+            // Known symbol, no need to demangle
+            foundName = getSyncKindName(kind);
+        }
+        else if (isCpp) {
             demangledFuncName = demangleCpp(F->getName());  // potentially returns malloced char*
             if (demangledFuncName == NULL) {
                 // If demangling failed, assume the function name is a non mangled
@@ -137,6 +193,7 @@ int EnumerateCallInst::removeFromParentRepZero(unsigned index, unsigned size, bo
     if (curInst == NULL) {
 	return errorCode;
     }
+    recordMutation(index);
 
     if (isCallInst) {
 #ifdef MUT_DEBUG
@@ -166,13 +223,11 @@ int EnumerateCallInst::removeFromParentRepZero(unsigned index, unsigned size, bo
                   "unknown return code from isValidIndex()\n";
     }
 
-
-    deletedIndices.insert(index);
     return 0;
 }
 
 void EnumerateCallInst::eraseInst(unsigned index) {
-    deletedIndices.insert(index);
+    recordMutation(index);
     callInsts[index]->eraseFromParent();
 #ifdef MUT_DEBUG
     errs() << "\tDEBUG: Index deleted\n";
@@ -230,7 +285,7 @@ int EnumerateCallInst::replaceInstWithInst(unsigned index, Instruction *inst) {
 
     // Index is valid, so add the index to the deleted map and perform the
     // replacement
-    deletedIndices.insert(index);
+    recordMutation(index);
 
     // If we are dealing with an invoke instruction then it is a terminator for
     // the current basic block. Before doing the replacment, insert a branch to
@@ -256,11 +311,27 @@ int EnumerateCallInst::markMutated(unsigned index) {
     if (ret < 0) {
 	return ret;
     }
-    deletedIndices.insert(index);
+    recordMutation(index);
 
     return 0;
 }
 
+void EnumerateCallInst::recordMutation(unsigned index) {
+    Instruction *inst;
+    if (index < callInsts.size()) {
+        inst = callInsts[index];
+    }
+    else {
+        inst = invokeInsts[index - callInsts.size()];
+    }
+    mutatedFuncs.insert(inst->getParent()->getParent());
+    deletedIndices.insert(index);
+}
+
+const MutantVerifier::FunctionSet &EnumerateCallInst::getMutatedFunctions() const {
+    return mutatedFuncs;
+}
+
 Instruction *EnumerateCallInst::getInstructionAt(unsigned index, bool *isCallInst, 
         int *errorCode) {
     int ret = isValidIndex(index);
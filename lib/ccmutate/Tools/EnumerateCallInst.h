@@ -17,8 +17,17 @@
  * or InvokeInsts. Most member functions work on indices that consider the two
  * data structures as one array starting with callInsts and going to
  * invokeInsts.
+ *
+ * enumerate() should be preferred over visit(). It only looks at the uses of
+ * the functions in the module that match funcNames instead of every
+ * instruction in the module. The found instructions are put in the same order
+ * visit() would have found them so the indices are unchanged. Inside a pass,
+ * pass the SiteCatalog to enumerate() so the call sites are taken from the
+ * catalog shared with the other operators of the pipeline.
  */
 #pragma once
+#include "MutantVerifier.h"
+#include "SiteCatalog.h"
 #include "llvm/Support/InstVisitor.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
@@ -45,6 +54,16 @@ class EnumerateCallInst : public InstVisitor<EnumerateCallInst> {
 	/// \param funcName Function name for visitor to search for.
 	void addFuncNameToSearch(std::string funcName);
 
+	/// Fill callInsts and invokeInsts with the calls to functions in
+	/// funcNames. Gives the same result as visit(M) but only walks the use
+	/// lists of the matching function declarations.
+	void enumerate(Module &M);
+
+	/// Same as enumerate(M) but copies the call sites from catalog when
+	/// every name in funcNames is a SyncKind (see SyncSymbols.def). Falls
+	/// back to enumerate(M) otherwise.
+	void enumerate(const SiteCatalog &catalog, Module &M);
+
 	/// Overridden visitor function for call and invoke instructions
 	void visitCallInst(CallInst &I);
         void visitInvokeInst(InvokeInst &I);
@@ -123,6 +142,11 @@ class EnumerateCallInst : public InstVisitor<EnumerateCallInst> {
         /// Returns true if we are searching for Cpp functions.
         bool getIsCpp();
 
+        /// Functions containing an index that has been mutated (removed,
+        /// replaced or passed to markMutated()). Pass to
+        /// MutantVerifier::touch() before writing the mutant.
+        const MutantVerifier::FunctionSet &getMutatedFunctions() const;
+
     private:
 	/// Set of indecies that have been removed from their parent. This
 	/// becomes invalid if callInsts has one or more of its values removed.
@@ -136,9 +160,21 @@ class EnumerateCallInst : public InstVisitor<EnumerateCallInst> {
 	/// \param index Index to remove from it's parent.
 	void eraseInst(unsigned index);
 
+        /// Add the index to deletedIndices and its function to mutatedFuncs.
+        /// Must be called before the instruction is erased.
+        void recordMutation(unsigned index);
+
+        MutantVerifier::FunctionSet mutatedFuncs;
+
         /// Check if the passed function is on being searched for. Return true
         /// if it is, otherwise false.
         bool checkIfMatch(Function *F);
 
+        /// Fill kinds with the SyncKind of each name in funcNames. Returns
+        /// false if a name is not the name of a kind, or is a C++ kind while
+        /// not searching for C++ functions (the catalog would then find more
+        /// than checkIfMatch())
+        bool getSearchedKinds(std::vector<SyncKind> &kinds) const;
+
         bool isCpp;
 };
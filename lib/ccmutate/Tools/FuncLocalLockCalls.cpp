@@ -4,49 +4,49 @@
  */
 #include "FuncLocalLockCalls.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/Support/InstIterator.h"
+#include "ProgramOrder.h"
 
 #define MUT_DEBUG
 
 void FuncLocalLockCalls::search(Module &M) {
-    // Obtain a function iterator to the module
-    Module::iterator fIter = M.begin();
-    Module::iterator fEnd = M.end();
-
-    // Iterate over each function
-    for (; fIter != fEnd; ++fIter) {
-	// Create a vector to hold CallInst for this function that are calling
-	// pthread_mutex_{lock,unlock}
-	std::vector<CallInst *> *lockCalls;
-	lockCalls = new std::vector<CallInst *>;
-
-	// Iterate over each instruction
-	inst_iterator I;
-	inst_iterator E;
-	for (I = inst_begin(&*fIter), E = inst_end(&*fIter);
-		I != E; ++I) {
-
-	    // Find CallInst calling pthread_mutex_{lock,unlock}
-	    if (CallInst* callInst = dyn_cast<CallInst>(&*I)) {
-		Function *calledFunc = callInst->getCalledFunction();
-		if (calledFunc) {
-		    if (calledFunc->getName() == "pthread_mutex_lock" ||
-			    calledFunc->getName() == "pthread_mutex_unlock") {
-			lockCalls->push_back(callInst);
-		    }
-		}
-	    }
-	}
+    // Only the uses of the lock and unlock declarations can be calls to them
+    // so there is no need to look at every instruction in the module.
+    // Invokes were never recorded so they are dropped.
+    std::vector<CallInst *> lockCalls;
+    std::vector<InvokeInst *> lockInvokes;
+
+    SourceScope scope;
+
+    Function *lockFunc = M.getFunction("pthread_mutex_lock");
+    Function *unlockFunc = M.getFunction("pthread_mutex_unlock");
+    if (lockFunc) {
+	collectCallSites(lockFunc, lockCalls, lockInvokes, scope);
+    }
+    if (unlockFunc) {
+	collectCallSites(unlockFunc, lockCalls, lockInvokes, scope);
+    }
 
-	if (lockCalls->size() == 0) {
-	    // this function has no mutex calls
-	    delete lockCalls;
-	}
-	else {
-	    funcs.push_back(&*fIter);
-	    calls.push_back(lockCalls);
+    if (lockCalls.size() == 0) {
+	// the module has no mutex calls
+	return;
+    }
+
+    // Sorting puts the calls of each function next to each other in the
+    // order they occur and the functions in module order
+    ProgramOrder PO(M);
+    sortInProgramOrder(lockCalls, PO);
+
+    Function *curFunc = NULL;
+    for (unsigned i = 0; i < lockCalls.size(); i++) {
+	Function *parent = lockCalls[i]->getParent()->getParent();
+	if (parent != curFunc) {
+	    curFunc = parent;
+	    funcs.push_back(curFunc);
+	    callStart.push_back(i);
 	}
     }
+    callStart.push_back(lockCalls.size());
+    calls.swap(lockCalls);
 }
 
 Function *FuncLocalLockCalls::getFuncPtr(unsigned index) const {
@@ -62,9 +62,9 @@ Function *FuncLocalLockCalls::getFuncPtr(unsigned index) const {
 }
 
 CallInst *FuncLocalLockCalls::getCallInstPtr(unsigned funcIndex, unsigned callIndex) {
-    if (funcIndex < calls.size()) {
-	if (callIndex < calls[funcIndex]->size()) {
-	    return calls[funcIndex]->at(callIndex);
+    if (funcIndex < funcs.size()) {
+	if (callIndex < getCallsSizeAt(funcIndex)) {
+	    return calls[callStart[funcIndex] + callIndex];
 	}
 #ifdef MUT_DEBUG
 	else {
@@ -86,12 +86,12 @@ unsigned FuncLocalLockCalls::getFuncsSize() const {
 }
 
 unsigned FuncLocalLockCalls::getCallsSize() const {
-    return calls.size();
+    return funcs.size();
 }
 
 unsigned FuncLocalLockCalls::getCallsSizeAt(unsigned index) const {
-    if (index < calls.size()) {
-	return calls[index]->size();
+    if (index < funcs.size()) {
+	return callStart[index + 1] - callStart[index];
     }
     else {
 	errs() << "Warning: index to getCallsSize is out-of-bounds\n";
@@ -103,13 +103,8 @@ unsigned FuncLocalLockCalls::getCallsSizeAt(unsigned index) const {
 void FuncLocalLockCalls::dump() {
     for (unsigned i = 0; i < funcs.size(); i++) {
 	errs() << "Function: " << funcs[i]->getName() << " has the following lock/unlock calls:\n";
-	if (i < calls.size()) {
-	    for (unsigned j = 0; j < calls[i]->size(); j++) {
-		errs() << "\t" << *(calls[i]->at(j)) << '\n';
-	    }
-	}
-	else {
-	    errs() << "Warning: mismatch of sizes of function and callinst vectors\n";
+	for (unsigned j = callStart[i]; j < callStart[i + 1]; j++) {
+	    errs() << "\t" << *(calls[j]) << '\n';
 	}
     }
 }
@@ -55,12 +55,13 @@ class FuncLocalLockCalls {
 
     private:
 	// A vector to hold pointers to functions that have been search. This
-	// vector lines up with the CallInst vector
+	// vector lines up with callStart
 	std::vector<Function *> funcs;
 
-	// A vector of pointers to vectors of CallInst *'s. The top vector
-	// corresponds to indecies in funcs. The bottom vector contains the
-	// calls to pthread_mutex_lock and pthread_mutex_unlock that are found
-	// in the function in the order that they occur.
-	std::vector<std::vector<CallInst *>* > calls;
+	// The calls to pthread_mutex_lock and pthread_mutex_unlock of every
+	// function in funcs, one function after the other in the order that
+	// they occur. The calls of funcs[i] are calls[callStart[i]] to
+	// calls[callStart[i + 1] - 1].
+	std::vector<CallInst *> calls;
+	std::vector<unsigned> callStart;
 };
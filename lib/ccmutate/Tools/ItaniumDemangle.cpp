@@ -4,6 +4,7 @@
  */
 
 #include "ItaniumDemangle.h"
+#include "SyncSymbols.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstring>
 
@@ -151,6 +152,13 @@ std::string getFunctionName(Function *func) {
     }
 
     funcName = func->getName();
+
+    // Known synchronization functions do not need to be demangled
+    SyncKind kind = classifySyncSymbol(funcName);
+    if (kind != SK_None) {
+        return getSyncKindName(kind);
+    }
+
     demangled = demangleCpp(funcName);  // malloc'd
 
     if (demangled == NULL) {
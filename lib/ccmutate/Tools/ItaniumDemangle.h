@@ -29,5 +29,7 @@ std::string removeParameters(char *funcCall);
 // Returns the function name with no paremters. Attempts to demangle the
 // function call if possible. If the demangle fails, it is assumed to be an
 // unmangled name. Returns a default constructed std::string on failure.
+// Functions in SyncSymbols.def are looked up without demangling and return
+// their canonical (libc++) name.
 std::string getFunctionName(Function *func);
 
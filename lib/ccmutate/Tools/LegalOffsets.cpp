@@ -0,0 +1,182 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file LegalOffsets.cpp
+ * \author Markus Kusano
+ *
+ * Implementation of LegalOffsets.h
+ */
+#include "LegalOffsets.h"
+
+#include "llvm/Instructions.h"
+#include "llvm/IntrinsicInst.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/InstIterator.h"
+
+#include <algorithm> // std::max
+
+// Returns true if a copy of a call cannot be inserted before inst
+static bool isNotInsertionPoint(const Instruction *inst) {
+    return isa<PHINode>(inst) || isa<LandingPadInst>(inst);
+}
+
+// Returns true if inserting before inst is the same as inserting before the
+// instruction preceding it in its block
+static bool followsDebugIntrinsic(Instruction *inst) {
+    BasicBlock::iterator iter(inst);
+    if (iter == inst->getParent()->begin()) {
+        return false;
+    }
+    --iter;
+    return isa<DbgInfoIntrinsic>(iter);
+}
+
+void findLegalShifts(Instruction *call, SmallVectorImpl<int> &dirs) {
+    BasicBlock *bb;
+    Value *mutex;
+    SmallVector<Instruction *, 32> rest; // block without call
+    int callIndex;  // index of call in its block
+    int first;      // first index in rest a call can be inserted before
+    int orig;       // index in rest where call is now
+    int argIndex;   // index in rest of the mutex, -1 if not in this block
+
+    if (!isa<CallInst>(call) && !isa<InvokeInst>(call)) {
+        return;
+    }
+    CallSite cs(call);
+    if (cs.arg_size() < 1) {
+        return;
+    }
+    mutex = cs.getArgument(0);
+
+    bb = call->getParent();
+    callIndex = -1;
+    first = -1;
+    argIndex = -1;
+    for (BasicBlock::iterator i = bb->begin(), e = bb->end(); i != e; ++i) {
+        if (&*i == call) {
+            callIndex = rest.size();
+            continue;
+        }
+        if (first == -1 && !isNotInsertionPoint(&*i)) {
+            first = rest.size();
+        }
+        if (&*i == mutex) {
+            argIndex = rest.size();
+        }
+        rest.push_back(&*i);
+    }
+    if (first == -1) {
+        return;
+    }
+
+    // An InvokeInst is replaced with a call at the end of the block, before
+    // the new branch. That position is past the end of rest
+    orig = callIndex;
+    while (orig > 0 && isa<DbgInfoIntrinsic>(rest[orig - 1])) {
+        --orig;
+    }
+
+    for (int j = std::max(first, argIndex + 1); j < (int) rest.size(); j++) {
+        if (j == orig) {
+            continue;
+        }
+        if (j > 0 && isa<DbgInfoIntrinsic>(rest[j - 1])) {
+            continue;
+        }
+        // Convert the position in rest back to the instruction distance
+        // used by shiftCallInst()
+        if (j < callIndex) {
+            dirs.push_back(j - callIndex);
+        }
+        else {
+            dirs.push_back(j + 1 - callIndex);
+        }
+    }
+}
+
+void findLegalSplits(Instruction *lock, Instruction *unlock, DominatorTree &DT,
+        SmallVectorImpl<unsigned> &pos) {
+    Function *F;
+    Instruction *unlockMutex;
+    int dist;
+
+    F = lock->getParent()->getParent();
+    if (unlock->getParent()->getParent() != F) {
+        return;
+    }
+    if (!isa<CallInst>(unlock) && !isa<InvokeInst>(unlock)) {
+        return;
+    }
+    CallSite cs(unlock);
+    if (cs.arg_size() < 1) {
+        return;
+    }
+    // The copy of the unlock call is passed the same value
+    unlockMutex = dyn_cast<Instruction>(cs.getArgument(0));
+
+    // Same distance as LockUnlockPairs::calcDistanceBetween()
+    dist = 0;
+    inst_iterator iter = inst_begin(F);
+    inst_iterator end = inst_end(F);
+    while (iter != end && &*iter != lock && &*iter != unlock) {
+        ++iter;
+    }
+    if (iter == end) {
+        return;
+    }
+    for (++iter, ++dist; iter != end && &*iter != lock && &*iter != unlock; ++iter) {
+        ++dist;
+    }
+
+    // Walk forward from the lock call as insertInstructionRelative() does
+    iter = inst_begin(F);
+    while (&*iter != lock) {
+        ++iter;
+    }
+    ++iter;
+    for (int p = 1; p < dist && iter != end; p++, ++iter) {
+        Instruction *at = &*iter;
+        if (isNotInsertionPoint(at) || followsDebugIntrinsic(at)) {
+            continue;
+        }
+        if (!DT.dominates(lock, at)) {
+            continue;
+        }
+        if (unlockMutex && !DT.dominates(unlockMutex, at)) {
+            continue;
+        }
+        pos.push_back(p);
+    }
+}
+
+void findLegalOffsets(Instruction *lock, Instruction *unlock, DominatorTree &DT,
+        LegalOffsets &offsets) {
+    findLegalShifts(lock, offsets.lockDirs);
+    findLegalShifts(unlock, offsets.unlockDirs);
+    findLegalSplits(lock, unlock, DT, offsets.splitPos);
+}
+
+template <typename T>
+static void printList(raw_ostream &O, const SmallVectorImpl<T> &list) {
+    if (list.empty()) {
+        O << '-';
+        return;
+    }
+    for (unsigned i = 0; i < list.size(); i++) {
+        if (i != 0) {
+            O << ',';
+        }
+        O << list[i];
+    }
+}
+
+void printLegalOffsets(raw_ostream &O, const LegalOffsets &offsets) {
+    O << "lockdir: ";
+    printList(O, offsets.lockDirs);
+    O << "\tunlockdir: ";
+    printList(O, offsets.unlockDirs);
+    O << "\tsplitpos: ";
+    printList(O, offsets.splitPos);
+}
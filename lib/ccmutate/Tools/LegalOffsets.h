@@ -0,0 +1,64 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file LegalOffsets.h
+ * \author Markus Kusano
+ *
+ * Lists the -lockdir, -unlockdir and -splitpos values of a lock-unlock pair
+ * that give a valid mutant different from every other listed value. Used by
+ * -offsets in the Mutex and PosixLock operators.
+ *
+ * Shifts (relative to the call being moved, as in shiftCallInst()):
+ *  - the call stays in its own basic block: it is never moved before a PHI or
+ *    landingpad nor past the terminator,
+ *  - the call stays after the mutex it is passed when that is defined in the
+ *    same block,
+ *  - 0 and +1 (which do not move the call) are never listed. An InvokeInst is
+ *    turned into a call at the end of its block, so only negative shifts are
+ *    listed for one.
+ *
+ * Split positions (relative to the lock call, as in
+ * insertInstructionRelative()) are the offsets between 1 and the distance
+ * between the pair where the instruction a copy is inserted before:
+ *  - is not a PHI or landingpad,
+ *  - is dominated by the lock call and by the mutex passed to the unlock call.
+ * Any two listed positions make a valid -splitpos pair.
+ *
+ * In both cases an offset that only differs from a smaller one by debug
+ * intrinsics (llvm.dbg.*) is left out since it produces the same program.
+ *
+ * Offsets are computed for each call on its own: as with -shift, shifting
+ * both calls of a pair applies the second shift to the already changed code.
+ */
+#pragma once
+#include "llvm/Instruction.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+struct LegalOffsets {
+    SmallVector<int, 16> lockDirs;
+    SmallVector<int, 16> unlockDirs;
+    SmallVector<unsigned, 16> splitPos;
+};
+
+/// Fill offsets with the legal offsets of the pair (lock, unlock). Both must
+/// be CallInsts or InvokeInsts of the function DT was computed for.
+void findLegalOffsets(Instruction *lock, Instruction *unlock, DominatorTree &DT,
+        LegalOffsets &offsets);
+
+/// Appends the legal shift directions of call (a CallInst or InvokeInst) to
+/// dirs in increasing order
+void findLegalShifts(Instruction *call, SmallVectorImpl<int> &dirs);
+
+/// Appends the legal split positions of the pair to pos in increasing order
+void findLegalSplits(Instruction *lock, Instruction *unlock, DominatorTree &DT,
+        SmallVectorImpl<unsigned> &pos);
+
+/// Prints the offsets as
+/// `lockdir: <list>\tunlockdir: <list>\tsplitpos: <list>` where each list is
+/// comma separated (the format taken by the matching option) and `-` if empty.
+void printLegalOffsets(raw_ostream &O, const LegalOffsets &offsets);
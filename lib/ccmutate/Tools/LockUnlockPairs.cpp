@@ -20,12 +20,21 @@ void LockUnlockPairs::visit(Module &M, AliasAnalysis &AA) {
     // Enumerate all occurences
     calls.search(M);
 
+    // Every lock call can at most pair with each call that follows it in
+    // the same function. Use this as the size of the table so it is only
+    // allocated once
+    unsigned maxPairs = 0;
+    for (unsigned i = 0; i < calls.getCallsSize(); i++) {
+	unsigned numCalls = calls.getCallsSizeAt(i);
+	maxPairs += numCalls * (numCalls - 1) / 2;
+    }
+    pairs.reserve(maxPairs, calls.getCallsSize());
+
     // For each function that has lock and unlock calls compare each lock call
     // to every subsequent unlock call, if they alias to the same mutex then
-    // add them to the set of pairs
+    // add them to the set of pairs. A function can have calls to pthread
+    // lock or unlock but no pairs, it still keeps its index.
     for (unsigned i = 0; i < calls.getCallsSize(); i++) {
-	// Holds pairs for the current function
-	std::vector<lockUnlockPair *> *pairs = new std::vector<lockUnlockPair *>;
 	for (unsigned j = 0; j < calls.getCallsSizeAt(i) - 1; j++) {
 	    CallInst *inst1;
 	    inst1 = calls.getCallInstPtr(i,j);
@@ -51,20 +60,12 @@ void LockUnlockPairs::visit(Module &M, AliasAnalysis &AA) {
 		}
 		if (checkMutexAlias(inst1, inst2, AA)) {
 		    // Found a lock unlock pair
-		    lockUnlockPair *newPair = new lockUnlockPair;
-		    newPair->lockCall = inst1;
-		    newPair->unlockCall = inst2;
-		    pairs->push_back(newPair);
+		    pairs.add(inst1, inst2, i);
 		}
 	    }
 	}
-
-	// Add all the found pairs to the internal data structure. There is a
-	// chance that no pairs were found, meaning the vector is of size 0.
-	// This is desired to show that a function has calls to pthread lock or
-	// unlock but none alias to each other.
-	funcPairs.push_back(pairs);
     }
+    pairs.finish();
 }
 
 bool LockUnlockPairs::checkMutexAlias(CallInst *call1, CallInst *call2, AliasAnalysis &AA) {
@@ -134,25 +135,25 @@ bool LockUnlockPairs::isCallToPThreadMutexUnlock(CallInst *call) {
 }
 
 void LockUnlockPairs::dump() const {
-    for (unsigned i = 0; i < funcPairs.size(); i++) {
+    for (unsigned i = 0; i < getFuncsSize(); i++) {
 	errs() << "In function " << i << ":\n";
 	errs() << "The following CallInsts alias to the same mutex:\n";
-	for (unsigned j = 0; j < funcPairs.at(i)->size(); j++) {
-	    lockUnlockPair *pair;
-	    pair = funcPairs.at(i)->at(j);
-	    errs() << '\t' << *(pair->lockCall) << '\n' 
-		   << '\t' << *(pair->unlockCall) << '\n';
+	for (unsigned j = 0; j < pairs.getNumInFunc(i); j++) {
+	    lockUnlockPair pair;
+	    pair = getPair(i, j);
+	    errs() << '\t' << *(pair.lockCall) << '\n' 
+		   << '\t' << *(pair.unlockCall) << '\n';
 	}
     }
 }
 
 unsigned LockUnlockPairs::getFuncsSize() const {
-    return funcPairs.size();
+    return calls.getCallsSize();
 }
 
 unsigned LockUnlockPairs::getPairsSizeAtFunc(unsigned index) const {
-    if (index < funcPairs.size()) {
-	return funcPairs.at(index)->size();
+    if (index < getFuncsSize()) {
+	return pairs.getNumInFunc(index);
     }
     else {
 	errs() << "Warning: in LockUnlockPairs::getPairsSizeAtFunc(), passed "
@@ -167,20 +168,22 @@ Function *LockUnlockPairs::getFunc(unsigned index) const {
     return ret;
 }
 
-LockUnlockPairs::lockUnlockPair *LockUnlockPairs::getPair(unsigned funcIndex, unsigned pairIndex) const {
-    lockUnlockPair *pair;
-    pair = NULL;
-    if (funcIndex < funcPairs.size()) {
-	if (pairIndex < funcPairs.at(funcIndex)->size()) {
-	    pair = funcPairs.at(funcIndex)->at(pairIndex);
-	}
-#ifdef MUT_DEBUG
-	else {
-	    errs() << "DEBUG: LockUnlockPairs::getPair pairIndex out-of-bounds\n";
-	}
-#endif
+LockUnlockPairs::lockUnlockPair LockUnlockPairs::getPair(unsigned funcIndex, unsigned pairIndex) const {
+    lockUnlockPair pair;
+    pair.lockCall = NULL;
+    pair.unlockCall = NULL;
+
+    int index;
+    index = pairs.lookupByFunc(funcIndex, pairIndex);
+    if (index >= 0) {
+	// Only CallInsts are added to the table
+	pair.lockCall = cast<CallInst>(pairs.getLock(index));
+	pair.unlockCall = cast<CallInst>(pairs.getUnlock(index));
     }
 #ifdef MUT_DEBUG
+    else if (funcIndex < getFuncsSize()) {
+	errs() << "DEBUG: LockUnlockPairs::getPair pairIndex out-of-bounds\n";
+    }
     else {
 	errs() << "DEBUG: LockUnlockPairs::getPair funcIndex out-of-bounds\n";
     }
@@ -200,20 +203,20 @@ void LockUnlockPairs::printDebugInfo() const {
 
 	errs() << curFunc->getName() << '\n';
 
-	for (unsigned j = 0; j < funcPairs.at(i)->size(); j++) {
-	    lockUnlockPair *curPair;
+	for (unsigned j = 0; j < pairs.getNumInFunc(i); j++) {
+	    lockUnlockPair curPair;
 	    curPair = getPair(i, j);
-	    if (!curPair) {
+	    if (!curPair.lockCall) {
 		errs() << "Warning, in LockUnlockPairs::printDebugInfo, getPair() "
 			  "returned NULL, skipping\n";
 		continue;
 	    }
-	    errs() << '\t' << *(curPair->lockCall) << "\n\t" << *(curPair->unlockCall)
+	    errs() << '\t' << *(curPair.lockCall) << "\n\t" << *(curPair.unlockCall)
 		   << '\n';
 	    MDNode *metaNode1;
 	    MDNode *metaNode2;
-	    metaNode1 = curPair->lockCall->getMetadata("dbg");
-	    metaNode2 = curPair->unlockCall->getMetadata("dbg");
+	    metaNode1 = curPair.lockCall->getMetadata("dbg");
+	    metaNode2 = curPair.unlockCall->getMetadata("dbg");
 
 	    if (metaNode1) {
 		DILocation Loc(metaNode1);
@@ -229,11 +232,11 @@ void LockUnlockPairs::printDebugInfo() const {
 		errs() << '\t' << File << ' ' << Line;
 	    }
 
-	    errs() << '\t' << calcDistanceBetween(curPair->lockCall, curPair->unlockCall) << '\n';
+	    errs() << '\t' << calcDistanceBetween(curPair.lockCall, curPair.unlockCall) << '\n';
 
 	    // If this is not the last iteration, output an extra newline to
 	    // separate each of the pairs from each other
-	    if (j == funcPairs.at(i)->size() - 1) {
+	    if (j == pairs.getNumInFunc(i) - 1) {
 		errs() << '\n';
 	    }
 	    else {
@@ -13,8 +13,12 @@
  * This depends on the alias analysis information provided; currently only
  * function local alias information is used thus only function local
  * lock-unlock pairs are found.
+ *
+ * The pairs are kept in a PairTable and addressed by (function index, pair
+ * index).
  */
 #include "FuncLocalLockCalls.h"
+#include "PairTable.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Module.h"
 
@@ -24,6 +28,8 @@ using namespace llvm;
 
 class LockUnlockPairs {
     public:
+	/// Copy of a pair in the table. Both members are NULL if the pair
+	/// does not exist.
 	struct lockUnlockPair {
 	    CallInst *lockCall;
 	    CallInst *unlockCall;
@@ -44,9 +50,9 @@ class LockUnlockPairs {
 	/// out-of-bounds
 	Function *getFunc(unsigned index) const;
 
-	/// Returns the pair at the given index, NULL if either index is
-	/// out-of-bounds
-	lockUnlockPair *getPair(unsigned funcIndex, unsigned pairIndex) const;
+	/// Returns the pair at the given index. The members of the returned
+	/// pair are NULL if either index is out-of-bounds
+	lockUnlockPair getPair(unsigned funcIndex, unsigned pairIndex) const;
 
 	/// Returns the number of pairs for the function at the passed index.
 	/// Returns 0 and outputs a warning if the index is out-of-bounds
@@ -76,8 +82,7 @@ class LockUnlockPairs {
     private:
 	FuncLocalLockCalls calls;
 
-	/// Vector of vectors of lockUnlockPairs. Each internal vector
-	/// represents the pairs for a certain function that uses pthread lock
-	/// and unlock
-	std::vector<std::vector<lockUnlockPair *>*> funcPairs;
+	/// Every pair found. The function index of a pair is the index of the
+	/// function in calls
+	PairTable pairs;
 };
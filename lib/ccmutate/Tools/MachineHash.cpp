@@ -0,0 +1,165 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file MachineHash.cpp
+ * \author Markus Kusano
+ *
+ * See MachineHash.h for more information
+ */
+#include "MachineHash.h"
+#include "StructuralHash.h"
+#include "llvm/DataLayout.h"
+#include "llvm/PassManager.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetLibraryInfo.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+//#define MUT_DEBUG
+
+bool MachineHash::run(const Module &M, const std::string &triple,
+        const std::string &cpu, std::string &error) {
+    static bool initialized = false;
+    if (!initialized) {
+        // opt only registers the targets, the asm printers are needed too
+        InitializeAllTargetInfos();
+        InitializeAllTargets();
+        InitializeAllTargetMCs();
+        InitializeAllAsmPrinters();
+        initialized = true;
+    }
+
+    std::string targetTriple = triple;
+    if (targetTriple.empty()) {
+        targetTriple = M.getTargetTriple();
+    }
+    if (targetTriple.empty()) {
+        targetTriple = sys::getDefaultTargetTriple();
+    }
+
+    const Target *target = TargetRegistry::lookupTarget(targetTriple, error);
+    if (target == NULL) {
+        return false;
+    }
+    TargetOptions options;
+    OwningPtr<TargetMachine> TM(target->createTargetMachine(targetTriple,
+                cpu, "", options, Reloc::Default, CodeModel::Default,
+                CodeGenOpt::Default));
+    if (!TM) {
+        error = "unable to create a target machine for " + targetTriple;
+        return false;
+    }
+
+    // Code generation changes the IR it runs on, so lower a copy
+    OwningPtr<Module> copy(CloneModule(&M));
+    copy->setTargetTriple(targetTriple);
+
+    std::string assembly;
+    {
+        raw_string_ostream os(assembly);
+        formatted_raw_ostream fos(os);
+
+        PassManager PM;
+        PM.add(new TargetLibraryInfo(Triple(targetTriple)));
+        if (const DataLayout *DL = TM->getDataLayout()) {
+            PM.add(new DataLayout(*DL));
+        }
+        else {
+            PM.add(new DataLayout(copy.get()));
+        }
+        if (TM->addPassesToEmitFile(PM, fos, TargetMachine::CGFT_AssemblyFile)) {
+            error = "target " + targetTriple + " cannot emit assembly";
+            return false;
+        }
+        PM.run(*copy);
+    }
+
+    hashAssembly(M, assembly, TM->getMCAsmInfo()->getCommentString());
+    return true;
+}
+
+uint64_t MachineHash::getModuleHash() const {
+    return moduleHash;
+}
+
+const std::vector<MachineHash::FunctionHash> &MachineHash::getFunctionHashes() const {
+    return funcHashes;
+}
+
+// Returns true if the label is a basic block label. Other local labels (e.g.
+// .Ltmp used by debug information) are ignored.
+static bool isBlockLabel(StringRef label) {
+    return label.startswith(".LBB") || label.startswith("LBB");
+}
+
+void MachineHash::hashAssembly(const Module &M, StringRef assembly,
+        StringRef comment) {
+    // Symbol of every defined function. Some targets prefix symbols with _
+    DenseMap<StringRef, unsigned> symbols;
+    funcHashes.clear();
+    for (Module::const_iterator F = M.begin(), E = M.end(); F != E; ++F) {
+        if (!F->isDeclaration()) {
+            symbols[F->getName()] = funcHashes.size();
+            funcHashes.push_back(FunctionHash(0, F->getName().str()));
+        }
+    }
+
+    std::vector<FnvHash> hashes(funcHashes.size());
+    int cur = -1; // function being read, -1 outside of a function
+    while (!assembly.empty()) {
+        std::pair<StringRef, StringRef> split = assembly.split('\n');
+        StringRef line = split.first.trim();
+        assembly = split.second;
+
+        if (line.empty() || line.startswith(comment)) {
+            continue;
+        }
+        if (line.endswith(":")) {
+            StringRef label = line.drop_back(1).trim("\"");
+            DenseMap<StringRef, unsigned>::iterator i = symbols.find(label);
+            if (i == symbols.end() && label.startswith("_")) {
+                i = symbols.find(label.substr(1));
+            }
+            if (i != symbols.end()) {
+                cur = i->second;
+            }
+            else if (cur != -1 && isBlockLabel(label)) {
+                hashes[cur].add(label);
+            }
+            continue;
+        }
+        if (line[0] == '.') {
+            // A directive. .size ends the function on ELF targets
+            if (line.startswith(".size") || line.startswith(".cfi_endproc")) {
+                cur = -1;
+            }
+            continue;
+        }
+        if (cur == -1) {
+            continue;
+        }
+        // An instruction, without its trailing comment
+        line = line.substr(0, line.find(comment)).rtrim();
+#ifdef MUT_DEBUG
+        errs() << "DEBUG: " << funcHashes[cur].second << ": " << line << '\n';
+#endif
+        hashes[cur].add(line);
+    }
+
+    FnvHash module;
+    for (unsigned i = 0; i < funcHashes.size(); i++) {
+        funcHashes[i].first = hashes[i].get();
+        module.add(funcHashes[i].first);
+    }
+    moduleHash = module.get();
+}
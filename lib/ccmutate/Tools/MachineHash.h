@@ -0,0 +1,55 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file MachineHash.h
+ * \author Markus Kusano
+ *
+ * Hash of the machine code a module lowers to, used to find mutants that are
+ * only different in the IR.
+ *
+ * Many memory ordering mutants produce the same instructions on a given
+ * target; on x86-64 (TSO) acquire loads, release stores and seq_cst loads are
+ * all plain moves and every atomic RMW is a locked instruction. Such mutants
+ * can never be killed on that target.
+ *
+ * A copy of the module is lowered to assembly in process and the instructions
+ * and basic block labels of each defined function are hashed. Directives,
+ * comments and debug labels are ignored so debug information does not make
+ * otherwise equal functions differ.
+ */
+#pragma once
+#include "llvm/Module.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+
+class MachineHash {
+    public:
+        /// Hash and name of a function defined in the module
+        typedef std::pair<uint64_t, std::string> FunctionHash;
+
+        /// Lower a copy of M for triple (the triple of M, or the host if M
+        /// has none, when empty) and cpu (generic when empty). Returns false
+        /// and sets error if the target cannot be created.
+        bool run(const Module &M, const std::string &triple,
+                const std::string &cpu, std::string &error);
+
+        /// Combined hash of every function in module order
+        uint64_t getModuleHash() const;
+
+        /// Hash of each function defined in the module, in module order
+        const std::vector<FunctionHash> &getFunctionHashes() const;
+
+    private:
+        uint64_t moduleHash;
+        std::vector<FunctionHash> funcHashes;
+
+        /// Split the assembly into functions and hash them. comment starts
+        /// a comment in the assembly of the target.
+        void hashAssembly(const Module &M, StringRef assembly, StringRef comment);
+};
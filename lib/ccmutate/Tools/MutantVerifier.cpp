@@ -0,0 +1,113 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file MutantVerifier.cpp
+ * \author Markus Kusano
+ *
+ * See MutantVerifier.h for more information
+ */
+#include "MutantVerifier.h"
+#include "llvm/BasicBlock.h"
+#include "llvm/Analysis/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdlib>
+#include <string>
+
+//#define MUT_DEBUG
+
+/// Command line option: verify every mutant before it is written. On by
+/// default since only the mutated functions are checked.
+static cl::opt<bool> verifyMutant("verify-mutant",
+        cl::desc("verify the functions changed by a mutation before writing it"),
+        cl::init(true));
+
+/// Command line option: file rejected mutants are appended to. Defaults to
+/// stderr.
+static cl::opt<std::string> rejectLog("reject-log",
+        cl::desc("file to append mutants that fail verification to"),
+        cl::value_desc("filename"),
+        cl::init(""));
+
+void MutantVerifier::touch(Instruction *I) {
+    if (I != NULL && I->getParent() != NULL) {
+        touched.insert(I->getParent()->getParent());
+    }
+}
+
+void MutantVerifier::touch(Function *F) {
+    if (F != NULL) {
+        touched.insert(F);
+    }
+}
+
+void MutantVerifier::touch(const FunctionSet &funcs) {
+    for (FunctionSet::const_iterator i = funcs.begin(), e = funcs.end(); i != e; ++i) {
+        touched.insert(*i);
+    }
+}
+
+void MutantVerifier::check(Module &M, StringRef passName) {
+    if (!verifyMutant) {
+        return;
+    }
+#ifdef MUT_DEBUG
+    errs() << "DEBUG: verifying " << touched.size() << " mutated functions\n";
+#endif
+    for (FunctionSet::iterator i = touched.begin(), e = touched.end(); i != e; ++i) {
+        if (verifyFunction(**i, ReturnStatusAction)) {
+            reject(M, passName, (*i)->getName());
+        }
+    }
+
+    // verifyFunction() does not take declarations. A call to a declaration
+    // is checked against its type with the calling function, what is left is
+    // the linkage the module verifier requires of a declaration. A broken
+    // one is described by verifyModule() in reject().
+    for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+        if (F->isDeclaration() && !F->hasExternalLinkage()
+                && !F->hasDLLImportLinkage() && !F->hasExternalWeakLinkage()) {
+            reject(M, passName, F->getName());
+        }
+    }
+}
+
+void MutantVerifier::reject(Module &M, StringRef passName, StringRef funcName) {
+    // The verifier only describes the problem when checking a whole module.
+    // This is only done for broken mutants so the cost does not matter
+    std::string reason;
+    verifyModule(M, ReturnStatusAction, &reason);
+
+    std::string errorInfo;
+    raw_ostream *log = &errs();
+    raw_fd_ostream *file = NULL;
+    if (!rejectLog.empty()) {
+        file = new raw_fd_ostream(rejectLog.c_str(), errorInfo, raw_fd_ostream::F_Append);
+        if (!errorInfo.empty()) {
+            errs() << "Warning: unable to open rejection log " << rejectLog
+                   << ": " << errorInfo << '\n';
+            delete file;
+            file = NULL;
+        }
+        else {
+            log = file;
+        }
+    }
+
+    // One header line followed by the verifier output, indented
+    *log << "rejected\t" << M.getModuleIdentifier() << '\t' << passName << '\t'
+         << funcName << '\n';
+    StringRef rest(reason);
+    while (!rest.empty()) {
+        std::pair<StringRef, StringRef> line = rest.split('\n');
+        *log << '\t' << line.first << '\n';
+        rest = line.second;
+    }
+    delete file;
+
+    errs() << "Error: " << passName << " produced a malformed mutant in "
+           << funcName << ", see the rejection log\n";
+    exit(EXIT_FAILURE);
+}
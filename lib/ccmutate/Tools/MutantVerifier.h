@@ -0,0 +1,52 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file MutantVerifier.h
+ * \author Markus Kusano
+ *
+ * Verify a mutant before it is written.
+ *
+ * The operators record every function they change with touch() and call
+ * check() once they are done. Only the touched functions are verified, along
+ * with the linkage of the function declarations of the module (mutations can
+ * add declarations, e.g. a call to sleep()). The operators never change
+ * global variables or other functions, so this is enough to catch malformed
+ * mutants and costs a fraction of verifying the whole module.
+ *
+ * A broken mutant is appended to the rejection log (-reject-log, stderr by
+ * default) and the program exits with EXIT_FAILURE before opt writes any
+ * bitcode. A shell redirect has already created the output file by then, so
+ * the scripts delete it when opt fails (see scripts/mutate_rmMutex.sh).
+ * Checking is on by default and can be turned off with -verify-mutant=false.
+ */
+#pragma once
+#include "llvm/Module.h"
+#include "llvm/Function.h"
+#include "llvm/Instruction.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringRef.h"
+
+using namespace llvm;
+
+class MutantVerifier {
+    public:
+        typedef SmallPtrSet<Function *, 16> FunctionSet;
+
+        /// Record that I is about to be changed. Must be called before I is
+        /// erased from its parent.
+        void touch(Instruction *I);
+        void touch(Function *F);
+        void touch(const FunctionSet &funcs);
+
+        /// Verify the touched functions and the declarations of M. On failure
+        /// the mutant is logged as rejected and the program exits. passName
+        /// is only used in the log.
+        void check(Module &M, StringRef passName);
+
+    private:
+        FunctionSet touched;
+
+        /// Append a rejection of M by passName to the rejection log
+        void reject(Module &M, StringRef passName, StringRef funcName);
+};
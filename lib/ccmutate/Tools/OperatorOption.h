@@ -0,0 +1,25 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file OperatorOption.h
+ * \author Markus Kusano
+ *
+ * Names of the command line options of an operator.
+ *
+ * Every operator registers its options with MUTATE_OPT("name"). In the plugin
+ * of a single operator (e.g. mutate_Mutex.so) the name is used as is, -pos.
+ * The combined plugin (see All/README.md) builds every operator into one
+ * module and defines MUTATE_PREFIX to the name of the operator followed by a
+ * dash for each, so the options of different operators do not clash and are
+ * passed as -Mutex-pos, -Fence-pos, ... The options of the tools library
+ * (-filter-*, -threads, -reject-log, ...) are not prefixed and apply to every
+ * operator in the pipeline.
+ */
+#pragma once
+
+#ifndef MUTATE_PREFIX
+#define MUTATE_PREFIX ""
+#endif
+
+#define MUTATE_OPT(name) MUTATE_PREFIX name
@@ -0,0 +1,56 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file PairConflicts.cpp
+ * \author Markus Kusano
+ *
+ * See PairConflicts.h for more information
+ */
+#include "PairConflicts.h"
+
+const char *PairConflict::getReasonName(Reason reason) {
+    return reason == Shared ? "shared" : "overlap";
+}
+
+// Sets first and last to the calls of the pair in program order. The unlock
+// can come first, e.g. when the pair spans a loop back edge.
+static void getSection(const PairTable &pairs, unsigned pair, ProgramOrder &PO,
+        Instruction *&first, Instruction *&last) {
+    first = pairs.getLock(pair);
+    last = pairs.getUnlock(pair);
+    if (PO.comesBefore(last, first)) {
+        std::swap(first, last);
+    }
+}
+
+void findPairConflicts(const PairTable &pairs, unsigned kind, ProgramOrder &PO,
+        std::vector<PairConflict> &conflicts) {
+    unsigned n = pairs.getNumOfKind(kind);
+    for (unsigned i = 0; i < n; i++) {
+        unsigned p1 = pairs.lookupByKind(kind, i);
+        Instruction *first1;
+        Instruction *last1;
+        getSection(pairs, p1, PO, first1, last1);
+
+        // Pairs are added function by function, so the pairs of a kind in
+        // the same function are next to each other
+        for (unsigned j = i + 1; j < n; j++) {
+            unsigned p2 = pairs.lookupByKind(kind, j);
+            if (pairs.getFunc(p1) != pairs.getFunc(p2)) {
+                break;
+            }
+            if (pairs.getLock(p1) == pairs.getLock(p2)
+                    || pairs.getUnlock(p1) == pairs.getUnlock(p2)) {
+                conflicts.push_back(PairConflict(i, j, PairConflict::Shared));
+                continue;
+            }
+            Instruction *first2;
+            Instruction *last2;
+            getSection(pairs, p2, PO, first2, last2);
+            if (PO.comesBefore(first1, last2) && PO.comesBefore(first2, last1)) {
+                conflicts.push_back(PairConflict(i, j, PairConflict::Overlap));
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file PairConflicts.h
+ * \author Markus Kusano
+ *
+ * Conflict graph of the lock-unlock pairs of one kind, used by -conflicts in
+ * the Mutex operator so the combinations tool only picks sets of pairs that
+ * can be mutated together.
+ *
+ * Two pairs conflict if they
+ *  - share their lock or unlock call (shared): -swap skips such pairs, and
+ *    mutating both in one mutant changes the same call twice,
+ *  - are in the same function and their critical sections overlap in program
+ *    order (overlap).
+ *
+ * Pairs in different functions never conflict.
+ */
+#pragma once
+#include "PairTable.h"
+#include "ProgramOrder.h"
+
+#include <vector>
+
+using namespace llvm;
+
+struct PairConflict {
+    enum Reason {
+        Shared,
+        Overlap
+    };
+
+    /// Indices of the two pairs among the pairs of their kind, a < b
+    unsigned a;
+    unsigned b;
+    Reason reason;
+
+    PairConflict(unsigned a, unsigned b, Reason reason)
+        : a(a), b(b), reason(reason) { }
+
+    /// "shared" or "overlap"
+    static const char *getReasonName(Reason reason);
+};
+
+/// Appends every conflict between two pairs of the passed kind to conflicts,
+/// sorted by a then b. PO is the program order of the module of the pairs.
+void findPairConflicts(const PairTable &pairs, unsigned kind, ProgramOrder &PO,
+        std::vector<PairConflict> &conflicts);
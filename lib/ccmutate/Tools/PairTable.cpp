@@ -0,0 +1,172 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file PairTable.cpp
+ * \author Markus Kusano
+ *
+ * See PairTable.h for more information
+ */
+#include "PairTable.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdlib>
+
+//#define MUT_DEBUG
+
+PairTable::PairTable() {
+    lockSites = NULL;
+    unlockSites = NULL;
+    kinds = NULL;
+    funcs = NULL;
+    kindOrder = NULL;
+    funcStart = NULL;
+    numPairs = 0;
+    capacity = 0;
+    numFuncs = 0;
+    for (unsigned i = 0; i <= NumKinds; i++) {
+        kindStart[i] = 0;
+    }
+}
+
+void PairTable::reserve(unsigned maxPairs, unsigned numFuncs) {
+    if (lockSites != NULL) {
+        errs() << "Error: PairTable::reserve() called more than once\n";
+        exit(EXIT_FAILURE);
+    }
+#ifdef MUT_DEBUG
+    errs() << "DEBUG: reserving " << maxPairs << " pairs in " << numFuncs
+           << " functions\n";
+#endif
+    capacity = maxPairs;
+    this->numFuncs = numFuncs;
+
+    // Allocate at least one element so a reserved table is never NULL
+    lockSites = arena.Allocate<Instruction *>(maxPairs + 1);
+    unlockSites = arena.Allocate<Instruction *>(maxPairs + 1);
+    kinds = arena.Allocate<unsigned char>(maxPairs + 1);
+    funcs = arena.Allocate<unsigned>(maxPairs + 1);
+    kindOrder = arena.Allocate<unsigned>(maxPairs + 1);
+    funcStart = arena.Allocate<unsigned>(numFuncs + 1);
+}
+
+void PairTable::add(Instruction *lock, Instruction *unlock, unsigned func) {
+    if (numPairs == capacity) {
+        errs() << "Error: PairTable is full, more pairs found than reserved\n";
+        exit(EXIT_FAILURE);
+    }
+    if (func >= numFuncs || (numPairs > 0 && func < funcs[numPairs - 1])) {
+        errs() << "Error: PairTable::add() function index out of order\n";
+        exit(EXIT_FAILURE);
+    }
+    lockSites[numPairs] = lock;
+    unlockSites[numPairs] = unlock;
+    kinds[numPairs] = getKindOf(lock, unlock);
+    funcs[numPairs] = func;
+    numPairs++;
+}
+
+void PairTable::finish() {
+    if (lockSites == NULL) {
+        // Nothing was reserved, the module has no lock calls
+        return;
+    }
+
+    // Counting sort on the kind. Going through the pairs in order keeps the
+    // pairs of each kind in the order they were found
+    unsigned count[NumKinds];
+    for (unsigned k = 0; k < NumKinds; k++) {
+        count[k] = 0;
+    }
+    for (unsigned i = 0; i < numPairs; i++) {
+        count[kinds[i]]++;
+    }
+    kindStart[0] = 0;
+    for (unsigned k = 0; k < NumKinds; k++) {
+        kindStart[k + 1] = kindStart[k] + count[k];
+        count[k] = kindStart[k];
+    }
+    for (unsigned i = 0; i < numPairs; i++) {
+        kindOrder[count[kinds[i]]++] = i;
+    }
+
+    // The pairs are added in function order so each function is one range
+    unsigned cur = 0;
+    for (unsigned f = 0; f < numFuncs; f++) {
+        funcStart[f] = cur;
+        while (cur < numPairs && funcs[cur] == f) {
+            cur++;
+        }
+    }
+    funcStart[numFuncs] = numPairs;
+}
+
+unsigned PairTable::size() const {
+    return numPairs;
+}
+
+Instruction *PairTable::getLock(unsigned pair) const {
+    return lockSites[pair];
+}
+
+Instruction *PairTable::getUnlock(unsigned pair) const {
+    return unlockSites[pair];
+}
+
+PairTable::PairKind PairTable::getKind(unsigned pair) const {
+    return (PairKind) kinds[pair];
+}
+
+unsigned PairTable::getFunc(unsigned pair) const {
+    return funcs[pair];
+}
+
+bool PairTable::lockIsCall(unsigned pair) const {
+    return kinds[pair] == CallCall || kinds[pair] == CallInvoke;
+}
+
+bool PairTable::unlockIsCall(unsigned pair) const {
+    return kinds[pair] == CallCall || kinds[pair] == InvokeCall;
+}
+
+unsigned PairTable::getNumOfKind(unsigned kind) const {
+    if (kind >= NumKinds) {
+        return 0;
+    }
+    return kindStart[kind + 1] - kindStart[kind];
+}
+
+int PairTable::lookupByKind(unsigned kind, unsigned index) const {
+    if (index >= getNumOfKind(kind)) {
+        return -1;
+    }
+    return kindOrder[kindStart[kind] + index];
+}
+
+unsigned PairTable::getNumFuncs() const {
+    return numFuncs;
+}
+
+unsigned PairTable::getNumInFunc(unsigned func) const {
+    if (func >= numFuncs) {
+        return 0;
+    }
+    return funcStart[func + 1] - funcStart[func];
+}
+
+int PairTable::lookupByFunc(unsigned func, unsigned index) const {
+    if (index >= getNumInFunc(func)) {
+        return -1;
+    }
+    return funcStart[func] + index;
+}
+
+PairTable::PairKind PairTable::getKindOf(Instruction *lock, Instruction *unlock) {
+    bool lockCall = isa<CallInst>(lock);
+    bool unlockCall = isa<CallInst>(unlock);
+
+    if (lockCall) {
+        return unlockCall ? CallCall : CallInvoke;
+    }
+    return unlockCall ? InvokeCall : InvokeInvoke;
+}
@@ -0,0 +1,113 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file PairTable.h
+ * \author Markus Kusano
+ *
+ * Compact table of lock-unlock pairs shared by the Mutex and PosixLock
+ * operators.
+ *
+ * The table is stored as parallel arrays (lock site, unlock site, kind and
+ * function index) allocated from a BumpPtrAllocator. The caller gives an upper
+ * bound on the number of pairs with reserve() so every array is allocated once
+ * per module instead of once per pair.
+ *
+ * Pairs must be added in the order they are found (function by function).
+ * Once finish() is called two views of the table are available:
+ *
+ *  - by kind: the index of a pair among the pairs of the same PairKind. This
+ *    is the (type, index) addressing used by -pos in the Mutex operator.
+ *  - by function: the index of a pair among the pairs of the same function.
+ *    This is the (function, index) addressing used by -pos in the PosixLock
+ *    operator.
+ *
+ * Both views keep the order the pairs were added in.
+ */
+#pragma once
+#include "llvm/Instructions.h"
+#include "llvm/Support/Allocator.h"
+
+using namespace llvm;
+
+class PairTable {
+    public:
+        /// Kind of a pair, based on the lock and unlock site being either a
+        /// CallInst or an InvokeInst. The values are the first number of a
+        /// Mutex -pos pair.
+        enum PairKind {
+            CallCall = 0,
+            CallInvoke = 1,
+            InvokeCall = 2,
+            InvokeInvoke = 3,
+            NumKinds = 4
+        };
+
+        PairTable();
+
+        /// Allocate room for at most maxPairs pairs in numFuncs functions.
+        /// Must be called once before add().
+        void reserve(unsigned maxPairs, unsigned numFuncs);
+
+        /// Add a pair. lock and unlock must be CallInsts or InvokeInsts and
+        /// func must not be less than the function of the previous pair.
+        void add(Instruction *lock, Instruction *unlock, unsigned func);
+
+        /// Build the by kind and by function views. Call once all pairs have
+        /// been added.
+        void finish();
+
+        /// Total number of pairs
+        unsigned size() const;
+
+        Instruction *getLock(unsigned pair) const;
+        Instruction *getUnlock(unsigned pair) const;
+        PairKind getKind(unsigned pair) const;
+        unsigned getFunc(unsigned pair) const;
+
+        /// Returns true if the lock (or unlock) site of the pair is a
+        /// CallInst, otherwise it is an InvokeInst.
+        bool lockIsCall(unsigned pair) const;
+        bool unlockIsCall(unsigned pair) const;
+
+        /// Number of pairs of the passed kind, 0 if kind is out-of-bounds
+        unsigned getNumOfKind(unsigned kind) const;
+
+        /// Returns the pair that is the index'th pair of the passed kind. -1
+        /// if either value is out-of-bounds.
+        int lookupByKind(unsigned kind, unsigned index) const;
+
+        /// Number of functions passed to reserve()
+        unsigned getNumFuncs() const;
+
+        /// Number of pairs in the passed function, 0 if func is out-of-bounds
+        unsigned getNumInFunc(unsigned func) const;
+
+        /// Returns the pair that is the index'th pair of the passed function.
+        /// -1 if either value is out-of-bounds.
+        int lookupByFunc(unsigned func, unsigned index) const;
+
+        /// Kind of a pair with the passed lock and unlock sites
+        static PairKind getKindOf(Instruction *lock, Instruction *unlock);
+
+    private:
+        BumpPtrAllocator arena;
+
+        // One entry per pair
+        Instruction **lockSites;
+        Instruction **unlockSites;
+        unsigned char *kinds;
+        unsigned *funcs;
+
+        unsigned numPairs;
+        unsigned capacity;
+        unsigned numFuncs;
+
+        /// Pair indices sorted (stably) by kind. The pairs of kind k are
+        /// kindOrder[kindStart[k]] to kindOrder[kindStart[k + 1] - 1]
+        unsigned *kindOrder;
+        unsigned kindStart[NumKinds + 1];
+
+        /// The pairs of function f are funcStart[f] to funcStart[f + 1] - 1
+        unsigned *funcStart;
+};
@@ -0,0 +1,21 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ParallelVisit.cpp
+ * \author Markus Kusano
+ *
+ * The -threads option shared by every operator using parallelVisit(). See
+ * ParallelVisit.h for more information
+ */
+#include "ParallelVisit.h"
+#include "llvm/Support/CommandLine.h"
+
+static cl::opt<unsigned> numThreads("threads",
+        cl::desc("number of threads used to enumerate instructions, 0 uses one per core"),
+        cl::value_desc("unsigned int"),
+        cl::init(1));
+
+unsigned getVisitThreads() {
+    return numThreads;
+}
@@ -0,0 +1,116 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ParallelVisit.h
+ * \author Markus Kusano
+ *
+ * Run an InstVisitor over a module using a ThreadPool.
+ *
+ * Each function with a body is visited by its own copy of the visitor. The
+ * copies are made from the passed visitor so settings such as onlyAtomic carry
+ * over; it should not have visited anything yet. Once every function is done
+ * the copies are merged back into the passed visitor in module order, so the
+ * indices are the same as calling visit(M) directly.
+ *
+ * The number of workers is given by the -threads option (0 uses one per core)
+ * unless it is passed explicitly.
+ *
+ * Functions outside of the -filter-* options (see SourceScope.h) are not
+ * visited. Filters on single instructions (-skip-single-threaded,
+ * -skip-unshared) are applied once every function is done.
+ *
+ * VisitorTy must be copyable, only read the IR while visiting and provide
+ *
+ *     void merge(const VisitorTy &other);
+ *
+ * which appends the results of other to the visitor, and
+ *
+ *     void filter(SourceScope &scope);
+ *
+ * which removes the instructions outside of scope (see removeOutOfScope()).
+ */
+#pragma once
+#include "ThreadPool.h"
+#include "SourceScope.h"
+#include "llvm/Module.h"
+#include "llvm/Function.h"
+
+#include <vector>
+
+using namespace llvm;
+
+/// Value of the -threads option
+unsigned getVisitThreads();
+
+template <typename VisitorTy>
+struct ParallelVisitArgs {
+    std::vector<Function *> *funcs;
+    std::vector<VisitorTy> *results;
+};
+
+template <typename VisitorTy>
+void parallelVisitTask(unsigned index, void *arg) {
+    ParallelVisitArgs<VisitorTy> *args = (ParallelVisitArgs<VisitorTy> *) arg;
+    (*args->results)[index].visit(*(*args->funcs)[index]);
+}
+
+/// Visit funcs with copies of V on numThreads workers and merge the results
+/// back into V in order
+template <typename VisitorTy>
+void parallelVisitFuncs(std::vector<Function *> &funcs, VisitorTy &V,
+        unsigned numThreads) {
+    // One result per function so the workers never share a visitor
+    std::vector<VisitorTy> results(funcs.size(), V);
+
+    ParallelVisitArgs<VisitorTy> args;
+    args.funcs = &funcs;
+    args.results = &results;
+
+    ThreadPool pool(numThreads);
+    pool.run(funcs.size(), &parallelVisitTask<VisitorTy>, &args);
+
+    for (unsigned i = 0; i < results.size(); i++) {
+        V.merge(results[i]);
+    }
+}
+
+/// Visit every function in M with V using numThreads workers (0 uses one per
+/// core). With one thread and no filters this is the same as V.visit(M).
+template <typename VisitorTy>
+void parallelVisit(Module &M, VisitorTy &V, unsigned numThreads) {
+    if (numThreads == 1 && !SourceScope::isActive()) {
+        V.visit(M);
+        return;
+    }
+
+    SourceScope scope;
+    std::vector<Function *> funcs;
+    for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+        if (!F->isDeclaration() && scope.contains(&*F)) {
+            funcs.push_back(&*F);
+        }
+    }
+
+    if (numThreads == 1) {
+        for (unsigned i = 0; i < funcs.size(); i++) {
+            V.visit(*funcs[i]);
+        }
+    }
+    else {
+        parallelVisitFuncs(funcs, V, numThreads);
+    }
+
+    // Instruction filters use analyses that are not safe to share between
+    // the workers
+    if (SourceScope::filtersInstructions()) {
+        V.filter(scope);
+    }
+}
+
+/// Visit every function in M with V using the number of workers given by
+/// -threads
+template <typename VisitorTy>
+void parallelVisit(Module &M, VisitorTy &V) {
+    parallelVisit(M, V, getVisitThreads());
+}
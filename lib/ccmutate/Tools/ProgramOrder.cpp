@@ -0,0 +1,84 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ProgramOrder.cpp
+ * \author Markus Kusano
+ *
+ * See ProgramOrder.h for more information
+ */
+#include "ProgramOrder.h"
+#include "llvm/Support/raw_ostream.h"
+
+//#define MUT_DEBUG
+
+ProgramOrder::ProgramOrder(Module &M) : mod(M) { }
+
+bool ProgramOrder::comesBefore(const Instruction *a, const Instruction *b) {
+    const Function *funcA;
+    const Function *funcB;
+    funcA = a->getParent()->getParent();
+    funcB = b->getParent()->getParent();
+
+    if (funcA != funcB) {
+        return getFuncIndex(funcA) < getFuncIndex(funcB);
+    }
+    return getInstIndex(a) < getInstIndex(b);
+}
+
+unsigned ProgramOrder::getFuncIndex(const Function *F) {
+    if (funcIndex.empty()) {
+        // Walking the function list is cheap compared to walking every
+        // instruction so all of the functions are numbered at once
+        unsigned index = 0;
+        for (Module::iterator I = mod.begin(), E = mod.end(); I != E; ++I) {
+            funcIndex[&*I] = index++;
+        }
+    }
+    return funcIndex.lookup(F);
+}
+
+unsigned ProgramOrder::getInstIndex(const Instruction *I) {
+    const Function *F;
+    F = I->getParent()->getParent();
+
+    if (!numberedFuncs.count(F)) {
+#ifdef MUT_DEBUG
+        errs() << "DEBUG: numbering instructions of " << F->getName() << '\n';
+#endif
+        unsigned index = 0;
+        for (Function::const_iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB) {
+            for (BasicBlock::const_iterator II = BB->begin(), IE = BB->end();
+                    II != IE; ++II) {
+                instIndex[&*II] = index++;
+            }
+        }
+        numberedFuncs.insert(F);
+    }
+    return instIndex.lookup(I);
+}
+
+void collectCallSites(Function *F, std::vector<CallInst *> &calls,
+        std::vector<InvokeInst *> &invokes, SourceScope &scope) {
+    // The same instruction can use F more than once (eg F is also passed as
+    // an argument) so keep track of what has been added already
+    SmallPtrSet<Instruction *, 32> seen;
+
+    for (Value::use_iterator UI = F->use_begin(), UE = F->use_end(); UI != UE; ++UI) {
+        User *U = *UI;
+        if (CallInst *callInst = dyn_cast<CallInst>(U)) {
+            if (callInst->getCalledFunction() == F
+                    && scope.contains(callInst)
+                    && seen.insert(callInst)) {
+                calls.push_back(callInst);
+            }
+        }
+        else if (InvokeInst *invokeInst = dyn_cast<InvokeInst>(U)) {
+            if (invokeInst->getCalledFunction() == F
+                    && scope.contains(invokeInst)
+                    && seen.insert(invokeInst)) {
+                invokes.push_back(invokeInst);
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ProgramOrder.h
+ * \author Markus Kusano
+ *
+ * Helpers to enumerate call sites by walking the use list of the called
+ * function instead of visiting every instruction in the module.
+ *
+ * Use lists are not in program order, so the found instructions are sorted
+ * into the order an InstVisitor would have visited them (function order in
+ * the module, then basic block order, then instruction order). This keeps the
+ * indices passed to -pos the same as when the whole module was visited.
+ *
+ * Only the functions that actually contain a call site are numbered, so the
+ * cost scales with the functions containing synchronization calls rather than
+ * with the size of the module.
+ */
+#pragma once
+#include "SourceScope.h"
+#include "llvm/Module.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <vector>
+#include <algorithm>
+
+using namespace llvm;
+
+class ProgramOrder {
+    public:
+        ProgramOrder(Module &M);
+
+        /// Returns true if a is visited before b by an InstVisitor over the
+        /// module passed to the constructor.
+        bool comesBefore(const Instruction *a, const Instruction *b);
+
+    private:
+        Module &mod;
+
+        /// Index of every function in the module. Filled on first use.
+        DenseMap<const Function *, unsigned> funcIndex;
+
+        /// Index of an instruction inside of its function. Only functions
+        /// that have been queried are numbered.
+        DenseMap<const Instruction *, unsigned> instIndex;
+        SmallPtrSet<const Function *, 16> numberedFuncs;
+
+        unsigned getFuncIndex(const Function *F);
+        unsigned getInstIndex(const Instruction *I);
+};
+
+/// Comparator wrapper so ProgramOrder can be used with std::sort
+struct ProgramOrderLess {
+    ProgramOrder *order;
+    ProgramOrderLess(ProgramOrder &PO) : order(&PO) { }
+    bool operator()(const Instruction *a, const Instruction *b) const {
+        return order->comesBefore(a, b);
+    }
+};
+
+/// Appends every CallInst and InvokeInst that directly calls F to calls and
+/// invokes. Calls through a bitcast of F are not resolved, the same as
+/// getCalledFunction() returning NULL for them. Calls in functions outside of
+/// scope are skipped; share one scope between the calls for a module.
+void collectCallSites(Function *F, std::vector<CallInst *> &calls,
+        std::vector<InvokeInst *> &invokes, SourceScope &scope);
+
+/// Sorts insts into the order an InstVisitor would have found them
+template <typename InstTy>
+void sortInProgramOrder(std::vector<InstTy *> &insts, ProgramOrder &PO) {
+    std::sort(insts.begin(), insts.end(), ProgramOrderLess(PO));
+}
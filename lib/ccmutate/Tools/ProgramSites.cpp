@@ -0,0 +1,159 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ProgramSites.cpp
+ * \author Markus Kusano
+ *
+ * See ProgramSites.h for more information
+ */
+#include "ProgramSites.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Support/IRReader.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include <cstdlib>
+
+//#define MUT_DEBUG
+
+ProgramSites::ProgramSites() {
+    numClasses = 0;
+    curFile = 0;
+    built = false;
+}
+
+void ProgramSites::build(const std::vector<std::string> &files, Module &cur,
+        const std::string &curFile, unsigned numClasses, CountFunc count,
+        void *arg) {
+    this->files = files;
+    this->numClasses = numClasses;
+
+    bool found = false;
+    for (unsigned f = 0; f < files.size(); f++) {
+        if (files[f] == curFile) {
+            this->curFile = f;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        errs() << "Error: module " << curFile << " is not one of the program "
+                  "files, use -program-self to name it\n";
+        exit(EXIT_FAILURE);
+    }
+
+    offsets.assign((files.size() + 1) * numClasses, 0);
+    std::vector<unsigned> counts(numClasses);
+    LLVMContext &context = cur.getContext();
+
+    for (unsigned f = 0; f < files.size(); f++) {
+        counts.assign(numClasses, 0);
+        if (f == this->curFile) {
+            count(cur, &counts[0], arg);
+        }
+        else {
+            // Every body is read: the use lists of the primitives only list
+            // the calls of the bodies read so far. The module is dropped
+            // before the next file.
+            SMDiagnostic err;
+            Module *other = getLazyIRFileModule(files[f], err, context);
+            if (other == NULL) {
+                err.print("ProgramSites", errs());
+                exit(EXIT_FAILURE);
+            }
+            std::string errMsg;
+            if (other->MaterializeAll(&errMsg)) {
+                errs() << "Error: unable to read " << files[f] << ": "
+                       << errMsg << '\n';
+                exit(EXIT_FAILURE);
+            }
+            count(*other, &counts[0], arg);
+            delete other;
+        }
+#ifdef MUT_DEBUG
+        errs() << "DEBUG: counted " << files[f] << '\n';
+#endif
+        for (unsigned c = 0; c < numClasses; c++) {
+            offsets[(f + 1) * numClasses + c] = offsets[f * numClasses + c]
+                + counts[c];
+        }
+    }
+    built = true;
+}
+
+bool ProgramSites::isBuilt() const {
+    return built;
+}
+
+unsigned ProgramSites::getNumFiles() const {
+    return files.size();
+}
+
+const std::string &ProgramSites::getFile(unsigned file) const {
+    return files[file];
+}
+
+unsigned ProgramSites::getCurFile() const {
+    return curFile;
+}
+
+unsigned ProgramSites::getNumInFile(unsigned file, unsigned cls) const {
+    if (file >= files.size() || cls >= numClasses) {
+        return 0;
+    }
+    return getOffset(file + 1, cls) - getOffset(file, cls);
+}
+
+unsigned ProgramSites::getOffset(unsigned file, unsigned cls) const {
+    return offsets[file * numClasses + cls];
+}
+
+unsigned ProgramSites::getTotal(unsigned cls) const {
+    if (cls >= numClasses) {
+        return 0;
+    }
+    return getOffset(files.size(), cls);
+}
+
+int ProgramSites::findFile(unsigned cls, unsigned global) const {
+    if (global >= getTotal(cls)) {
+        return -1;
+    }
+    // Binary search for the last file starting at or before global. Files
+    // with no sites of the class share an offset with the next file so the
+    // last one is taken
+    unsigned lo = 0;
+    unsigned hi = files.size();
+    while (hi - lo > 1) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (getOffset(mid, cls) <= global) {
+            lo = mid;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int ProgramSites::toLocal(unsigned cls, unsigned global) const {
+    int file = findFile(cls, global);
+    if (file < 0) {
+        return -1;
+    }
+    if ((unsigned) file != curFile) {
+        return -2;
+    }
+    return global - getOffset(curFile, cls);
+}
+
+void ProgramSites::print(raw_ostream &O) const {
+    for (unsigned f = 0; f < files.size(); f++) {
+        for (unsigned c = 0; c < numClasses; c++) {
+            if (getNumInFile(f, c) != 0) {
+                O << files[f] << '\t' << c << '\t' << getOffset(f, c) << '\t'
+                  << getNumInFile(f, c) << '\n';
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ProgramSites.h
+ * \author Markus Kusano
+ *
+ * Number mutation sites across all the bitcode files of a program.
+ *
+ * A program made of several bitcode files is still mutated one file at a
+ * time, but its sites are numbered as if the files had been linked together
+ * in the order given. The other files are read one at a time into the
+ * context of the module being mutated. Each one is read whole (a call site is
+ * only known once the body calling it is read), counted with a function
+ * supplied by the caller and freed before the next file is read. The files
+ * are never linked, so at most one other module is in memory at a time.
+ *
+ * Sites are counted per class (e.g. the kind of a Mutex pair). The global
+ * index of a site is its index in its own file plus the number of sites of
+ * the same class in the files before it.
+ */
+#pragma once
+#include "llvm/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+class ProgramSites {
+    public:
+        /// Sets counts[c] to the number of sites of class c in M. counts has
+        /// one entry per class and is zeroed before the call.
+        typedef void (*CountFunc)(Module &M, unsigned *counts, void *arg);
+
+        ProgramSites();
+
+        /// Count the sites in every file of the program. cur is the module
+        /// being mutated and is counted directly instead of being loaded
+        /// again. curFile is the entry in files that cur was read from, if
+        /// it is not in files an error is printed and the program exits.
+        void build(const std::vector<std::string> &files, Module &cur,
+                const std::string &curFile, unsigned numClasses,
+                CountFunc count, void *arg);
+
+        /// Returns true once build() has been called
+        bool isBuilt() const;
+
+        unsigned getNumFiles() const;
+        const std::string &getFile(unsigned file) const;
+
+        /// Index of the file being mutated
+        unsigned getCurFile() const;
+
+        /// Number of sites of the passed class in the passed file
+        unsigned getNumInFile(unsigned file, unsigned cls) const;
+
+        /// Global index of the first site of the passed class in the passed
+        /// file
+        unsigned getOffset(unsigned file, unsigned cls) const;
+
+        /// Number of sites of the passed class in the whole program
+        unsigned getTotal(unsigned cls) const;
+
+        /// Returns the file the global index of the passed class is in. -1 if
+        /// either value is out-of-bounds.
+        int findFile(unsigned cls, unsigned global) const;
+
+        /// Converts a global index of the passed class to an index in the
+        /// file being mutated. Returns -1 if either value is out-of-bounds or
+        /// -2 if the site is in another file.
+        int toLocal(unsigned cls, unsigned global) const;
+
+        /// Print one line per file and class with sites:
+        /// <file>\t<class>\t<offset>\t<count>
+        void print(raw_ostream &O) const;
+
+    private:
+        std::vector<std::string> files;
+        unsigned numClasses;
+        unsigned curFile;
+        bool built;
+
+        /// offsets[f * numClasses + c] is the global index of the first site
+        /// of class c in file f. There is one extra row (f == files.size())
+        /// holding the totals.
+        std::vector<unsigned> offsets;
+};
@@ -0,0 +1,103 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file SiteCatalog.cpp
+ * \author Markus Kusano
+ *
+ * See SiteCatalog.h for more information
+ */
+#include "SiteCatalog.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdlib>
+
+//#define MUT_DEBUG
+
+SiteCatalog::SiteCatalog() : ModulePass(ID) {
+    order = NULL;
+}
+
+SiteCatalog::~SiteCatalog() {
+    releaseMemory();
+}
+
+bool SiteCatalog::runOnModule(Module &M) {
+    releaseMemory();
+    order = new ProgramOrder(M);
+    SourceScope scope;
+
+    for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+        SyncKind kind = classifyFunction(&*F);
+        if (kind == SK_None) {
+            continue;
+        }
+#ifdef MUT_DEBUG
+        errs() << "DEBUG: cataloging uses of " << F->getName() << '\n';
+#endif
+        collectCallSites(&*F, calls[kind], invokes[kind], scope);
+    }
+
+    // Several declarations can share a kind (e.g. libc++ and libstdc++
+    // symbols) so sort once everything is collected
+    for (unsigned k = 0; k < SK_NumKinds; k++) {
+        sortInProgramOrder(calls[k], *order);
+        sortInProgramOrder(invokes[k], *order);
+    }
+    return false;
+}
+
+void SiteCatalog::getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+}
+
+void SiteCatalog::releaseMemory() {
+    for (unsigned k = 0; k < SK_NumKinds; k++) {
+        calls[k].clear();
+        invokes[k].clear();
+    }
+    delete order;
+    order = NULL;
+}
+
+void SiteCatalog::print(raw_ostream &O, const Module *M) const {
+    for (unsigned k = SK_None + 1; k < SK_NumKinds; k++) {
+        if (calls[k].size() != 0 || invokes[k].size() != 0) {
+            O << getSyncKindName((SyncKind) k) << '\t' << calls[k].size()
+              << '\t' << invokes[k].size() << '\n';
+        }
+    }
+}
+
+const std::vector<CallInst *> &SiteCatalog::getCalls(SyncKind kind) const {
+    return calls[kind];
+}
+
+const std::vector<InvokeInst *> &SiteCatalog::getInvokes(SyncKind kind) const {
+    return invokes[kind];
+}
+
+void SiteCatalog::getCallSites(const SyncKind *kinds, unsigned numKinds,
+        std::vector<CallInst *> &outCalls,
+        std::vector<InvokeInst *> &outInvokes) const {
+    for (unsigned i = 0; i < numKinds; i++) {
+        outCalls.insert(outCalls.end(), calls[kinds[i]].begin(), calls[kinds[i]].end());
+        outInvokes.insert(outInvokes.end(), invokes[kinds[i]].begin(), invokes[kinds[i]].end());
+    }
+    if (numKinds > 1) {
+        sortInProgramOrder(outCalls, getProgramOrder());
+        sortInProgramOrder(outInvokes, getProgramOrder());
+    }
+}
+
+ProgramOrder &SiteCatalog::getProgramOrder() const {
+    if (order == NULL) {
+        errs() << "Error: SiteCatalog used before it was run\n";
+        exit(EXIT_FAILURE);
+    }
+    return *order;
+}
+
+char SiteCatalog::ID = 0;
+static RegisterPass<SiteCatalog> X("site-catalog",
+        "Catalog of synchronization call sites", false, true);
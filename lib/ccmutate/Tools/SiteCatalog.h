@@ -0,0 +1,70 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file SiteCatalog.h
+ * \author Markus Kusano
+ *
+ * Analysis pass cataloging every call to a synchronization primitive (see
+ * SyncSymbols.def) in a module.
+ *
+ * The catalog is built once per module by the pass manager and cached until a
+ * pass that does not preserve it changes the module. Calls are found from the
+ * use lists of the matching declarations and kept per SyncKind in the order an
+ * InstVisitor would find them, so indices are unchanged from visiting the
+ * whole module.
+ *
+ * Mutex, the ThreadContext printer and the operators finding their sites with
+ * EnumerateCallInst (PosixJoin, ThreadJoin, CondWait, PosixCondSignal,
+ * PosixYield, PosixSemaphore) use it. When several of them run in one opt
+ * invocation with the combined plugin (see All/README.md) they share a single
+ * catalog.
+ *
+ * Usage in a pass:
+ *
+ *     AU.addRequired<SiteCatalog>();
+ *     ...
+ *     SiteCatalog &catalog = getAnalysis<SiteCatalog>();
+ */
+#pragma once
+#include "SyncSymbols.h"
+#include "ProgramOrder.h"
+#include "llvm/Pass.h"
+#include "llvm/Module.h"
+#include "llvm/Instructions.h"
+
+#include <vector>
+
+using namespace llvm;
+
+struct SiteCatalog : public ModulePass {
+    static char ID;
+
+    SiteCatalog();
+    ~SiteCatalog();
+
+    virtual bool runOnModule(Module &M);
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+    virtual void releaseMemory();
+    virtual void print(raw_ostream &O, const Module *M) const;
+
+    /// Calls (or invokes) of the passed kind in program order
+    const std::vector<CallInst *> &getCalls(SyncKind kind) const;
+    const std::vector<InvokeInst *> &getInvokes(SyncKind kind) const;
+
+    /// Appends the calls and invokes of the numKinds passed kinds to calls
+    /// and invokes, each sorted in program order.
+    void getCallSites(const SyncKind *kinds, unsigned numKinds,
+            std::vector<CallInst *> &calls,
+            std::vector<InvokeInst *> &invokes) const;
+
+    /// Program order of the cataloged module. Only valid after runOnModule()
+    ProgramOrder &getProgramOrder() const;
+
+    private:
+        std::vector<CallInst *> calls[SK_NumKinds];
+        std::vector<InvokeInst *> invokes[SK_NumKinds];
+
+        /// Created by runOnModule(), numbers instructions lazily
+        ProgramOrder *order;
+};
@@ -0,0 +1,442 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file SourceScope.cpp
+ * \author Markus Kusano
+ *
+ * See SourceScope.h for more information
+ */
+#include "SourceScope.h"
+#include "FileInfo.h"
+#include "ItaniumDemangle.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Instructions.h"
+#include "llvm/Module.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InstIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/system_error.h"
+
+#include <climits>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+//#define MUT_DEBUG
+
+/// Command line option: only functions defined in a file matching one of the
+/// globs are in scope. `*` and `?` do not match `/`, `**` matches anything. A
+/// glob without a leading `/` may match the end of the path (`foo.c` matches
+/// `src/foo.c`).
+static cl::list<std::string> FilterFile("filter-file",
+        cl::desc("only mutate functions defined in files matching the glob"),
+        cl::value_desc("comma separated list of globs"),
+        cl::CommaSeparated);
+
+/// Command line option: only functions with a name matching one of the
+/// regular expressions are in scope. Both the symbol name and the demangled
+/// name are tried.
+static cl::list<std::string> FilterFunc("filter-func",
+        cl::desc("only mutate functions with a name matching the regex"),
+        cl::value_desc("comma separated list of regular expressions"),
+        cl::CommaSeparated);
+
+/// Command line option: unified diff (e.g. the output of git diff). Only
+/// functions with an instruction on a line added or changed by the diff are
+/// in scope.
+static cl::opt<std::string> FilterDiff("filter-diff",
+        cl::desc("only mutate functions touching lines changed by the diff"),
+        cl::value_desc("filename"),
+        cl::init(""));
+
+/// Command line option: only functions that can be called from main, a thread
+/// entry point or through a function pointer are in scope
+static cl::opt<bool> Reachable("reachable",
+        cl::desc("only mutate functions reachable from main or a thread entry point"),
+        cl::init(false));
+
+/// Command line option: the module is the whole program (e.g. linked with
+/// llvm-link), so with -reachable an externally visible function is only a
+/// root when the module has no main
+static cl::opt<bool> WholeProgram("whole-program",
+        cl::desc("with -reachable, the module is the whole program: functions "
+            "only called from outside of it are dead"),
+        cl::init(false));
+
+/// Command line option: call sites that only run while a single thread exists
+/// (see ThreadContext.h) are out of scope
+static cl::opt<bool> SkipSingleThreaded("skip-single-threaded",
+        cl::desc("do not mutate sites that run before the first thread is "
+            "created or after the final join"),
+        cl::init(false));
+
+/// Command line option: sites accessing only memory no other thread can reach
+/// (see ThreadEscape.h) are out of scope
+static cl::opt<bool> SkipUnshared("skip-unshared",
+        cl::desc("do not mutate locks and atomic accesses of objects that "
+            "never escape their thread"),
+        cl::init(false));
+
+namespace {
+// Changed line ranges (inclusive) of one file of a diff
+struct DiffFile {
+    std::string path;
+    std::vector<std::pair<unsigned, unsigned> > lines;
+};
+
+// The filters compiled from the command line. Regex cannot be copied so the
+// patterns are kept as pointers and live until the program exits.
+struct Filters {
+    bool parsed;
+    std::vector<Regex *> files;
+    std::vector<Regex *> funcs;
+    std::vector<DiffFile> diff;
+};
+}
+
+static Filters filters;
+
+// Translates a glob into an anchored regular expression
+static std::string globToRegex(StringRef glob) {
+    std::string re;
+    unsigned i = 0;
+    if (glob.startswith("/")) {
+        re = "^";
+    }
+    else {
+        re = "(^|/)";
+    }
+    for (; i < glob.size(); i++) {
+        char c = glob[i];
+        if (c == '*' && i + 1 < glob.size() && glob[i + 1] == '*') {
+            re += ".*";
+            i++;
+        }
+        else if (c == '*') {
+            re += "[^/]*";
+        }
+        else if (c == '?') {
+            re += "[^/]";
+        }
+        else if (StringRef("\\.^$|()[]{}+").find(c) != StringRef::npos) {
+            re += '\\';
+            re += c;
+        }
+        else {
+            re += c;
+        }
+    }
+    re += '$';
+    return re;
+}
+
+static Regex *compileRegex(const std::string &pattern, const char *option) {
+    std::string error;
+    Regex *re = new Regex(pattern);
+    if (!re->isValid(error)) {
+        errs() << "Error: invalid pattern in " << option << ": " << pattern
+               << ": " << error << '\n';
+        exit(EXIT_FAILURE);
+    }
+    return re;
+}
+
+// Returns the number at the start of s and removes it from s. UINT_MAX if s
+// does not start with a number.
+static unsigned consumeNumber(StringRef &s) {
+    unsigned n;
+    size_t len = s.find_first_not_of("0123456789");
+    if (len == 0 || s.substr(0, len).getAsInteger(10, n)) {
+        return UINT_MAX;
+    }
+    s = s.substr(len == StringRef::npos ? s.size() : len);
+    return n;
+}
+
+// Reads the line ranges of the new version of every file in a unified diff
+static void parseDiff(StringRef fileName, std::vector<DiffFile> &out) {
+    OwningPtr<MemoryBuffer> buf;
+    if (error_code ec = MemoryBuffer::getFile(fileName, buf)) {
+        errs() << "Error: unable to read -filter-diff " << fileName << ": "
+               << ec.message() << '\n';
+        exit(EXIT_FAILURE);
+    }
+
+    StringRef rest = buf->getBuffer();
+    DiffFile *cur = NULL;
+    while (!rest.empty()) {
+        std::pair<StringRef, StringRef> split = rest.split('\n');
+        StringRef line = split.first.rtrim("\r");
+        rest = split.second;
+
+        if (line.startswith("+++ ")) {
+            // New name of the file, up to a tab (timestamp) if any
+            StringRef path = line.substr(4).split('\t').first;
+            if (path == "/dev/null") {
+                cur = NULL;  // deleted, nothing left to mutate
+                continue;
+            }
+            if (path.startswith("b/")) {
+                path = path.substr(2);
+            }
+            out.push_back(DiffFile());
+            cur = &out.back();
+            cur->path = path.str();
+        }
+        else if (line.startswith("@@ ") && cur != NULL) {
+            // @@ -<old>[,<n>] +<start>[,<count>] @@
+            size_t plus = line.find(" +");
+            if (plus == StringRef::npos) {
+                continue;
+            }
+            StringRef range = line.substr(plus + 2);
+            unsigned start = consumeNumber(range);
+            unsigned count = 1;
+            if (range.startswith(",")) {
+                range = range.substr(1);
+                count = consumeNumber(range);
+            }
+            if (start == UINT_MAX || count == UINT_MAX) {
+                errs() << "Warning: malformed hunk in -filter-diff, skipping: "
+                       << line << '\n';
+                continue;
+            }
+            // A hunk that only deletes lines has a count of 0; keep the line
+            // the deletion is next to
+            if (count == 0) {
+                count = 1;
+            }
+            cur->lines.push_back(std::make_pair(start, start + count - 1));
+        }
+    }
+#ifdef MUT_DEBUG
+    for (unsigned i = 0; i < out.size(); i++) {
+        errs() << "DEBUG: -filter-diff " << out[i].path << ": "
+               << out[i].lines.size() << " hunks\n";
+    }
+#endif
+}
+
+static void parseFilters() {
+    if (filters.parsed) {
+        return;
+    }
+    filters.parsed = true;
+    for (unsigned i = 0; i < FilterFile.size(); i++) {
+        filters.files.push_back(compileRegex(globToRegex(FilterFile[i]), "-filter-file"));
+    }
+    for (unsigned i = 0; i < FilterFunc.size(); i++) {
+        filters.funcs.push_back(compileRegex(FilterFunc[i], "-filter-func"));
+    }
+    if (!FilterDiff.empty()) {
+        parseDiff(FilterDiff, filters.diff);
+    }
+}
+
+// Returns true if one path is the other with leading directories removed
+static bool samePathSuffix(StringRef a, StringRef b) {
+    if (a.size() < b.size()) {
+        std::swap(a, b);
+    }
+    if (!a.endswith(b)) {
+        return false;
+    }
+    return a.size() == b.size() || a[a.size() - b.size() - 1] == '/';
+}
+
+static bool matchesAny(const std::vector<Regex *> &res, StringRef s) {
+    for (unsigned i = 0; i < res.size(); i++) {
+        if (res[i]->match(s)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns the function called by a call site, looking through casts. NULL
+// for an indirect call.
+static Function *getCallee(Instruction *I) {
+    Value *callee;
+    if (CallInst *call = dyn_cast<CallInst>(I)) {
+        callee = call->getCalledValue();
+    }
+    else if (InvokeInst *invoke = dyn_cast<InvokeInst>(I)) {
+        callee = invoke->getCalledValue();
+    }
+    else {
+        return NULL;
+    }
+    return dyn_cast<Function>(callee->stripPointerCasts());
+}
+
+SourceScope::SourceScope() {
+    reachableModule = NULL;
+    threads = NULL;
+    threadsModule = NULL;
+}
+
+SourceScope::~SourceScope() {
+    delete threads;
+}
+
+bool SourceScope::isActive() {
+    return FilterFile.size() != 0 || FilterFunc.size() != 0 || !FilterDiff.empty()
+        || Reachable || SkipSingleThreaded || SkipUnshared;
+}
+
+bool SourceScope::filtersInstructions() {
+    return SkipSingleThreaded || SkipUnshared;
+}
+
+bool SourceScope::contains(Function *F) {
+    if (!isActive()) {
+        return true;
+    }
+    DenseMap<const Function *, bool>::iterator i = cache.find(F);
+    if (i != cache.end()) {
+        return i->second;
+    }
+    bool ret = true;
+    if (Reachable) {
+        if (reachableModule != F->getParent()) {
+            findReachable(*F->getParent());
+        }
+        ret = reachable.count(F);
+    }
+    if (SkipSingleThreaded && ret) {
+        ret = !getThreadContext(*F->getParent()).isSingleThreaded(F);
+    }
+    ret = ret && compute(F);
+    cache[F] = ret;
+    return ret;
+}
+
+bool SourceScope::contains(Instruction *I) {
+    if (!contains(I->getParent()->getParent())) {
+        return false;
+    }
+    if (SkipUnshared && !escape.mayAccessShared(I)) {
+        return false;
+    }
+    if (SkipSingleThreaded) {
+        Module &M = *I->getParent()->getParent()->getParent();
+        return getThreadContext(M).getContext(I) != TC_Single;
+    }
+    return true;
+}
+
+ThreadContext &SourceScope::getThreadContext(Module &M) {
+    if (threads == NULL || threadsModule != &M) {
+        delete threads;
+        threads = new ThreadContext(M);
+        threadsModule = &M;
+    }
+    return *threads;
+}
+
+void SourceScope::findReachable(Module &M) {
+    SmallVector<Function *, 64> worklist;
+    reachable.clear();
+    reachableModule = &M;
+
+    // Roots: main and every function whose address is taken. That covers the
+    // entry points passed to pthread_create or std::thread, global
+    // constructors and anything called through a pointer. Every externally
+    // visible function is a root too, since another file of the program may
+    // call it, unless -whole-program says the module defining main is all
+    // there is.
+    Function *main = M.getFunction("main");
+    bool closed = WholeProgram && main != NULL && !main->isDeclaration();
+    for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+        if (F->isDeclaration()) {
+            continue;
+        }
+        if (&*F == main || F->hasAddressTaken()
+                || (!closed && !F->hasLocalLinkage())) {
+            if (reachable.insert(&*F)) {
+                worklist.push_back(&*F);
+            }
+        }
+    }
+
+    while (!worklist.empty()) {
+        Function *F = worklist.pop_back_val();
+        for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+            Function *callee = getCallee(&*I);
+            if (callee != NULL && !callee->isDeclaration() && reachable.insert(callee)) {
+                worklist.push_back(callee);
+            }
+        }
+    }
+#ifdef MUT_DEBUG
+    errs() << "DEBUG: " << reachable.size() << " reachable functions\n";
+#endif
+}
+
+bool SourceScope::compute(Function *F) {
+    parseFilters();
+
+    if (filters.funcs.size() != 0) {
+        bool found = matchesAny(filters.funcs, F->getName());
+        if (!found) {
+            char *demangled = demangleCpp(F->getName());
+            if (demangled != NULL) {
+                found = matchesAny(filters.funcs, demangled);
+                free(demangled);
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    if (filters.files.size() == 0 && FilterDiff.empty()) {
+        return true;
+    }
+
+    // The file of a function is the file of its first instruction with debug
+    // information; later ones may have been inlined from other files
+    bool fileOk = filters.files.size() == 0;
+    bool seenFile = false;
+    bool diffOk = FilterDiff.empty();
+    for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+        StringRef fileName = getDebugFilename(&*I);
+        if (fileName == "") {
+            continue;
+        }
+        if (!seenFile) {
+            seenFile = true;
+            fileOk = fileOk || matchesAny(filters.files, fileName);
+            if (!fileOk) {
+                return false;
+            }
+        }
+        if (diffOk) {
+            break;
+        }
+        unsigned line = getDebugLineNum(&*I);
+        for (unsigned d = 0; d < filters.diff.size() && !diffOk; d++) {
+            const DiffFile &file = filters.diff[d];
+            if (!samePathSuffix(fileName, file.path)) {
+                continue;
+            }
+            for (unsigned h = 0; h < file.lines.size(); h++) {
+                if (line >= file.lines[h].first && line <= file.lines[h].second) {
+                    diffOk = true;
+                    break;
+                }
+            }
+        }
+    }
+#ifdef MUT_DEBUG
+    if (!(fileOk && diffOk)) {
+        errs() << "DEBUG: " << F->getName() << " is out of scope\n";
+    }
+#endif
+    return fileOk && diffOk;
+}
@@ -0,0 +1,107 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file SourceScope.h
+ * \author Markus Kusano
+ *
+ * Restrict the operators to part of the source code.
+ *
+ *  -filter-file=<glob>   the function is defined in a file matching the glob
+ *  -filter-func=<regex>  the (mangled or demangled) function name matches
+ *  -filter-diff=<file>   the function has a line changed by a unified diff
+ *  -reachable            the function can be called from main, a thread entry
+ *                        point, through a function pointer or, unless
+ *                        -whole-program is given, from another file
+ *  -skip-single-threaded the site can run while other threads exist (see
+ *                        ThreadContext.h)
+ *  -skip-unshared        the site accesses memory another thread can reach
+ *                        (see ThreadEscape.h)
+ *
+ * A function is in scope if it passes every kind of filter that is given, and
+ * any one of the values given for a kind. The file and line of a function
+ * come from the debug information of its instructions (see FileInfo.h), so
+ * without debug information no function passes -filter-file or -filter-diff.
+ *
+ * Out of scope functions are skipped while enumerating: their sites are never
+ * found and take no index, so the same filters have to be passed when
+ * analyzing and when mutating.
+ */
+#pragma once
+#include "llvm/Function.h"
+#include "ThreadContext.h"
+#include "ThreadEscape.h"
+#include "llvm/Module.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <vector>
+
+using namespace llvm;
+
+class SourceScope {
+    public:
+        SourceScope();
+        ~SourceScope();
+
+        /// Returns true if any filter was given on the command line. When
+        /// false every function is in scope.
+        static bool isActive();
+
+        /// Returns true if a filter looks at single instructions rather than
+        /// whole functions (see contains(Instruction *))
+        static bool filtersInstructions();
+
+        /// Returns true if F is in scope. The result is cached per function,
+        /// so a SourceScope should not outlive the module of F. Create one
+        /// SourceScope per module and share it, -reachable looks at the
+        /// whole module the first time it is queried.
+        bool contains(Function *F);
+
+        /// Returns true if the function of I is in scope and, with
+        /// -skip-single-threaded, I can run while other threads exist and,
+        /// with -skip-unshared, I may access memory of another thread.
+        /// Whole functions that only run single threaded fail contains(F).
+        bool contains(Instruction *I);
+
+    private:
+        DenseMap<const Function *, bool> cache;
+
+        /// Functions reachable from the roots of reachableModule. Computed
+        /// on the first query with -reachable.
+        SmallPtrSet<const Function *, 32> reachable;
+        const Module *reachableModule;
+
+        /// Fill reachable with the functions reachable in M
+        void findReachable(Module &M);
+
+        /// Classification of the module of threadsModule, created on the
+        /// first query with -skip-single-threaded
+        ThreadContext *threads;
+        const Module *threadsModule;
+
+        ThreadContext &getThreadContext(Module &M);
+
+        /// Used with -skip-unshared
+        ThreadEscape escape;
+
+        // Not copyable, threads is owned
+        SourceScope(const SourceScope &);
+        void operator=(const SourceScope &);
+
+        /// The filters other than -reachable
+        static bool compute(Function *F);
+};
+
+/// Removes the instructions outside of scope from insts, keeping the order of
+/// the rest
+template <typename InstTy>
+void removeOutOfScope(std::vector<InstTy *> &insts, SourceScope &scope) {
+    unsigned kept = 0;
+    for (unsigned i = 0; i < insts.size(); i++) {
+        if (scope.contains(insts[i])) {
+            insts[kept++] = insts[i];
+        }
+    }
+    insts.resize(kept);
+}
@@ -0,0 +1,205 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file StructuralHash.cpp
+ * \author Markus Kusano
+ *
+ * See StructuralHash.h for more information
+ */
+#include "StructuralHash.h"
+#include "llvm/Constants.h"
+#include "llvm/InlineAsm.h"
+#include "llvm/Instructions.h"
+#include "llvm/IntrinsicInst.h"
+#include "llvm/Metadata.h"
+#include "llvm/Operator.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+
+namespace {
+class FunctionHasher {
+    public:
+        FunctionHasher(const Function &F) : func(F) { }
+
+        uint64_t run() {
+            number();
+            hash.add(func.getName());
+            addType(func.getFunctionType());
+            hash.add(func.getCallingConv());
+            for (Function::const_iterator BB = func.begin(), BE = func.end(); BB != BE; ++BB) {
+                hash.add('B');
+                for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+                    if (isa<DbgInfoIntrinsic>(I)) {
+                        continue;
+                    }
+                    addInstruction(*I);
+                }
+            }
+            return hash.get();
+        }
+
+    private:
+        const Function &func;
+        FnvHash hash;
+
+        // Position of every argument, basic block and instruction
+        DenseMap<const Value *, unsigned> numbers;
+
+        void number() {
+            unsigned n = 0;
+            for (Function::const_arg_iterator A = func.arg_begin(), AE = func.arg_end(); A != AE; ++A) {
+                numbers[&*A] = n++;
+            }
+            for (Function::const_iterator BB = func.begin(), BE = func.end(); BB != BE; ++BB) {
+                numbers[&*BB] = n++;
+                for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+                    if (!isa<DbgInfoIntrinsic>(I)) {
+                        numbers[&*I] = n++;
+                    }
+                }
+            }
+        }
+
+        void addType(Type *T) {
+            std::string str;
+            raw_string_ostream os(str);
+            T->print(os);
+            hash.add(os.str());
+        }
+
+        void addOperand(const Value *V) {
+            DenseMap<const Value *, unsigned>::const_iterator i = numbers.find(V);
+            if (i != numbers.end()) {
+                hash.add('L');
+                hash.add(i->second);
+            }
+            else if (const GlobalValue *GV = dyn_cast<GlobalValue>(V)) {
+                hash.add('G');
+                hash.add(GV->getName());
+            }
+            else if (const Constant *C = dyn_cast<Constant>(V)) {
+                std::string str;
+                raw_string_ostream os(str);
+                C->print(os);
+                hash.add('C');
+                hash.add(os.str());
+            }
+            else if (const InlineAsm *IA = dyn_cast<InlineAsm>(V)) {
+                hash.add('A');
+                hash.add(IA->getAsmString());
+                hash.add(IA->getConstraintString());
+                hash.add(IA->hasSideEffects());
+            }
+            else if (isa<MDNode>(V) || isa<MDString>(V)) {
+                hash.add('M');  // debug or other metadata
+            }
+            else {
+                hash.add('?');
+            }
+        }
+
+        // The parts of an instruction that are not operands
+        void addFlags(const Instruction &I) {
+            if (const LoadInst *LI = dyn_cast<LoadInst>(&I)) {
+                hash.add(LI->isVolatile());
+                hash.add(LI->getOrdering());
+                hash.add(LI->getSynchScope());
+                hash.add(LI->getAlignment());
+            }
+            else if (const StoreInst *SI = dyn_cast<StoreInst>(&I)) {
+                hash.add(SI->isVolatile());
+                hash.add(SI->getOrdering());
+                hash.add(SI->getSynchScope());
+                hash.add(SI->getAlignment());
+            }
+            else if (const AtomicRMWInst *RMW = dyn_cast<AtomicRMWInst>(&I)) {
+                hash.add(RMW->getOperation());
+                hash.add(RMW->isVolatile());
+                hash.add(RMW->getOrdering());
+                hash.add(RMW->getSynchScope());
+            }
+            else if (const AtomicCmpXchgInst *CX = dyn_cast<AtomicCmpXchgInst>(&I)) {
+                hash.add(CX->isVolatile());
+                hash.add(CX->getOrdering());
+                hash.add(CX->getSynchScope());
+            }
+            else if (const FenceInst *FI = dyn_cast<FenceInst>(&I)) {
+                hash.add(FI->getOrdering());
+                hash.add(FI->getSynchScope());
+            }
+            else if (const AllocaInst *AI = dyn_cast<AllocaInst>(&I)) {
+                hash.add(AI->getAlignment());
+            }
+            else if (const CmpInst *CI = dyn_cast<CmpInst>(&I)) {
+                hash.add(CI->getPredicate());
+            }
+            else if (const CallInst *Call = dyn_cast<CallInst>(&I)) {
+                hash.add(Call->isTailCall());
+                hash.add(Call->getCallingConv());
+            }
+            else if (const InvokeInst *Invoke = dyn_cast<InvokeInst>(&I)) {
+                hash.add(Invoke->getCallingConv());
+            }
+            else if (const GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(&I)) {
+                hash.add(GEP->isInBounds());
+            }
+            else if (const ExtractValueInst *EV = dyn_cast<ExtractValueInst>(&I)) {
+                for (unsigned i = 0; i < EV->getNumIndices(); i++) {
+                    hash.add(EV->getIndices()[i]);
+                }
+            }
+            else if (const InsertValueInst *IV = dyn_cast<InsertValueInst>(&I)) {
+                for (unsigned i = 0; i < IV->getNumIndices(); i++) {
+                    hash.add(IV->getIndices()[i]);
+                }
+            }
+            else if (const PHINode *PN = dyn_cast<PHINode>(&I)) {
+                // Incoming blocks are not operands
+                for (unsigned i = 0; i < PN->getNumIncomingValues(); i++) {
+                    addOperand(PN->getIncomingBlock(i));
+                }
+            }
+
+            if (const OverflowingBinaryOperator *OBO = dyn_cast<OverflowingBinaryOperator>(&I)) {
+                hash.add(OBO->hasNoUnsignedWrap());
+                hash.add(OBO->hasNoSignedWrap());
+            }
+            if (const PossiblyExactOperator *PEO = dyn_cast<PossiblyExactOperator>(&I)) {
+                hash.add(PEO->isExact());
+            }
+        }
+
+        void addInstruction(const Instruction &I) {
+            hash.add(I.getOpcode());
+            addType(I.getType());
+            hash.add(I.getNumOperands());
+            for (unsigned i = 0; i < I.getNumOperands(); i++) {
+                addOperand(I.getOperand(i));
+            }
+            addFlags(I);
+        }
+};
+}
+
+uint64_t hashFunction(const Function &F) {
+    if (F.isDeclaration()) {
+        FnvHash hash;
+        hash.add(F.getName());
+        return hash.get();
+    }
+    FunctionHasher hasher(F);
+    return hasher.run();
+}
+
+uint64_t hashModule(const Module &M) {
+    FnvHash hash;
+    for (Module::const_iterator F = M.begin(), E = M.end(); F != E; ++F) {
+        if (!F->isDeclaration()) {
+            hash.add(hashFunction(*F));
+        }
+    }
+    return hash.get();
+}
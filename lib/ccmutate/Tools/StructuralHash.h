@@ -0,0 +1,65 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file StructuralHash.h
+ * \author Markus Kusano
+ *
+ * Hash of the structure of a function, used to find equivalent mutants.
+ *
+ * Two functions get the same hash if they have the same instructions in the
+ * same order with the same operands. Local values are identified by their
+ * position (argument number, basic block number, instruction number) instead
+ * of their name, so renamed copies such as %mut_shift hash the same as the
+ * original. Globals are identified by name and constants by their printed
+ * form. Debug intrinsics and metadata are ignored.
+ *
+ * Everything a mutation operator can change is part of the hash: the called
+ * function, atomic ordering, synchronization scope, volatile and alignment of
+ * memory operations.
+ *
+ * The hash is computed on the IR as is; run the same optimization pipeline on
+ * the original and the mutants first so trivially equivalent mutants hash the
+ * same.
+ */
+#pragma once
+#include "llvm/Module.h"
+#include "llvm/Function.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+
+using namespace llvm;
+
+/// 64 bit FNV-1a, used to build the hashes
+class FnvHash {
+    public:
+        FnvHash() : h(14695981039346656037ULL) { }
+
+        void add(uint64_t v) {
+            for (unsigned i = 0; i < 8; i++) {
+                h ^= (v >> (i * 8)) & 0xff;
+                h *= 1099511628211ULL;
+            }
+        }
+
+        void add(StringRef s) {
+            add(s.size());
+            for (size_t i = 0; i < s.size(); i++) {
+                h ^= (unsigned char) s[i];
+                h *= 1099511628211ULL;
+            }
+        }
+
+        uint64_t get() const {
+            return h;
+        }
+
+    private:
+        uint64_t h;
+};
+
+/// Hash of the body of F. Declarations hash to the hash of their name.
+uint64_t hashFunction(const Function &F);
+
+/// Combined hash of every function defined in M, in module order
+uint64_t hashModule(const Module &M);
@@ -0,0 +1,115 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file SyncSymbols.cpp
+ * \author Markus Kusano
+ *
+ * See SyncSymbols.h for more information
+ */
+#include "SyncSymbols.h"
+#include "ItaniumDemangle.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdlib>
+#include <cstring>
+
+//#define MUT_DEBUG
+
+namespace {
+    struct SyncSymbolEntry {
+        const char *name;
+        unsigned len;
+        SyncKind kind;
+    };
+
+#include "SyncSymbols.inc"
+
+    const char *const syncKindNames[SK_NumKinds] = {
+        "",
+#define SYNC_KIND(Kind, Name) Name,
+#include "SyncSymbols.def"
+    };
+
+    // FNV-1a, must match fnv1a() in gen_sync_symbols.py
+    unsigned hashSyncSymbol(StringRef name) {
+        unsigned h = 2166136261U ^ SYNC_HASH_SEED;
+        for (size_t i = 0; i < name.size(); i++) {
+            h ^= (unsigned char) name[i];
+            h *= 16777619U;
+        }
+        return h;
+    }
+
+    // Returns the kind with the passed canonical name, SK_None if there is
+    // none. Names from libstdc++ (std::) are treated as their libc++
+    // (std::__1::) counterpart.
+    SyncKind lookupCanonicalName(const std::string &name) {
+        std::string libcxxName;
+        if (name.compare(0, 5, "std::") == 0
+                && name.compare(0, 10, "std::__1::") != 0) {
+            libcxxName = "std::__1::" + name.substr(5);
+        }
+        else {
+            libcxxName = name;
+        }
+        for (unsigned k = SK_None + 1; k < SK_NumKinds; k++) {
+            if (libcxxName == syncKindNames[k]) {
+                return (SyncKind) k;
+            }
+        }
+        return SK_None;
+    }
+} // namespace
+
+SyncKind classifySyncSymbol(StringRef name) {
+    const SyncSymbolEntry &entry =
+        syncSymbolTable[hashSyncSymbol(name) & ((1U << SYNC_HASH_BITS) - 1)];
+    if (entry.name == NULL || entry.len != name.size()) {
+        return SK_None;
+    }
+    if (memcmp(entry.name, name.data(), entry.len) != 0) {
+        return SK_None;
+    }
+    return entry.kind;
+}
+
+SyncKind classifyFunction(Function *func) {
+    if (func == NULL) {
+        return SK_None; // indirect function calls are not resolved
+    }
+
+    StringRef funcName = func->getName();
+    SyncKind kind = classifySyncSymbol(funcName);
+    if (kind != SK_None) {
+        return kind;
+    }
+
+    // Every C++ primitive in the table is a member of a class in namespace
+    // std, anything else can be rejected without demangling
+    if (!funcName.startswith("_ZNSt")) {
+        return SK_None;
+    }
+
+    char *demangled = demangleCpp(funcName); // malloc'd
+    if (demangled == NULL) {
+        return SK_None;
+    }
+    kind = lookupCanonicalName(removeParameters(demangled));
+    free(demangled);
+
+#ifdef MUT_DEBUG
+    if (kind != SK_None) {
+        errs() << "DEBUG: " << funcName << " not in table, demangled to "
+               << getSyncKindName(kind) << '\n';
+    }
+#endif
+    return kind;
+}
+
+const char *getSyncKindName(SyncKind kind) {
+    if (kind >= SK_NumKinds) {
+        return "";
+    }
+    return syncKindNames[kind];
+}
@@ -0,0 +1,40 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file SyncSymbols.h
+ * \author Markus Kusano
+ *
+ * Classifies called functions as one of the synchronization primitives the
+ * operators look for (see SyncSymbols.def).
+ *
+ * Known symbols are looked up in a perfect hash table generated by
+ * gen_sync_symbols.py: one hash of the name and at most one string compare,
+ * with no demangling and no allocation. Only C++ names in namespace std that
+ * miss the table (e.g. template instantiations) are demangled as a fallback.
+ */
+#pragma once
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Function.h"
+
+using namespace llvm;
+
+enum SyncKind {
+    SK_None = 0,
+#define SYNC_KIND(Kind, Name) SK_##Kind,
+#include "SyncSymbols.def"
+    SK_NumKinds
+};
+
+/// Returns the kind of the passed symbol name if it is in the table,
+/// otherwise SK_None. Never demangles.
+SyncKind classifySyncSymbol(StringRef name);
+
+/// Returns the kind of the passed function, SK_None if it is NULL (an
+/// indirect call) or not a synchronization primitive. Falls back on
+/// demangling for C++ names in namespace std that are not in the table.
+SyncKind classifyFunction(Function *func);
+
+/// Returns the canonical name of the kind, i.e. the libc++ name with no
+/// parameters for C++ functions. Returns "" for SK_None.
+const char *getSyncKindName(SyncKind kind);
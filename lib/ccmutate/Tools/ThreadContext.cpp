@@ -0,0 +1,473 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ThreadContext.cpp
+ * \author Markus Kusano
+ *
+ * See ThreadContext.h for more information
+ */
+#include "ThreadContext.h"
+#include "FileInfo.h"
+#include "SiteCatalog.h"
+#include "SyncSymbols.h"
+#include "llvm/InlineAsm.h"
+#include "llvm/Pass.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/raw_ostream.h"
+
+//#define MUT_DEBUG
+
+namespace {
+    typedef DenseMap<const Function *, SmallVector<const Function *, 4> > CallerMap;
+
+    enum BlockFlags {
+        BF_AfterCreate = 1, // entered after a thread may have been created
+        BF_NoJoinPath = 2,  // entered on a path from the entry with no join
+        BF_SyncLater = 4    // a creation or join can follow the block
+    };
+}
+
+// Returns true if I is a call or an invoke and sets callee to the called
+// function, NULL for an indirect call. Inline assembly is not a call.
+static bool getCallee(const Instruction *I, const Function *&callee) {
+    const Value *called;
+    if (const CallInst *call = dyn_cast<CallInst>(I)) {
+        called = call->getCalledValue();
+    }
+    else if (const InvokeInst *invoke = dyn_cast<InvokeInst>(I)) {
+        called = invoke->getCalledValue();
+    }
+    else {
+        return false;
+    }
+    if (isa<InlineAsm>(called)) {
+        return false;
+    }
+    callee = dyn_cast<Function>(called->stripPointerCasts());
+    return true;
+}
+
+static bool isCreateKind(SyncKind kind) {
+    return kind == SK_PthreadCreate || kind == SK_StdThreadCreate;
+}
+
+static bool isJoinKind(SyncKind kind) {
+    return kind == SK_PthreadJoin || kind == SK_StdThreadJoin;
+}
+
+static bool isDetachKind(SyncKind kind) {
+    return kind == SK_PthreadDetach || kind == SK_StdThreadDetach;
+}
+
+// Returns true if I calls pthread_create, pthread_join or their std::thread
+// counterparts directly
+static bool isThreadPrimitive(const Instruction *I) {
+    const Function *callee;
+    if (!getCallee(I, callee) || callee == NULL) {
+        return false;
+    }
+    SyncKind kind = classifyFunction(const_cast<Function *>(callee));
+    return isCreateKind(kind) || isJoinKind(kind);
+}
+
+// Adds every (transitive) caller of the functions in work to set
+static void addCallers(SmallVectorImpl<const Function *> &work,
+        const CallerMap &callers, SmallPtrSet<const Function *, 32> &set) {
+    while (!work.empty()) {
+        const Function *F = work.pop_back_val();
+        CallerMap::const_iterator i = callers.find(F);
+        if (i == callers.end()) {
+            continue;
+        }
+        for (unsigned j = 0; j < i->second.size(); j++) {
+            if (set.insert(i->second[j])) {
+                work.push_back(i->second[j]);
+            }
+        }
+    }
+}
+
+// Raises the context of F to at least ctx. Returns true if it changed
+static bool raiseContext(DenseMap<const Function *, ThreadContextKind> &entry,
+        const Function *F, ThreadContextKind ctx) {
+    DenseMap<const Function *, ThreadContextKind>::iterator i = entry.find(F);
+    if (i == entry.end()) {
+        entry[F] = ctx;
+        return true;
+    }
+    if (ctx > i->second) {
+        i->second = ctx;
+        return true;
+    }
+    return false;
+}
+
+ThreadContext::ThreadContext(Module &M) : mod(M) {
+    indirectCreates = false;
+    detaches = false;
+    findCreatesAndJoins();
+    findEntryContexts();
+}
+
+const char *ThreadContext::getContextName(ThreadContextKind kind) {
+    switch (kind) {
+        case TC_Single:
+            return "single";
+        case TC_Multi:
+            return "multi";
+        default:
+            return "unknown";
+    }
+}
+
+bool ThreadContext::isCreate(const Instruction *I) const {
+    const Function *callee;
+    if (!getCallee(I, callee)) {
+        return false;
+    }
+    if (callee == NULL) {
+        return indirectCreates;
+    }
+    return creates.count(callee);
+}
+
+bool ThreadContext::isJoin(const Instruction *I) const {
+    const Function *callee;
+    return getCallee(I, callee) && callee != NULL && joins.count(callee);
+}
+
+void ThreadContext::findCreatesAndJoins() {
+    CallerMap callers;
+    SmallVector<const Function *, 16> createWork;
+    SmallVector<const Function *, 16> joinWork;
+    SmallVector<const Function *, 16> indirectCallers;
+
+    for (Module::const_iterator F = mod.begin(), E = mod.end(); F != E; ++F) {
+        SyncKind kind = classifyFunction(const_cast<Function *>(&*F));
+        if (isCreateKind(kind)) {
+            creates.insert(&*F);
+            createWork.push_back(&*F);
+        }
+        else if (isJoinKind(kind)) {
+            joins.insert(&*F);
+            joinWork.push_back(&*F);
+        }
+        else if (isDetachKind(kind) && !F->use_empty()) {
+            detaches = true;
+        }
+        if (kind != SK_None) {
+            continue; // the body of a primitive is not looked at
+        }
+
+        bool indirect = false;
+        for (Function::const_iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB) {
+            for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+                const Function *callee;
+                if (!getCallee(&*I, callee)) {
+                    continue;
+                }
+                if (callee == NULL) {
+                    indirect = true;
+                }
+                else {
+                    callers[callee].push_back(&*F);
+                }
+            }
+        }
+        if (indirect) {
+            indirectCallers.push_back(&*F);
+        }
+    }
+
+    // Threads created detached never need a join
+    const Function *setDetach = mod.getFunction("pthread_attr_setdetachstate");
+    if (setDetach != NULL && !setDetach->use_empty()) {
+        detaches = true;
+    }
+
+    addCallers(createWork, callers, creates);
+    addCallers(joinWork, callers, joins);
+
+    // An indirect call can only reach a function whose address is taken
+    for (Module::const_iterator F = mod.begin(), E = mod.end(); F != E; ++F) {
+        if (F->hasAddressTaken() && creates.count(&*F)) {
+            indirectCreates = true;
+            break;
+        }
+    }
+    if (indirectCreates) {
+        for (unsigned i = 0; i < indirectCallers.size(); i++) {
+            if (creates.insert(indirectCallers[i])) {
+                createWork.push_back(indirectCallers[i]);
+            }
+        }
+        addCallers(createWork, callers, creates);
+    }
+#ifdef MUT_DEBUG
+    errs() << "DEBUG: " << creates.size() << " functions create threads, "
+           << joins.size() << " join threads\n";
+#endif
+}
+
+void ThreadContext::findBlockFlags(const Function &F) {
+    SmallVector<const BasicBlock *, 32> work;
+    SmallVector<const BasicBlock *, 8> syncBlocks;
+    SmallPtrSet<const BasicBlock *, 32> joinBlocks;
+
+    for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB) {
+        blockFlags[&*BB] = 0;
+        bool create = false;
+        bool join = false;
+        for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+            create = create || isCreate(&*I);
+            join = join || isJoin(&*I);
+        }
+        if (create) {
+            for (succ_const_iterator S = succ_begin(&*BB), SE = succ_end(&*BB); S != SE; ++S) {
+                work.push_back(*S);
+            }
+        }
+        if (join) {
+            joinBlocks.insert(&*BB);
+        }
+        if (create || join) {
+            syncBlocks.push_back(&*BB);
+        }
+    }
+
+    // Blocks reachable through at least one edge from a creation
+    while (!work.empty()) {
+        const BasicBlock *BB = work.pop_back_val();
+        unsigned &flags = blockFlags[BB];
+        if (flags & BF_AfterCreate) {
+            continue;
+        }
+        flags |= BF_AfterCreate;
+        for (succ_const_iterator S = succ_begin(BB), SE = succ_end(BB); S != SE; ++S) {
+            work.push_back(*S);
+        }
+    }
+
+    // Blocks reachable from the entry without passing a join
+    work.push_back(&F.getEntryBlock());
+    while (!work.empty()) {
+        const BasicBlock *BB = work.pop_back_val();
+        unsigned &flags = blockFlags[BB];
+        if (flags & BF_NoJoinPath) {
+            continue;
+        }
+        flags |= BF_NoJoinPath;
+        if (joinBlocks.count(BB)) {
+            continue;
+        }
+        for (succ_const_iterator S = succ_begin(BB), SE = succ_end(BB); S != SE; ++S) {
+            work.push_back(*S);
+        }
+    }
+
+    // Blocks that can reach a creation or join, then the blocks with a
+    // successor among them
+    SmallPtrSet<const BasicBlock *, 32> reachesSync;
+    work.append(syncBlocks.begin(), syncBlocks.end());
+    while (!work.empty()) {
+        const BasicBlock *BB = work.pop_back_val();
+        if (!reachesSync.insert(BB)) {
+            continue;
+        }
+        for (const_pred_iterator P = pred_begin(BB), PE = pred_end(BB); P != PE; ++P) {
+            work.push_back(*P);
+        }
+    }
+    for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB) {
+        for (succ_const_iterator S = succ_begin(&*BB), SE = succ_end(&*BB); S != SE; ++S) {
+            if (reachesSync.count(*S)) {
+                blockFlags[&*BB] |= BF_SyncLater;
+                break;
+            }
+        }
+    }
+}
+
+void ThreadContext::findEntryContexts() {
+    SmallVector<const Function *, 32> work;
+    SmallPtrSet<const Function *, 32> hasFlags;
+
+    const Function *main = mod.getFunction("main");
+    bool hasMain = main != NULL && !main->isDeclaration();
+    for (Module::const_iterator F = mod.begin(), E = mod.end(); F != E; ++F) {
+        if (F->isDeclaration()) {
+            continue;
+        }
+        ThreadContextKind ctx;
+        if (&*F == main) {
+            ctx = TC_Single;
+        }
+        else if (F->hasAddressTaken() || (!hasMain && !F->hasLocalLinkage())) {
+            ctx = TC_Unknown;
+        }
+        else {
+            continue;
+        }
+        if (raiseContext(entry, &*F, ctx)) {
+            work.push_back(&*F);
+        }
+    }
+
+    // The start routine passed to pthread_create runs in a new thread
+    for (Module::const_iterator F = mod.begin(), E = mod.end(); F != E; ++F) {
+        if (classifyFunction(const_cast<Function *>(&*F)) != SK_PthreadCreate) {
+            continue;
+        }
+        for (Value::const_use_iterator U = F->use_begin(), UE = F->use_end(); U != UE; ++U) {
+            const Function *callee;
+            if (!isa<Instruction>(*U) || !getCallee(cast<Instruction>(*U), callee)
+                    || callee != &*F) {
+                continue;
+            }
+            ImmutableCallSite CS(cast<Instruction>(*U));
+            if (CS.arg_size() < 3) {
+                continue;
+            }
+            const Function *start = dyn_cast<Function>(CS.getArgument(2)->stripPointerCasts());
+            if (start != NULL && !start->isDeclaration()
+                    && raiseContext(entry, start, TC_Multi)) {
+                work.push_back(start);
+            }
+        }
+    }
+
+    // Push the contexts of the call sites down the call graph. Contexts only
+    // go up (single, unknown, multi) so this stops.
+    while (!work.empty()) {
+        const Function *F = work.pop_back_val();
+        if (entry.lookup(F) == TC_Single && hasFlags.insert(F)) {
+            findBlockFlags(*F);
+        }
+        for (Function::const_iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB) {
+            for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+                const Function *callee;
+                if (!getCallee(&*I, callee) || callee == NULL || callee->isDeclaration()) {
+                    continue;
+                }
+                if (raiseContext(entry, callee, getContext(&*I))) {
+                    work.push_back(callee);
+                }
+            }
+        }
+    }
+#ifdef MUT_DEBUG
+    for (DenseMap<const Function *, ThreadContextKind>::iterator i = entry.begin(),
+            e = entry.end(); i != e; ++i) {
+        errs() << "DEBUG: " << i->first->getName() << " entered "
+               << getContextName(i->second) << '\n';
+    }
+#endif
+}
+
+ThreadContextKind ThreadContext::getEntryContext(const Function *F) const {
+    DenseMap<const Function *, ThreadContextKind>::const_iterator i = entry.find(F);
+    if (i == entry.end()) {
+        return TC_Unknown;
+    }
+    return i->second;
+}
+
+bool ThreadContext::isSingleThreaded(const Function *F) const {
+    return getEntryContext(F) == TC_Single && !creates.count(F);
+}
+
+ThreadContextKind ThreadContext::getContext(const Instruction *I) const {
+    const BasicBlock *BB = I->getParent();
+    ThreadContextKind ctx = getEntryContext(BB->getParent());
+    if (ctx != TC_Single) {
+        return ctx;
+    }
+    if (isThreadPrimitive(I)) {
+        // Other threads exist when a join runs, and the first creation is
+        // where a mutation changes whether they do
+        return TC_Multi;
+    }
+
+    bool createBefore = false;
+    bool joinBefore = false;
+    bool syncAfter = false;
+    bool after = false;
+    for (BasicBlock::const_iterator i = BB->begin(), e = BB->end(); i != e; ++i) {
+        if (&*i == I) {
+            after = true;
+            continue;
+        }
+        bool create = isCreate(&*i);
+        bool join = isJoin(&*i);
+        if (!after) {
+            createBefore = createBefore || create;
+            joinBefore = joinBefore || join;
+        }
+        else if (create || join) {
+            syncAfter = true;
+            break;
+        }
+    }
+
+    unsigned flags = blockFlags.lookup(BB);
+    if (!(flags & BF_AfterCreate) && !createBefore) {
+        return TC_Single; // no thread has been created yet
+    }
+    if (detaches) {
+        return TC_Multi;
+    }
+    bool joined = !(flags & BF_NoJoinPath) || joinBefore;
+    bool later = (flags & BF_SyncLater) || syncAfter;
+    return joined && !later ? TC_Single : TC_Multi;
+}
+
+namespace {
+/// Prints the context of every cataloged call site:
+///     <kind>\t<function>\t<file>:<line>\t<context>
+struct ThreadContextPrinter : public ModulePass {
+    static char ID;
+    ThreadContextPrinter() : ModulePass(ID) { threads = NULL; }
+    ~ThreadContextPrinter() { delete threads; }
+
+    ThreadContext *threads;
+    const SiteCatalog *catalog;
+
+    virtual bool runOnModule(Module &M) {
+        delete threads;
+        threads = new ThreadContext(M);
+        catalog = &getAnalysis<SiteCatalog>();
+        return false;
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+        AU.addRequired<SiteCatalog>();
+        AU.setPreservesAll();
+    }
+
+    void printSite(raw_ostream &O, SyncKind kind, Instruction *I) const {
+        O << getSyncKindName(kind) << '\t' << I->getParent()->getParent()->getName()
+          << '\t' << getDebugFilename(I) << ':' << getDebugLineNum(I) << '\t'
+          << ThreadContext::getContextName(threads->getContext(I)) << '\n';
+    }
+
+    virtual void print(raw_ostream &O, const Module *M) const {
+        for (unsigned k = SK_None + 1; k < SK_NumKinds; k++) {
+            const std::vector<CallInst *> &calls = catalog->getCalls((SyncKind) k);
+            const std::vector<InvokeInst *> &invokes = catalog->getInvokes((SyncKind) k);
+            for (unsigned i = 0; i < calls.size(); i++) {
+                printSite(O, (SyncKind) k, calls[i]);
+            }
+            for (unsigned i = 0; i < invokes.size(); i++) {
+                printSite(O, (SyncKind) k, invokes[i]);
+            }
+        }
+    }
+};
+}
+
+char ThreadContextPrinter::ID = 0;
+static RegisterPass<ThreadContextPrinter> X("thread-context",
+        "Print whether synchronization call sites run single threaded", false, true);
@@ -0,0 +1,96 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ThreadContext.h
+ * \author Markus Kusano
+ *
+ * Classifies instructions by whether other threads can be running when they
+ * execute.
+ *
+ *  single   only one thread exists: before the first thread is created or
+ *           after the final join
+ *  multi    other threads may be running
+ *  unknown  the function can be entered from somewhere the analysis cannot
+ *           see (e.g. through a function pointer)
+ *
+ * Mutating a lock, yield or memory ordering in single threaded code cannot
+ * change the behavior of the program, e.g. the setup in thread_init() of
+ * memcached or the teardown after joining the workers.
+ *
+ * The context of each function entry is found over the call graph starting
+ * from main (single) and the functions passed to pthread_create (multi).
+ * Other functions whose address is taken are unknown, and a function gets
+ * the worst context of the call sites calling it. Inside of a function
+ * entered single threaded, an instruction is single if no thread creation can
+ * have happened before it, or if every path to it passes a join and no
+ * creation or join can follow it. A call to a function that (transitively)
+ * creates or joins counts as a creation or join, and an indirect call counts
+ * as a creation when any address taken function creates threads. The calls
+ * to the create and join primitives themselves are never single: the final
+ * join still waits on a running thread.
+ *
+ * The post join rule assumes the final join is the last of the threads; it
+ * is not used when the module detaches threads. Calls to external functions
+ * other than the thread primitives are assumed to not create threads.
+ */
+#pragma once
+#include "llvm/Module.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+using namespace llvm;
+
+enum ThreadContextKind {
+    TC_Single,
+    TC_Unknown,
+    TC_Multi
+};
+
+class ThreadContext {
+    public:
+        /// Classifies M. M should not change while the ThreadContext is used
+        ThreadContext(Module &M);
+
+        /// Context I executes in
+        ThreadContextKind getContext(const Instruction *I) const;
+
+        /// Context F is entered in. Unknown for functions the analysis never
+        /// reached.
+        ThreadContextKind getEntryContext(const Function *F) const;
+
+        /// Returns true if every instruction of F is single threaded
+        bool isSingleThreaded(const Function *F) const;
+
+        /// "single", "multi" or "unknown"
+        static const char *getContextName(ThreadContextKind kind);
+
+    private:
+        const Module &mod;
+
+        /// Context of the entry of every function reached
+        DenseMap<const Function *, ThreadContextKind> entry;
+
+        /// Functions that create or join threads, directly or through a
+        /// function they call
+        SmallPtrSet<const Function *, 32> creates;
+        SmallPtrSet<const Function *, 32> joins;
+
+        /// True if an indirect call can reach a function creating threads
+        bool indirectCreates;
+
+        /// True if a thread can be detached, disabling the post join rule
+        bool detaches;
+
+        /// Flags of the basic blocks of functions entered single threaded
+        DenseMap<const BasicBlock *, unsigned> blockFlags;
+
+        bool isCreate(const Instruction *I) const;
+        bool isJoin(const Instruction *I) const;
+
+        void findCreatesAndJoins();
+        void findBlockFlags(const Function &F);
+        void findEntryContexts();
+};
@@ -0,0 +1,196 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ThreadEscape.cpp
+ * \author Markus Kusano
+ *
+ * See ThreadEscape.h for more information
+ */
+#include "ThreadEscape.h"
+#include "SyncSymbols.h"
+#include "llvm/GlobalVariable.h"
+#include "llvm/IntrinsicInst.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/raw_ostream.h"
+
+//#define MUT_DEBUG
+
+static bool isMutexKind(SyncKind kind) {
+    return kind == SK_PthreadMutexLock || kind == SK_PthreadMutexUnlock
+        || kind == SK_StdMutexLock || kind == SK_StdMutexUnlock;
+}
+
+// Returns true if passing a pointer to the call CS can publish it to another
+// thread. V is one of the arguments.
+static bool callEscapes(ImmutableCallSite CS, const Value *V,
+        SmallVectorImpl<const Value *> &work) {
+    if (isa<IntrinsicInst>(CS.getInstruction())) {
+        return false; // debug info, lifetime markers, memcpy of the contents
+    }
+    if (CS.getCalledValue() == V) {
+        return true;
+    }
+    const Function *callee = dyn_cast<Function>(CS.getCalledValue()->stripPointerCasts());
+    if (callee == NULL) {
+        return true;
+    }
+    SyncKind kind = classifyFunction(const_cast<Function *>(callee));
+    if (kind == SK_PthreadCreate || kind == SK_StdThreadCreate) {
+        return true;
+    }
+    if (kind != SK_None) {
+        return false;
+    }
+    if (callee->isDeclaration()) {
+        return true;
+    }
+
+    // Follow the object into the body of the callee
+    Function::const_arg_iterator arg = callee->arg_begin();
+    for (unsigned i = 0; i < CS.arg_size(); i++, ++arg) {
+        if (arg == callee->arg_end()) {
+            return true; // passed as a variadic argument
+        }
+        if (CS.getArgument(i) == V) {
+            work.push_back(&*arg);
+        }
+    }
+    return false;
+}
+
+bool ThreadEscape::escapes(const Value *obj) {
+    SmallVector<const Value *, 16> work;
+    SmallPtrSet<const Value *, 16> seen;
+    work.push_back(obj);
+
+    while (!work.empty()) {
+        const Value *V = work.pop_back_val();
+        if (!seen.insert(V)) {
+            continue;
+        }
+        for (Value::const_use_iterator UI = V->use_begin(), UE = V->use_end(); UI != UE; ++UI) {
+            const User *U = *UI;
+            if (isa<LoadInst>(U) || isa<ICmpInst>(U)) {
+                continue;
+            }
+            else if (const StoreInst *SI = dyn_cast<StoreInst>(U)) {
+                if (SI->getValueOperand() == V) {
+                    return true;
+                }
+            }
+            else if (const AtomicRMWInst *RMW = dyn_cast<AtomicRMWInst>(U)) {
+                if (RMW->getValOperand() == V) {
+                    return true;
+                }
+            }
+            else if (const AtomicCmpXchgInst *CX = dyn_cast<AtomicCmpXchgInst>(U)) {
+                if (CX->getCompareOperand() == V || CX->getNewValOperand() == V) {
+                    return true;
+                }
+            }
+            else if (isa<GetElementPtrInst>(U) || isa<BitCastInst>(U)
+                    || isa<PHINode>(U) || isa<SelectInst>(U)) {
+                work.push_back(U);
+            }
+            else if (isa<CallInst>(U) || isa<InvokeInst>(U)) {
+                if (callEscapes(ImmutableCallSite(cast<Instruction>(U)), V, work)) {
+                    return true;
+                }
+            }
+            else {
+                return true; // returned, converted to an integer, ...
+            }
+        }
+    }
+    return false;
+}
+
+bool ThreadEscape::mayBeShared(const Value *ptr) {
+    const Value *obj = GetUnderlyingObject(ptr);
+    DenseMap<const Value *, bool>::iterator i = objects.find(obj);
+    if (i != objects.end()) {
+        return i->second;
+    }
+
+    bool shared;
+    if (const GlobalVariable *GV = dyn_cast<GlobalVariable>(obj)) {
+        shared = !GV->isThreadLocal();
+    }
+    else if (isa<AllocaInst>(obj) || isNoAliasCall(obj)) {
+        shared = escapes(obj);
+    }
+    else {
+        shared = true;
+    }
+#ifdef MUT_DEBUG
+    errs() << "DEBUG: " << obj->getName() << (shared ? " may be shared\n" : " is thread local\n");
+#endif
+    objects[obj] = shared;
+    return shared;
+}
+
+bool ThreadEscape::fenceMayMatter(const Function *F) {
+    DenseMap<const Function *, bool>::iterator i = fenceFuncs.find(F);
+    if (i != fenceFuncs.end()) {
+        return i->second;
+    }
+
+    bool matters = false;
+    for (Function::const_iterator BB = F->begin(), BE = F->end(); BB != BE && !matters; ++BB) {
+        for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+            if (const MemIntrinsic *MI = dyn_cast<MemIntrinsic>(I)) {
+                const MemTransferInst *MT = dyn_cast<MemTransferInst>(MI);
+                matters = mayBeShared(MI->getRawDest())
+                    || (MT != NULL && mayBeShared(MT->getRawSource()));
+            }
+            else if (isa<IntrinsicInst>(I)) {
+                continue;
+            }
+            else if (isa<CallInst>(I) || isa<InvokeInst>(I)) {
+                matters = true;
+            }
+            else if (isa<LoadInst>(I) || isa<StoreInst>(I)
+                    || isa<AtomicRMWInst>(I) || isa<AtomicCmpXchgInst>(I)) {
+                matters = mayAccessShared(&*I);
+            }
+            if (matters) {
+                break;
+            }
+        }
+    }
+    fenceFuncs[F] = matters;
+    return matters;
+}
+
+bool ThreadEscape::mayAccessShared(const Instruction *I) {
+    if (const LoadInst *LI = dyn_cast<LoadInst>(I)) {
+        return mayBeShared(LI->getPointerOperand());
+    }
+    if (const StoreInst *SI = dyn_cast<StoreInst>(I)) {
+        return mayBeShared(SI->getPointerOperand());
+    }
+    if (const AtomicRMWInst *RMW = dyn_cast<AtomicRMWInst>(I)) {
+        return mayBeShared(RMW->getPointerOperand());
+    }
+    if (const AtomicCmpXchgInst *CX = dyn_cast<AtomicCmpXchgInst>(I)) {
+        return mayBeShared(CX->getPointerOperand());
+    }
+    if (isa<FenceInst>(I)) {
+        return fenceMayMatter(I->getParent()->getParent());
+    }
+    if (isa<CallInst>(I) || isa<InvokeInst>(I)) {
+        ImmutableCallSite CS(I);
+        const Function *callee = dyn_cast<Function>(CS.getCalledValue()->stripPointerCasts());
+        if (callee != NULL && CS.arg_size() != 0
+                && isMutexKind(classifyFunction(const_cast<Function *>(callee)))) {
+            // The mutex is the first argument, for std::mutex this is `this`
+            return mayBeShared(CS.getArgument(0));
+        }
+    }
+    return true;
+}
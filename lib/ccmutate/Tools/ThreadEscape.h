@@ -0,0 +1,57 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ThreadEscape.h
+ * \author Markus Kusano
+ *
+ * Escape analysis finding the memory a site accesses that no other thread
+ * can reach.
+ *
+ * Mutating a lock of a mutex, or an atomic access of an object, that only one
+ * thread can see gives an equivalent mutant. An object is thread local if it
+ * is a thread_local global, or a stack or heap (noalias call, e.g. malloc)
+ * allocation whose address never escapes:
+ *
+ *  - it is not stored to memory, returned or converted to an integer
+ *  - it is not passed to pthread_create, or to a function whose body is not
+ *    in the module (the other synchronization primitives do not escape it)
+ *  - it is not escaped by a function defined in the module it is passed to
+ *
+ * Anything else, including pointers loaded from memory and arguments of the
+ * functions being analyzed, may be shared.
+ *
+ * A fence has no operand, it may matter unless its function only accesses
+ * thread local memory and calls nothing.
+ */
+#pragma once
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/ADT/DenseMap.h"
+
+using namespace llvm;
+
+class ThreadEscape {
+    public:
+        /// Returns true if the object ptr points into may be reachable by
+        /// more than one thread
+        bool mayBeShared(const Value *ptr);
+
+        /// Returns true if the site I may synchronize memory of more than one
+        /// thread: the pointer of a load, store, atomicrmw or cmpxchg, the
+        /// mutex of a lock or unlock call, or the function of a fence.
+        /// Other instructions always may.
+        bool mayAccessShared(const Instruction *I);
+
+    private:
+        /// Result of mayBeShared() for every underlying object queried
+        DenseMap<const Value *, bool> objects;
+
+        /// Result for the fences of every function queried
+        DenseMap<const Function *, bool> fenceFuncs;
+
+        /// Returns true if the address of the allocation obj escapes
+        static bool escapes(const Value *obj);
+
+        bool fenceMayMatter(const Function *F);
+};
@@ -0,0 +1,141 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ThreadPool.cpp
+ * \author Markus Kusano
+ *
+ * See ThreadPool.h for more information
+ */
+#include "ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <unistd.h>
+#include <cstdlib>
+
+using namespace llvm;
+
+//#define MUT_DEBUG
+
+ThreadPool::ThreadPool(unsigned numThreads) {
+    if (numThreads == 0) {
+        numThreads = getNumCores();
+    }
+    this->numThreads = numThreads;
+    curFunc = NULL;
+    curArg = NULL;
+
+    for (unsigned i = 0; i < numThreads; i++) {
+        Worker *w = new Worker;
+        pthread_mutex_init(&w->lock, NULL);
+        workers.push_back(w);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    for (unsigned i = 0; i < workers.size(); i++) {
+        pthread_mutex_destroy(&workers[i]->lock);
+        delete workers[i];
+    }
+}
+
+unsigned ThreadPool::getNumThreads() const {
+    return numThreads;
+}
+
+unsigned ThreadPool::getNumCores() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) {
+        return 1;
+    }
+    return (unsigned) cores;
+}
+
+void ThreadPool::run(unsigned numTasks, TaskFunc func, void *arg) {
+    if (numTasks == 0) {
+        return;
+    }
+    curFunc = func;
+    curArg = arg;
+
+    // Give each worker a contiguous block of tasks. Neighbouring functions
+    // tend to be similar in size so this is usually close to balanced
+    // already, stealing handles the rest
+    unsigned used = numThreads < numTasks ? numThreads : numTasks;
+    unsigned perWorker = numTasks / used;
+    unsigned extra = numTasks % used;
+    unsigned next = 0;
+    for (unsigned i = 0; i < used; i++) {
+        unsigned size = perWorker + (i < extra ? 1 : 0);
+        for (unsigned j = 0; j < size; j++) {
+            workers[i]->tasks.push_back(next++);
+        }
+    }
+
+    if (used == 1) {
+        workerLoop(0);
+        return;
+    }
+
+    // Worker 0 is the calling thread
+    std::vector<pthread_t> threads(used - 1);
+    std::vector<WorkerArg> args(used - 1);
+    for (unsigned i = 1; i < used; i++) {
+        args[i - 1].pool = this;
+        args[i - 1].id = i;
+        if (pthread_create(&threads[i - 1], NULL, threadEntry, &args[i - 1])) {
+            errs() << "Error: unable to create worker thread\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    workerLoop(0);
+
+    for (unsigned i = 0; i < threads.size(); i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+void *ThreadPool::threadEntry(void *arg) {
+    WorkerArg *wa = (WorkerArg *) arg;
+    wa->pool->workerLoop(wa->id);
+    return NULL;
+}
+
+void ThreadPool::workerLoop(unsigned id) {
+    unsigned task;
+    while (getTask(id, task)) {
+        curFunc(task, curArg);
+    }
+}
+
+bool ThreadPool::getTask(unsigned id, unsigned &task) {
+    // Own work first, from the back
+    Worker *own = workers[id];
+    pthread_mutex_lock(&own->lock);
+    if (!own->tasks.empty()) {
+        task = own->tasks.back();
+        own->tasks.pop_back();
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    // Steal from the front of the other workers
+    for (unsigned i = 1; i < numThreads; i++) {
+        Worker *victim = workers[(id + i) % numThreads];
+        pthread_mutex_lock(&victim->lock);
+        if (!victim->tasks.empty()) {
+            task = victim->tasks.front();
+            victim->tasks.pop_front();
+            pthread_mutex_unlock(&victim->lock);
+#ifdef MUT_DEBUG
+            errs() << "DEBUG: worker " << id << " stole task " << task << '\n';
+#endif
+            return true;
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+
+    return false;
+}
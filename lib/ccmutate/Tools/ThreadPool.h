@@ -0,0 +1,72 @@
+/**
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE for details.
+ *
+ * \file ThreadPool.h
+ * \author Markus Kusano
+ *
+ * Small work-stealing thread pool used to run per-function analysis in
+ * parallel.
+ *
+ * A call to run() executes tasks 0 to numTasks - 1. The tasks are split into
+ * contiguous blocks, one per worker, and each worker takes tasks from the back
+ * of its own deque. A worker that runs out of work steals from the front of
+ * another worker's deque so a few very large functions do not leave the other
+ * threads idle. No tasks are added while running so a worker exits once every
+ * deque is empty.
+ *
+ * The calling thread is used as worker 0, the remaining workers are started
+ * with pthreads at the beginning of run() and joined before it returns.
+ */
+#pragma once
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+class ThreadPool {
+    public:
+        /// Function run for each task. index is the task number and arg is
+        /// the pointer passed to run().
+        typedef void (*TaskFunc)(unsigned index, void *arg);
+
+        /// Create a pool with the passed number of workers. If numThreads is
+        /// 0 then one worker per online core is used.
+        ThreadPool(unsigned numThreads);
+        ~ThreadPool();
+
+        /// Run func on every index in [0, numTasks). Returns once every task
+        /// has finished. The order tasks are executed in is unspecified.
+        void run(unsigned numTasks, TaskFunc func, void *arg);
+
+        unsigned getNumThreads() const;
+
+        /// Returns the number of online cores, or 1 if it cannot be found
+        static unsigned getNumCores();
+
+    private:
+        struct Worker {
+            pthread_mutex_t lock;
+            std::deque<unsigned> tasks;
+        };
+
+        /// Argument passed to each started thread
+        struct WorkerArg {
+            ThreadPool *pool;
+            unsigned id;
+        };
+
+        unsigned numThreads;
+        std::vector<Worker *> workers;
+
+        TaskFunc curFunc;
+        void *curArg;
+
+        /// Take a task from worker id, or steal one from another worker.
+        /// Returns false when there is no work left anywhere.
+        bool getTask(unsigned id, unsigned &task);
+
+        /// Loop executed by every worker until no tasks remain
+        void workerLoop(unsigned id);
+
+        static void *threadEntry(void *arg);
+};
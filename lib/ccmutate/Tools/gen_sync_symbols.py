@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+#
+# This file is distributed under the University of Illinois Open Source
+# License. See LICENSE for details.
+#
+# Generates SyncSymbols.inc from SyncSymbols.def.
+#
+# The output is a perfect hash table of every SYNC_SYMBOL: a seed is searched
+# for so that FNV-1a (see hashSyncSymbol() in SyncSymbols.cpp) puts every
+# symbol in its own slot of a power of two sized table. A lookup is then one
+# hash and one string compare.
+#
+# Usage: gen_sync_symbols.py [SyncSymbols.def] [SyncSymbols.inc]
+
+import os
+import re
+import sys
+
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+MAX_SEED = 1 << 20
+
+
+def fnv1a(s, seed):
+    h = (FNV_OFFSET ^ seed) & 0xffffffff
+    for c in s.encode('ascii'):
+        h ^= c if isinstance(c, int) else ord(c)
+        h = (h * FNV_PRIME) & 0xffffffff
+    return h
+
+
+def find_seed(symbols, bits):
+    mask = (1 << bits) - 1
+    for seed in range(MAX_SEED):
+        used = set()
+        for name, _ in symbols:
+            slot = fnv1a(name, seed) & mask
+            if slot in used:
+                break
+            used.add(slot)
+        else:
+            return seed
+    return None
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    def_file = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, 'SyncSymbols.def')
+    inc_file = sys.argv[2] if len(sys.argv) > 2 else os.path.join(here, 'SyncSymbols.inc')
+
+    text = open(def_file).read()
+    kinds = set(re.findall(r'^SYNC_KIND\((\w+),', text, re.M))
+    symbols = re.findall(r'^SYNC_SYMBOL\((\w+),\s*"([^"]+)"\)', text, re.M)
+    symbols = [(name, kind) for kind, name in symbols]
+
+    for name, kind in symbols:
+        if kind not in kinds:
+            sys.exit('Error: symbol %s has unknown kind %s' % (name, kind))
+    names = [name for name, _ in symbols]
+    if len(set(names)) != len(names):
+        sys.exit('Error: duplicate symbol in %s' % def_file)
+
+    # Start at a load factor of at most 1/2 and grow until a seed is found
+    bits = 1
+    while (1 << bits) < 2 * len(symbols):
+        bits += 1
+    seed = None
+    while seed is None:
+        seed = find_seed(symbols, bits)
+        if seed is None:
+            bits += 1
+
+    mask = (1 << bits) - 1
+    table = [None] * (1 << bits)
+    for name, kind in symbols:
+        table[fnv1a(name, seed) & mask] = (name, kind)
+
+    out = open(inc_file, 'w')
+    out.write('// Generated by gen_sync_symbols.py from SyncSymbols.def, do not edit.\n')
+    out.write('\n')
+    out.write('#define SYNC_HASH_SEED %uU\n' % seed)
+    out.write('#define SYNC_HASH_BITS %u\n' % bits)
+    out.write('\n')
+    out.write('static const SyncSymbolEntry syncSymbolTable[1 << SYNC_HASH_BITS] = {\n')
+    for entry in table:
+        if entry is None:
+            out.write('    { NULL, 0, SK_None },\n')
+        else:
+            out.write('    { "%s", %u, SK_%s },\n' % (entry[0], len(entry[0]), entry[1]))
+    out.write('};\n')
+    out.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,70 @@
+# Benchmark parallel enumeration of the atomic instruction operators.
+#
+# Runs each operator in analyze mode with -threads=1,2,4,... up to the number
+# of cores and prints the wall clock time and speedup over one thread. The
+# number of found instructions is checked to be the same for every run.
+#
+# Usage: bench_parallel_enum.sh <file.bc> [repetitions]
+#
+# A large module is needed to see a speedup, e.g. an llvm-link of a whole
+# program.
+#
+# CCMUTATE_LIB and OPT can be set in the environment to point at another
+# install.
+
+CCMUTATE_LIB=${CCMUTATE_LIB:-"/home/markus/src/CCMutator/install/lib"}
+
+OPT=${OPT:-"/home/markus/src/install-3.2/bin/opt"}
+
+OPERATORS=( "Load" "Store" "AtomicRMW" "CmpXchg" "Fence" )
+LIBS=( "mutate_Load.so" "mutate_Store.so" "mutate_AtomicRMW.so" "mutate_CmpXchg.so" "mutate_Fence.so" )
+
+if [ "$1" == "" ]; then
+    echo "Error: first command line option should be path to LLVM IR file"
+    exit 1
+fi
+input=$1
+reps=${2:-3}
+cores=`getconf _NPROCESSORS_ONLN`
+
+# Returns the best time out of $reps runs, in seconds
+time_run() {
+    local best=""
+    for (( r=0; r<$reps; r++ ))
+    do
+        local start=`date +%s.%N`
+        "$@" <$input >/dev/null 2>/dev/null || exit 1
+        local end=`date +%s.%N`
+        local t=`awk "BEGIN { printf \"%.3f\", $end - $start }"`
+        if [ "$best" == "" ] || awk "BEGIN { exit !($t < $best) }"; then
+            best=$t
+        fi
+    done
+    echo $best
+}
+
+for (( o=0; o<${#OPERATORS[@]}; o++ ))
+do
+    op=${OPERATORS[o]}
+    mut="$OPT -analyze -load $CCMUTATE_LIB/${LIBS[o]} -$op"
+    expected=`$mut -threads=1 <$input 2>&1 >/dev/null`
+    base=""
+    echo "--------- $op (found: $expected)"
+    echo -e "threads\tseconds\tspeedup"
+    threads=1
+    while [ $threads -le $cores ]
+    do
+        found=`$mut -threads=$threads <$input 2>&1 >/dev/null`
+        if [ "$found" != "$expected" ]; then
+            echo "Error: -threads=$threads found $found, expected $expected"
+            exit 1
+        fi
+        t=`time_run $mut -threads=$threads`
+        if [ "$base" == "" ]; then
+            base=$t
+        fi
+        speedup=`awk "BEGIN { printf \"%.2f\", $base / $t }"`
+        echo -e "$threads\t$t\t$speedup"
+        threads=$((threads * 2))
+    done
+done
@@ -0,0 +1,76 @@
+# Benchmark chaining operators in one opt run.
+#
+# Analyzes a module with each operator in its own opt run, loading the single
+# operator plugins, then with every operator in one opt run loading
+# mutate_all.so, and prints the best wall clock time of each. The number of
+# sites each operator reports is checked to be the same both ways.
+#
+# Usage: bench_pipeline.sh <file.bc> [repetitions]
+#
+# A large module is needed to see a difference, e.g. an llvm-link of a whole
+# program.
+#
+# CCMUTATE_LIB and OPT can be set in the environment to point at another
+# install.
+
+CCMUTATE_LIB=${CCMUTATE_LIB:-"/home/markus/src/CCMutator/install/lib"}
+
+OPT=${OPT:-"/home/markus/src/install-3.2/bin/opt"}
+
+OPERATORS=( "Mutex" "PosixLock" "PosixJoin" "PosixYield" "PosixSema" "Fence" "Store" "CmpXchg" )
+LIBS=( "mutate_Mutex.so" "mutate_PosixLock.so" "mutate_PosixJoin.so" "mutate_PosixYield.so" "mutate_PosixSemaphore.so" "mutate_Fence.so" "mutate_Store.so" "mutate_CmpXchg.so" )
+
+if [ "$1" == "" ]; then
+    echo "Error: first command line option should be path to LLVM IR file"
+    exit 1
+fi
+input=$1
+reps=${2:-3}
+
+# Runs every operator in its own opt
+separate() {
+    for (( o=0; o<${#OPERATORS[@]}; o++ ))
+    do
+        $OPT -basicaa -analyze -load $CCMUTATE_LIB/${LIBS[o]} -${OPERATORS[o]} <$input || return 1
+    done
+}
+
+# Runs every operator in one opt
+chained() {
+    local passes=""
+    for op in ${OPERATORS[@]}
+    do
+        passes="$passes -$op"
+    done
+    $OPT -basicaa -analyze -load $CCMUTATE_LIB/mutate_all.so $passes <$input
+}
+
+# Returns the best time out of $reps runs, in seconds
+time_run() {
+    local best=""
+    for (( r=0; r<$reps; r++ ))
+    do
+        local start=`date +%s.%N`
+        "$@" >/dev/null 2>/dev/null || exit 1
+        local end=`date +%s.%N`
+        local t=`awk "BEGIN { printf \"%.3f\", $end - $start }"`
+        if [ "$best" == "" ] || awk "BEGIN { exit !($t < $best) }"; then
+            best=$t
+        fi
+    done
+    echo $best
+}
+
+expected=`separate 2>&1 >/dev/null`
+found=`chained 2>&1 >/dev/null`
+if [ "$found" != "$expected" ]; then
+    echo "Error: mutate_all.so found different sites than the single plugins"
+    exit 1
+fi
+
+before=`time_run separate`
+after=`time_run chained`
+speedup=`awk "BEGIN { printf \"%.2f\", $before / $after }"`
+echo "operators: ${OPERATORS[@]}"
+echo -e "separate\tchained\tspeedup"
+echo -e "$before\t$after\t$speedup"
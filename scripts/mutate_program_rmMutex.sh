@@ -0,0 +1,47 @@
+# Author: Markus Kusano
+# Generates first order remove mutex pair mutants of a program made of several
+# bitcode files without linking them together.
+#
+# The pairs are numbered over the whole program (see -program in the Mutex
+# operator). Each mutant is written only for the file that owns the removed
+# pair; the other files are used unchanged when linking that mutant.
+#
+# Usage: mutate_program_rmMutex.sh <file1.bc> <file2.bc> ...
+#
+# The mutants are output to directory mutants/ in the current directory and are
+# named <file>_rmMutex_<kind>_<globalIndex>.bc
+
+CCMUTATE_LIB="/home/markus/src/CCMutator/install/lib"
+
+OPT="/home/markus/src/install-3.2/bin/opt"
+
+echo "--------- Generating Whole Program Remove Mutex Pair Mutants"
+if [ "$1" == "" ]; then
+    echo "Error: command line options should be the LLVM IR files of the program"
+    exit 1
+fi
+
+files=( "$@" )
+program=$(IFS=,; echo "${files[*]}")
+mut_mutex="$OPT -basicaa -load $CCMUTATE_LIB/mutate_Mutex.so -Mutex -program=$program"
+mkdir -p mutants
+
+# The verbose output is the program totals (<kind>\t<count>) followed by one
+# line per file and kind: <file>\t<kind>\t<offset>\t<count>
+$mut_mutex -analyze -verbose -program-self=${files[0]} <${files[0]} 1>/dev/null 2>out.txt || exit 1
+
+while read -r file kind offset count
+do
+    if [ "$count" == "" ]; then
+        continue # a total line
+    fi
+    for (( j=$offset; j<$offset+$count; j++ ))
+    do
+        # A rejected mutant only leaves its -reject-log entry, the campaign
+        # goes on with the next pair
+        out="mutants/`basename $file`_rmMutex_${kind}_${j}.bc"
+        $mut_mutex -rm -pos=$kind,$j -program-self=$file <$file >"$out" || rm -f "$out"
+    done
+    echo "$file: $count pairs of kind $kind"
+done <out.txt
+rm out.txt || exit 1
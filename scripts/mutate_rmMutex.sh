@@ -16,25 +16,32 @@ mut_mutex="$OPT -basicaa -load $CCMUTATE_LIB/mutate_Mutex.so -Mutex"
 mkdir mutants
 source=`basename $1` || exit 1
 $mut_mutex -analyze <$source 1>/dev/null 2>out.txt || exit 1
-analyzeOut=(`cat out.txt`)  # array with mutex pairs
+analyzeOut=(`cat out.txt`)  # <kind> <number of pairs> for each kind
 rm out.txt || exit 1
-analyzeOut[1]=$((analyzeOut[1] - 1))
-echo ${analyzeOut[0]}
-echo ${analyzeOut[1]}
 
-# For each of the types of mutex pairs (analyzeOut[0]) preform each combination
-# of first order mutex mutations
-for (( i=0; i<=${analyzeOut[0]}; i++ ))
+# The number of pairs of each of the 4 kinds, combinations picks across all
+# of them at once and writes each pair as <kind>,<pair>. -analyze leaves out
+# the kinds without pairs, they are 0 so the categories stay the kinds.
+kindSizes=(0 0 0 0)
+numPairs=0
+for (( i=1; i<${#analyzeOut[@]}; i+=2 ))
 do
-    # Pick groups of 1,2,...analyzeOut[1]
-    for (( j=1; j<=${analyzeOut[1]}; j++ ))
+    kindSizes[${analyzeOut[i-1]}]=${analyzeOut[i]}
+    numPairs=$((numPairs + analyzeOut[i]))
+done
+sizes="${kindSizes[*]}"
+echo $sizes
+
+# Pick groups of 1,2,...numPairs
+for (( j=1; j<=$numPairs; j++ ))
+do
+    comboOut=( $($COMBO -mixed -k "$j" "$sizes") )
+    arrSize=${#comboOut[@]}
+    for (( k=0; k<$arrSize; k++ ))
     do
-        comboOut=( $($COMBO -p $i -c 0 -k "$j" ${analyzeOut[1]}) )
-        arrSize=${#comboOut[@]}
-        for (( k=0; k<$arrSize; k++ ))
-        do
-            $mut_mutex -rm -pos=${comboOut[k]} <$source >"mutants/${source}_rmMutex_${i}_${comboOut[k]}.o"
-        done
-        echo "Iteration: $j out of ${analyzeOut[1]}"
+        # A rejected mutant only leaves its -reject-log entry
+        out="mutants/${source}_rmMutex_${comboOut[k]}.o"
+        $mut_mutex -rm -pos=${comboOut[k]} <$source >"$out" || rm -f "$out"
     done
+    echo "Iteration: $j out of $numPairs"
 done
@@ -86,7 +86,9 @@ do
     arrSize=${#comboOut[@]}
     for (( k=0; k<$arrSize; k++ ))
     do
-        $mutate -rmmode -pos=${comboOut[k]} <$source >mutants/${source}_rmCondSignal_${comboOut[k]}.o
+        # A rejected mutant only leaves its -reject-log entry
+        out="mutants/${source}_rmCondSignal_${comboOut[k]}.o"
+        $mutate -rmmode -pos=${comboOut[k]} <$source >"$out" || rm -f "$out"
     done
     echo "Iteration: $j out of $analyzeOut"
 done
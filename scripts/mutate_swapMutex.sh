@@ -70,6 +70,14 @@ sed -e '1d' out.txt >out_cut.txt # remove the line containing arguments
 analyzeOut=(`cat out_cut.txt`)  # array with mutex pairs
 rm out.txt || exit 1
 analyzeOut[1]=$((analyzeOut[1] - 1))
+
+# Pairs that cannot be swapped together, so such combinations are never
+# generated (see Mutex -conflicts). Only the pairs sharing a lock or unlock
+# call are kept: overlapping pairs include nested critical sections, whose
+# swaps are the lock order inversions this script is after
+$mut_mutex -analyze -conflicts <$source 1>/dev/null 2>conflicts_all.txt || exit 1
+awk -F'\t' '$4 == "shared"' conflicts_all.txt >conflicts.txt
+rm conflicts_all.txt || exit 1
 echo ${analyzeOut[0]}
 echo ${analyzeOut[1]}
 
@@ -80,15 +88,18 @@ do
     # Pick groups of 2,4,..analyzeOut[1]
     for (( j=2; j<=${analyzeOut[1]}; j=j+2 ))
     do
-        comboOut=( $($COMBO -p $i -c 0 -k "$j" ${analyzeOut[1]}) )
+        comboOut=( $($COMBO -g conflicts.txt -p $i -c 0 -k "$j" ${analyzeOut[1]}) )
         arrSize=${#comboOut[@]}
         for (( k=0; k<$arrSize; k++ ))
         do
-            $mut_mutex -swap -pos=${comboOut[k]} <$source >"mutants/${source}_swapMutex_${i}_${comboOut[k]}.o"
+            # A rejected mutant only leaves its -reject-log entry
+            out="mutants/${source}_swapMutex_${i}_${comboOut[k]}.o"
+            $mut_mutex -swap -pos=${comboOut[k]} <$source >"$out" || rm -f "$out"
         done
         echo "Iteration: $j out of ${analyzeOut[1]}"
     done
 done
+rm conflicts.txt || exit 1
 
 # Link the final executable using clang
 #echo "------ COMPILING INSTRUMENTED FILE WITH CLANG"
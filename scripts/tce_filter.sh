@@ -0,0 +1,85 @@
+# Author: Markus Kusano
+# Trivial compiler equivalence: drops the mutants that are equivalent to the
+# original program or duplicates of another mutant once optimized.
+#
+# The original and every mutant are run through the same fixed pipeline
+# ($PIPELINE) and their structural hashes compared (see lib/ccmutate/TCE).
+# The mutants that are kept are printed one per line. Equivalent mutants are
+# listed in tce_equivalent.txt and duplicates in tce_duplicate.txt as
+# <mutant>\t<kept mutant it duplicates>.
+#
+# Usage: tce_filter.sh [-d] [-m] <original.bc> <mutant.bc> ...
+#
+# -d deletes the dropped mutants.
+# -m compares the machine code generated for $TRIPLE instead of the IR, which
+#    also drops the memory ordering mutants the target does not distinguish
+#    (e.g. acquire and seq_cst loads on x86-64).
+
+CCMUTATE_LIB="/home/markus/src/CCMutator/install/lib"
+
+OPT="/home/markus/src/install-3.2/bin/opt"
+
+# Fixed optimization pipeline, changing it changes which mutants are dropped
+PIPELINE="-O2"
+
+# Target used with -m, empty uses the triple of each file
+TRIPLE="x86_64-unknown-linux-gnu"
+
+delete=0
+machine=""
+while [ "$1" == "-d" ] || [ "$1" == "-m" ]; do
+    if [ "$1" == "-d" ]; then
+        delete=1
+    else
+        machine="-machine -tce-triple=$TRIPLE"
+    fi
+    shift
+done
+if [ "$2" == "" ]; then
+    echo "Error: command line options should be the original LLVM IR file followed by the mutants"
+    exit 1
+fi
+
+tce="$OPT $PIPELINE -load $CCMUTATE_LIB/mutate_TCE.so -TCE -analyze $machine"
+
+# Prints the hash of the module $1, the first line of the -TCE output.
+# Exits if opt fails or does not print a hash, e.g. when the file does not
+# load.
+tceOut=`mktemp` || exit 1
+trap 'rm -f "$tceOut"' EXIT
+hashOf() {
+    if ! $tce <"$1" 2>"$tceOut" >/dev/null; then
+        echo "Error: -TCE failed on $1:" >&2
+        cat "$tceOut" >&2
+        exit 1
+    fi
+    local hash=`head -n 1 "$tceOut"`
+    if ! [[ "$hash" =~ ^[0-9a-f]{16}$ ]]; then
+        echo "Error: -TCE printed no hash for $1: $hash" >&2
+        exit 1
+    fi
+    echo "$hash"
+}
+
+original=`hashOf "$1"` || exit 1
+shift
+
+declare -A seen   # hash -> first mutant with that hash
+: >tce_equivalent.txt
+: >tce_duplicate.txt
+for mutant in "$@"
+do
+    hash=`hashOf "$mutant"` || exit 1
+    if [ "$hash" == "$original" ]; then
+        echo "$mutant" >>tce_equivalent.txt
+    elif [ "${seen[$hash]}" != "" ]; then
+        echo -e "$mutant\t${seen[$hash]}" >>tce_duplicate.txt
+    else
+        seen[$hash]="$mutant"
+        echo "$mutant"
+        continue
+    fi
+    if [ $delete == 1 ]; then
+        rm "$mutant" || exit 1
+    fi
+done